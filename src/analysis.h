@@ -11,6 +11,8 @@
 #include <lemon/core.h>
 #include <lemon/dijkstra.h>
 #include <lemon/suurballe.h>
+#include <algorithm>
+#include <functional>
 #include <limits>
 #include <set>
 #include <vector>
@@ -33,7 +35,8 @@ public:
 
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
 
-  typedef typename GR::template NodeMap<BoolNodeMap*> BoolNodeMatrix;
+  typedef std::vector<int> IntVector;
+  typedef std::vector<IntVector> IntMatrix;
 
   typedef typename std::vector<Node> NodeVector;
   typedef typename std::set<Node> NodeSet;
@@ -47,8 +50,6 @@ public:
 
   typedef typename lemon::Suurballe<GR, WeightArcMap> SuurballeType;
   typedef typename SuurballeType::Path PathType;
-  typedef typename GR::template NodeMap<PathType> PathMap;
-  typedef typename GR::template NodeMap<PathMap*> PathMatrix;
 
   typedef typename GR::template NodeMap<NodeSet> NodeSetMap;
 
@@ -60,13 +61,28 @@ public:
               const IntNodeMap& comp);
   ~MwcsAnalyze();
 
-  void analyze(bool eqClasses = false);
+  /// Identifies pairs (i, j) of positive nodes such that
+  /// x_i <= x_j holds in an optimal solution
+  void analyze();
   void analyzeS(int k);
   void analyzeNegHubs();
 
+  /// Equivalence classes of positive nodes, i.e. the strongly connected
+  /// components of the implications. Classes are in reverse topological
+  /// order: a class only implies classes with a smaller index.
   int getEqClassesCount() const { return static_cast<int>(_eqClasses.size()); }
   const NodeSetVector& getEqClasses() const { return _eqClasses; }
   int getEqClass(Node n) const { return _eqClassMap[n]; }
+
+  /// Classes implied by \c eqClassIdx in the transitive reduction
+  /// of the implications between equivalence classes
+  const IntVector& getCoverEdges(int eqClassIdx) const
+  {
+    return _coverEdges[eqClassIdx];
+  }
+
+  int getCoverEdgeCount() const { return _nCoverEdges; }
+
   void print(std::ostream& out) const
   {
     int eqClassIdx = 0;
@@ -121,20 +137,6 @@ public:
     out << " : " << cumWeight << "/" << maxCumWeight << std::endl;
   }
 
-  bool ok(Node i, Node j) const
-  {
-    if (_ok[i] != NULL)
-      return (*_ok[i])[j];
-    else
-      return false;
-  }
-
-  const PathType& path(Node i, Node j) const
-  {
-    assert(_path[i] != NULL);
-    return (*_path[i])[j];
-  }
-
   void printNegHubs(const MwcsGraphType& mwcsGraph, std::ostream& out) const
   {
     for (NodeIt v(_g); v != lemon::INVALID; ++v)
@@ -164,8 +166,18 @@ private:
   WeightArcMap _arcWeight;
   NodeSetVector _eqClasses;
   IntNodeMap _eqClassMap;
-  BoolNodeMatrix _ok;
-  PathMatrix _path;
+  /// Positive nodes and their indices (-1 for nonpositive nodes)
+  NodeVector _posNodes;
+  IntNodeMap _posIdx;
+  /// Implied positive nodes of every positive node, by index. An implication
+  /// is only recorded if it does not follow from those recorded before, so
+  /// the closure is never materialized; kept until the cover edges are known
+  IntMatrix _implications;
+  /// Source index of the last search that reached every positive node
+  IntVector _reached;
+  IntVector _dfsStack;
+  IntMatrix _coverEdges;
+  int _nCoverEdges;
 
   DoubleNodeMap _benefit;
   NodeSetMap _posNeighbors;
@@ -175,7 +187,11 @@ private:
   NodeVector _rouletteWheel;
 
   double initArcWeights();
+  void initPosNodes();
   bool isPathOK(const PathType& p) const;
+  bool addImplication(int idx_i, int idx_j);
+  void computeEqClasses();
+  void computeCoverEdges();
 
 public:
   const NodeSet& getBeneficialNegHubs() const
@@ -207,11 +223,6 @@ public:
 template<typename GR, typename WGHT>
 inline MwcsAnalyze<GR, WGHT>::~MwcsAnalyze()
 {
-  for (NodeIt n(_g); n != lemon::INVALID; ++n)
-  {
-    delete _ok[n];
-    delete _path[n];
-  }
 }
 
 template<typename GR, typename WGHT>
@@ -222,8 +233,13 @@ inline MwcsAnalyze<GR, WGHT>::MwcsAnalyze(const MwcsGraphType& mwcsGraph)
   , _arcWeight(_g)
   , _eqClasses()
   , _eqClassMap(_g, -1)
-  , _ok(_g, NULL)
-  , _path(_g, NULL)
+  , _posNodes()
+  , _posIdx(_g, -1)
+  , _implications()
+  , _reached()
+  , _dfsStack()
+  , _coverEdges()
+  , _nCoverEdges(0)
   , _benefit(_g)
   , _posNeighbors(_g)
   , _beneficial(_g, false)
@@ -243,8 +259,13 @@ inline MwcsAnalyze<GR, WGHT>::MwcsAnalyze(const Graph& g,
   , _arcWeight(_g)
   , _eqClasses()
   , _eqClassMap(_g, -1)
-  , _ok(_g, NULL)
-  , _path(_g, NULL)
+  , _posNodes()
+  , _posIdx(_g, -1)
+  , _implications()
+  , _reached()
+  , _dfsStack()
+  , _coverEdges()
+  , _nCoverEdges(0)
   , _benefit(_g)
   , _posNeighbors(_g)
   , _beneficial(_g, false)
@@ -299,30 +320,74 @@ inline bool MwcsAnalyze<GR, WGHT>::isPathOK(const PathType& p) const
   return cumWeight == maxCumWeight && cumWeight >= 0;
 }
 
+template<typename GR, typename WGHT>
+inline void MwcsAnalyze<GR, WGHT>::initPosNodes()
+{
+  _posNodes.clear();
+  lemon::mapFill(_g, _posIdx, -1);
+  for (NodeIt i(_g); i != lemon::INVALID; ++i)
+  {
+    if (_weight[i] > 0)
+    {
+      _posIdx[i] = static_cast<int>(_posNodes.size());
+      _posNodes.push_back(i);
+    }
+  }
+
+  _implications.assign(_posNodes.size(), IntVector());
+  _reached.assign(_posNodes.size(), -1);
+}
+
+template<typename GR, typename WGHT>
+inline bool MwcsAnalyze<GR, WGHT>::addImplication(int idx_i, int idx_j)
+{
+  // implied by the recorded implications of i
+  if (_reached[idx_j] == idx_i)
+    return false;
+
+  _implications[idx_i].push_back(idx_j);
+
+  // everything reachable from j is now reachable from i
+  _reached[idx_j] = idx_i;
+  _dfsStack.push_back(idx_j);
+  while (!_dfsStack.empty())
+  {
+    int u = _dfsStack.back();
+    _dfsStack.pop_back();
+    const IntVector& implications = _implications[u];
+    for (size_t k = 0; k < implications.size(); ++k)
+    {
+      if (_reached[implications[k]] != idx_i)
+      {
+        _reached[implications[k]] = idx_i;
+        _dfsStack.push_back(implications[k]);
+      }
+    }
+  }
+
+  return true;
+}
+
 template<typename GR, typename WGHT>
 inline void MwcsAnalyze<GR, WGHT>::analyzeS(int k)
 {
   initArcWeights();
+  initPosNodes();
   SuurballeType sb(_g, _arcWeight);
 
-  for (NodeIt i(_g); i != lemon::INVALID; ++i)
+  const int nPos = static_cast<int>(_posNodes.size());
+  for (int idx_i = 0; idx_i < nPos; ++idx_i)
   {
-    if (_weight[i] <= 0)
-      continue;
-
+    Node i = _posNodes[idx_i];
     int comp_i = _comp[i];
-    delete _ok[i];
-    _ok[i] = new BoolNodeMap(_g, false);
 
     // compute single source shortest path from i
     sb.init(i);
 
-    for (NodeIt j(_g); j != lemon::INVALID; ++j)
+    for (int idx_j = 0; idx_j < nPos; ++idx_j)
     {
-      if (i == j)
-        continue;
-
-      if (_weight[j] <= 0 || comp_i != _comp[j])
+      Node j = _posNodes[idx_j];
+      if (i == j || comp_i != _comp[j] || _reached[idx_j] == idx_i)
         continue;
 
       int n = sb.start(j, k);
@@ -331,141 +396,220 @@ inline void MwcsAnalyze<GR, WGHT>::analyzeS(int k)
         PathType path = sb.path(idx);
         if (isPathOK(path))
         {
-          (*_ok[i])[j] = true;
+          addImplication(idx_i, idx_j);
           break;
         }
       }
     }
   }
+
+  computeEqClasses();
+  computeCoverEdges();
 }
 
 template<typename GR, typename WGHT>
-inline void MwcsAnalyze<GR, WGHT>::analyze(bool eqClasses)
+inline void MwcsAnalyze<GR, WGHT>::analyze()
 {
   initArcWeights();
-  lemon::Dijkstra<GR, WeightArcMap> dijkstra(_g, _arcWeight);
+  initPosNodes();
+  DijkstraType dijkstra(_g, _arcWeight);
+
+  // cumulative weight along the shortest path from i to j
+  // and the maximum cumulative weight of its prefixes
+  DoubleNodeMap cumWeight(_g);
+  DoubleNodeMap maxCumWeight(_g);
 
   int count = 0;
-  for (NodeIt i(_g); i != lemon::INVALID; ++i)
+  const int nPos = static_cast<int>(_posNodes.size());
+  for (int idx_i = 0; idx_i < nPos; ++idx_i)
   {
-    if (_weight[i] <= 0)
-      continue;
-
+    Node i = _posNodes[idx_i];
     int comp_i = _comp[i];
-    _ok[i] = new BoolNodeMap(_g, false);
-    _path[i] = new PathMap(_g);
 
-    // compute single source shortest path from i
-    int localCount = 0;
-    do
+    // nodes are processed in order of their distance to i, so the
+    // predecessor of j has been processed before j, and far nodes are
+    // likely to be implied by the implications recorded for near ones
+    dijkstra.init();
+    dijkstra.addSource(i);
+    while (!dijkstra.emptyQueue())
     {
-      dijkstra.init();
-      dijkstra.run(i);
-
-      for (NodeIt j(_g); j != lemon::INVALID; ++j)
+      Node j = dijkstra.processNextNode();
+      if (j == i)
       {
-        if (i == j)
-          continue;
+        cumWeight[j] = maxCumWeight[j] = _weight[j];
+        continue;
+      }
 
-        if (_weight[j] <= 0 || comp_i != _comp[j])
-          continue;
+      Node pred_j = dijkstra.predNode(j);
+      cumWeight[j] = cumWeight[pred_j] + _weight[j];
+      maxCumWeight[j] = std::max(maxCumWeight[pred_j], cumWeight[j]);
 
-        if (dijkstra.reached(j))
-        {
-          PathType p = dijkstra.path(j);
-          if (isPathOK(p))
-          {
-            (*_ok[i])[j] = true;
-            (*_path[i])[j] = p;
-            count++;
-          }
-        }
+      // see isPathOK()
+      if (_weight[j] > 0 && comp_i == _comp[j]
+          && cumWeight[j] == maxCumWeight[j] && cumWeight[j] >= 0)
+      {
+        addImplication(idx_i, _posIdx[j]);
+        count++;
       }
-    } while (localCount != 0);
+    }
   }
 
   if (g_verbosity >= VERBOSE_ESSENTIAL)
-    std::cout << "// Identified " << count << " dependent node pairs" << std::endl;
+  {
+    int nRecorded = 0;
+    for (int idx_i = 0; idx_i < nPos; ++idx_i)
+    {
+      nRecorded += static_cast<int>(_implications[idx_i].size());
+    }
+    std::cout << "// Identified " << count << " dependent node pairs, "
+              << nRecorded << " of which do not follow from the others recorded" << std::endl;
+  }
+
+  computeEqClasses();
+  computeCoverEdges();
+
+  if (g_verbosity >= VERBOSE_ESSENTIAL)
+    std::cout << "// Reduced to " << _nCoverEdges << " implications between "
+              << _eqClasses.size() << " equivalence classes" << std::endl;
+}
 
-  // determine all equivalence classes
-  if (eqClasses)
+template<typename GR, typename WGHT>
+inline void MwcsAnalyze<GR, WGHT>::computeEqClasses()
+{
+  // Tarjan's algorithm, the stack of recursive calls is explicit
+  const int nPos = static_cast<int>(_posNodes.size());
+  IntVector index(nPos, -1);
+  IntVector lowLink(nPos, 0);
+  IntVector nextEdge(nPos, 0);
+  std::vector<bool> onStack(nPos, false);
+  IntVector stack;
+  IntVector callStack;
+
+  lemon::mapFill(_g, _eqClassMap, -1);
+  _eqClasses.clear();
+
+  int idx = 0;
+  for (int s = 0; s < nPos; ++s)
   {
-    lemon::mapFill(_g, _eqClassMap, -1);
-    int eqClassIdx = 0;
-    _eqClasses.clear();
+    if (index[s] != -1)
+      continue;
+
+    index[s] = lowLink[s] = idx++;
+    stack.push_back(s);
+    onStack[s] = true;
+    callStack.push_back(s);
 
-    for (NodeIt i(_g); i != lemon::INVALID; ++i)
+    while (!callStack.empty())
     {
-      if (_weight[i] <= 0)
+      int v = callStack.back();
+      const IntVector& implications = _implications[v];
+      if (nextEdge[v] < static_cast<int>(implications.size()))
+      {
+        int w = implications[nextEdge[v]++];
+        if (index[w] == -1)
+        {
+          index[w] = lowLink[w] = idx++;
+          stack.push_back(w);
+          onStack[w] = true;
+          callStack.push_back(w);
+        }
+        else if (onStack[w])
+        {
+          lowLink[v] = std::min(lowLink[v], index[w]);
+        }
         continue;
+      }
 
-      for (NodeIt j = i; j != lemon::INVALID; ++j)
+      callStack.pop_back();
+      if (!callStack.empty())
       {
-        if (_weight[j] <= 0)
-          continue;
+        int u = callStack.back();
+        lowLink[u] = std::min(lowLink[u], lowLink[v]);
+      }
 
-        if (i != j)
+      if (lowLink[v] == index[v])
+      {
+        // components are completed in reverse topological order
+        int eqClassIdx = static_cast<int>(_eqClasses.size());
+        _eqClasses.push_back(NodeSet());
+        int w;
+        do
         {
-          bool ok_i_j = (*_ok[i])[j];
-          bool ok_j_i = (*_ok[j])[i];
-          
-          if (_g.id(i) == 3522 && _g.id(j) == 3437)
-          {
-            print(path(i, j), std::cerr);
-            print(path(j, i), std::cerr);
-          }
+          w = stack.back();
+          stack.pop_back();
+          onStack[w] = false;
+          _eqClassMap[_posNodes[w]] = eqClassIdx;
+          _eqClasses.back().insert(_posNodes[w]);
+        } while (w != v);
+      }
+    }
+  }
+}
 
-          if (ok_i_j && ok_j_i)
+template<typename GR, typename WGHT>
+inline void MwcsAnalyze<GR, WGHT>::computeCoverEdges()
+{
+  const int nClasses = static_cast<int>(_eqClasses.size());
+  _coverEdges.assign(nClasses, IntVector());
+  _nCoverEdges = 0;
+
+  IntVector seen(nClasses, -1);
+  IntVector reached(nClasses, -1);
+  IntVector successors;
+  IntVector dfsStack;
+
+  // classes only imply classes with a smaller index, so the cover edges
+  // of all successors are known by the time a class is processed
+  for (int c = 0; c < nClasses; ++c)
+  {
+    successors.clear();
+    for (NodeSetIt nodeIt = _eqClasses[c].begin(); nodeIt != _eqClasses[c].end(); nodeIt++)
+    {
+      const IntVector& implications = _implications[_posIdx[*nodeIt]];
+      for (size_t k = 0; k < implications.size(); ++k)
+      {
+        int d = _eqClassMap[_posNodes[implications[k]]];
+        if (d != c && seen[d] != c)
+        {
+          seen[d] = c;
+          successors.push_back(d);
+        }
+      }
+    }
+
+    // a successor can only be implied by successors with a larger index,
+    // it is redundant if it is reachable from a cover edge added before
+    std::sort(successors.begin(), successors.end(), std::greater<int>());
+    for (size_t k = 0; k < successors.size(); ++k)
+    {
+      int d = successors[k];
+      if (reached[d] == c)
+        continue;
+
+      _coverEdges[c].push_back(d);
+      ++_nCoverEdges;
+
+      reached[d] = c;
+      dfsStack.push_back(d);
+      while (!dfsStack.empty())
+      {
+        int u = dfsStack.back();
+        dfsStack.pop_back();
+        const IntVector& coverEdges = _coverEdges[u];
+        for (size_t l = 0; l < coverEdges.size(); ++l)
+        {
+          if (reached[coverEdges[l]] != c)
           {
-            print(path(i, j), std::cerr);
-            print(path(j, i), std::cerr);
-            
-            if (_eqClassMap[i] == -1 && _eqClassMap[j] == -1)
-            {
-              // add to new eqClass
-              _eqClasses.push_back(NodeSet());
-              _eqClassMap[i] = _eqClassMap[j] = eqClassIdx;
-              _eqClasses[eqClassIdx].insert(i);
-              _eqClasses[eqClassIdx].insert(j);
-
-              eqClassIdx++;
-            }
-            else if (_eqClassMap[i] == -1)
-            {
-              _eqClassMap[i] = _eqClassMap[j];
-              _eqClasses[_eqClassMap[i]].insert(i);
-            }
-            else if (_eqClassMap[j] == -1)
-            {
-              _eqClassMap[j] = _eqClassMap[i];
-              _eqClasses[_eqClassMap[j]].insert(j);
-            }
-            else
-            {
-//              assert(_eqClassMap[i] == _eqClassMap[j]);
-              // merge j into i
-              for (NodeSetIt it = _eqClasses[_eqClassMap[j]].begin(), it_end = _eqClasses[_eqClassMap[j]].end();
-                   it != it_end; ++it)
-              {
-                _eqClassMap[*it] = _eqClassMap[i];
-              }
-              _eqClasses[_eqClassMap[i]].insert(_eqClasses[_eqClassMap[j]].begin(), _eqClasses[_eqClassMap[j]].end());
-            }
-            std::cerr << _eqClassMap[i] << std::endl << std::endl;
+            reached[coverEdges[l]] = c;
+            dfsStack.push_back(coverEdges[l]);
           }
         }
       }
-
-      // wtf is this?
-//      if (_eqClassMap[i] == -1)
-//      {
-//        _eqClassMap[i] = eqClassIdx;
-//        _eqClasses.push_back(NodeSet());
-//        _eqClasses[eqClassIdx].insert(i);
-//        eqClassIdx++;
-//      }
     }
   }
+
+  IntMatrix().swap(_implications);
+  IntVector().swap(_reached);
 }
 
 template<typename GR, typename WGHT>
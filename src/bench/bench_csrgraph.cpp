@@ -0,0 +1,142 @@
+/*
+ *  bench_csrgraph.cpp
+ *
+ *   Created on: 18-oct-2026
+ */
+
+#include <iostream>
+#include <lemon/time_measure.h>
+#include <lemon/bfs.h>
+
+#include "csrgraph.h"
+#include "mwcscsrgraph.h"
+
+#include "solver/solverunrooted.h"
+#include "solver/impl/treeheuristicsolverunrootedimpl.h"
+
+#include "benchinstance.h"
+
+using namespace nina;
+using namespace nina::mwcs;
+
+typedef BenchInstance::MwcsGraphType MwcsGraphType;
+typedef MwcsCsrGraph<MwcsGraphType> MwcsCsrGraphType;
+typedef BenchInstance::NodeSet NodeSet;
+
+// sums the scores of all neighbors of every node
+template<typename GR, typename WGHT>
+double neighborSweep(const GR& g, const WGHT& score)
+{
+  double sum = 0;
+  for (typename GR::NodeIt v(g); v != lemon::INVALID; ++v)
+  {
+    for (typename GR::IncEdgeIt e(g, v); e != lemon::INVALID; ++e)
+    {
+      sum += score[g.oppositeNode(v, e)];
+    }
+  }
+  return sum;
+}
+
+// BFS from every positive node
+template<typename GR, typename WGHT>
+int bfsSweep(const GR& g, const WGHT& score)
+{
+  int reached = 0;
+  lemon::Bfs<GR> bfs(g);
+  for (typename GR::NodeIt v(g); v != lemon::INVALID; ++v)
+  {
+    if (score[v] <= 0) continue;
+    bfs.run(v);
+    for (typename GR::NodeIt w(g); w != lemon::INVALID; ++w)
+    {
+      reached += bfs.reached(w);
+    }
+  }
+  return reached;
+}
+
+// The traversals and a fixed number of Monte Carlo iterations of the
+// heuristic solver (random edge costs), whose module is stored in solution
+template<typename GR>
+void run(const std::string& name,
+         const MwcsGraph<GR>& mwcsGraph,
+         int rounds,
+         int seed,
+         typename MwcsGraph<GR>::NodeSet& solution)
+{
+  typedef TreeHeuristicSolverImpl<GR> TreeHeuristicSolverImplType;
+  typedef TreeHeuristicSolverUnrootedImpl<GR> TreeHeuristicSolverUnrootedImplType;
+  typedef typename TreeHeuristicSolverImplType::Options Options;
+
+  const GR& g = mwcsGraph.getGraph();
+  const typename MwcsGraph<GR>::WeightNodeMap& score = mwcsGraph.getScores();
+
+  lemon::Timer t;
+  double sum = 0;
+  for (int r = 0; r < rounds; ++r)
+  {
+    sum += neighborSweep(g, score);
+  }
+  double sweepTime = t.realTime();
+
+  t.restart();
+  int reached = bfsSweep(g, score);
+  double bfsTime = t.realTime();
+
+  Options options(TreeHeuristicSolverImplType::EDGE_COST_RANDOM,
+                  false, rounds, -1, 1, seed);
+  SolverUnrooted<GR> solver(new TreeHeuristicSolverUnrootedImplType(options));
+  t.restart();
+  solver.solve(mwcsGraph);
+  double mcTime = t.realTime();
+
+  std::cout << name
+            << "\tsweep " << sweepTime << " s (" << rounds * lemon::countArcs(g) / sweepTime / 1e6 << " M arcs/s)"
+            << "\tbfs " << bfsTime << " s"
+            << "\tmonte carlo " << mcTime << " s (" << rounds / mcTime << " it/s, score "
+            << solver.getSolutionWeight() << " on " << solver.getSolutionModule().size() << " nodes)"
+            << "\t[checksum " << sum << " " << reached << "]"
+            << std::endl;
+
+  solution = solver.getSolutionModule();
+}
+
+int main(int argc, char** argv)
+{
+  BenchInstance instance;
+  if (!instance.init(argc, argv))
+  {
+    return 1;
+  }
+
+  const MwcsGraphType* pMwcs = &instance.getMwcsGraph();
+  const int rounds = instance.getRounds();
+  const int seed = instance.getSeed();
+
+  lemon::Timer t;
+  MwcsCsrGraphType csrMwcs;
+  csrMwcs.init(*pMwcs);
+  double buildTime = t.realTime();
+
+  std::cout << "// CSR build " << buildTime << " s" << std::endl;
+
+  NodeSet solution;
+  run("ListGraph", *pMwcs, rounds, seed, solution);
+
+  // the module found on the CSR snapshot must be one of the source graph
+  MwcsCsrGraphType::NodeSet csrSolution;
+  run("CsrGraph", csrMwcs, rounds, seed, csrSolution);
+
+  solution.clear();
+  csrMwcs.mapToSource(csrSolution, solution);
+  double csrScore = 0;
+  for (NodeSet::const_iterator nodeIt = solution.begin(); nodeIt != solution.end(); ++nodeIt)
+  {
+    csrScore += pMwcs->getScore(*nodeIt);
+  }
+  std::cout << "// CsrGraph module has score " << csrScore
+            << " on the source graph" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ *  bench_nodeset.cpp
+ *
+ *   Created on: 18-oct-2026
+ */
+
+#include <iostream>
+#include <limits>
+#include <lemon/time_measure.h>
+#include <lemon/random.h>
+#include <lemon/adaptors.h>
+#include <lemon/kruskal.h>
+
+#include "solver/impl/treesolverunrootedimpl.h"
+
+#include "benchinstance.h"
+
+using namespace nina;
+using namespace nina::mwcs;
+
+typedef BenchInstance::MwcsGraphType MwcsGraphType;
+typedef lemon::FilterEdges<const Graph, const BoolEdgeMap> SubGraphType;
+typedef MwcsGraph<const SubGraphType, const DoubleNodeMap, MwcsGraphType::LabelNodeMap, DoubleEdgeMap> MwcsSubGraphType;
+typedef TreeSolverUnrootedImpl<const SubGraphType, const DoubleNodeMap, MwcsGraphType::LabelNodeMap, DoubleEdgeMap> TreeSolverType;
+typedef TreeSolverType::BoolNodeMap SubBoolNodeMap;
+typedef TreeSolverType::NodeSet SubNodeSet;
+
+// Times TreeSolverUnrootedImpl on random spanning trees of the instance,
+// as solved in every iteration of the Monte Carlo heuristic. Preprocessing
+// is timed by BenchInstance. Both only use interfaces that predate the
+// dense node sets, so this file can be built on either side of that change.
+int main(int argc, char** argv)
+{
+  BenchInstance instance;
+  if (!instance.init(argc, argv))
+  {
+    return 1;
+  }
+
+  const MwcsGraphType& mwcsGraph = instance.getMwcsGraph();
+  const Graph& g = mwcsGraph.getGraph();
+  const int rounds = instance.getRounds();
+
+  BoolEdgeMap filter(g, false);
+  DoubleEdgeMap cost(g);
+  SubGraphType subG(g, filter);
+  MwcsSubGraphType mwcsSubGraph;
+  mwcsSubGraph.init(&subG, NULL, &mwcsGraph.getScores(), NULL);
+
+  TreeSolverType solver;
+  solver.init(mwcsSubGraph);
+  SubBoolNodeMap solutionMap(subG, false);
+  SubNodeSet solutionSet;
+
+  lemon::Random rnd(instance.getSeed());
+  lemon::Timer t;
+  double dpTime = 0;
+  double sum = 0;
+  for (int r = 0; r < rounds; ++r)
+  {
+    for (EdgeIt e(g); e != lemon::INVALID; ++e)
+    {
+      cost[e] = rnd();
+    }
+    lemon::kruskal(g, cost, filter);
+
+    double score = -std::numeric_limits<double>::max();
+    double scoreUB;
+    solutionSet.clear();
+
+    t.restart();
+    solver.solve(score, scoreUB, solutionMap, solutionSet);
+    dpTime += t.realTime();
+
+    sum += score;
+  }
+
+  std::cout << "tree dp\t" << dpTime << " s (" << rounds / dpTime << " trees/s)"
+            << "\t[checksum " << sum << "]" << std::endl;
+
+  return 0;
+}
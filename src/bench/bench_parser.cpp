@@ -0,0 +1,192 @@
+/*
+ *  bench_parser.cpp
+ *
+ *   Created on: 18-oct-2026
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <lemon/arg_parser.h>
+#include <lemon/time_measure.h>
+
+#include "parser/filetokenizer.h"
+#include "parser/mwcsparser.h"
+#include "parser/stpparser.h"
+#include "parser/stppcstparser.h"
+
+#include "utils.h"
+
+using namespace nina;
+using namespace nina::mwcs;
+
+typedef Parser<Graph> ParserType;
+typedef MwcsParser<Graph> MwcsParserType;
+typedef StpParser<Graph> StpParserType;
+typedef StpPcstParser<Graph> StpPcstParserType;
+typedef ParserType::InvIdNodeMap InvIdNodeMap;
+typedef std::vector<std::string> StringVector;
+
+// Tokenizes the files as the parsers did prior to FileTokenizer
+size_t tokenizeStream(const StringVector& files)
+{
+  size_t nTokens = 0;
+  for (StringVector::const_iterator it = files.begin(); it != files.end(); ++it)
+  {
+    std::ifstream in(it->c_str());
+    std::string line, token;
+    while (std::getline(in, line))
+    {
+      std::stringstream ss(line);
+      while (ss >> token)
+      {
+        ++nTokens;
+      }
+    }
+  }
+  return nTokens;
+}
+
+size_t tokenizeMapped(const StringVector& files)
+{
+  size_t nTokens = 0;
+  for (StringVector::const_iterator it = files.begin(); it != files.end(); ++it)
+  {
+    FileTokenizer in;
+    in.open(*it);
+    const char* begin;
+    const char* end;
+    while (in.nextLine())
+    {
+      while (in.nextToken(begin, end))
+      {
+        ++nTokens;
+      }
+    }
+  }
+  return nTokens;
+}
+
+size_t fileSize(const StringVector& files)
+{
+  size_t size = 0;
+  for (StringVector::const_iterator it = files.begin(); it != files.end(); ++it)
+  {
+    FileTokenizer in;
+    if (in.open(*it))
+    {
+      size += in.size();
+    }
+  }
+  return size;
+}
+
+bool run(const std::string& name,
+         ParserType& parser,
+         const StringVector& files,
+         int rounds)
+{
+  Graph g;
+  Graph::NodeMap<std::string> label(g);
+  DoubleNodeMap score(g);
+  InvIdNodeMap invLabel;
+
+  parser.setGraph(&g);
+  parser.setIdNodeMap(&label);
+  parser.setWeightNodeMap(&score);
+  parser.setInvIdNodeMap(&invLabel);
+
+  lemon::Timer t;
+  for (int r = 0; r < rounds; ++r)
+  {
+    invLabel.clear();
+    if (!parser.parse())
+    {
+      return false;
+    }
+  }
+  double parseTime = t.realTime();
+
+  t.restart();
+  size_t nTokensStream = 0;
+  for (int r = 0; r < rounds; ++r)
+  {
+    nTokensStream += tokenizeStream(files);
+  }
+  double streamTime = t.realTime();
+
+  t.restart();
+  size_t nTokensMapped = 0;
+  for (int r = 0; r < rounds; ++r)
+  {
+    nTokensMapped += tokenizeMapped(files);
+  }
+  double mappedTime = t.realTime();
+
+  const double mb = static_cast<double>(rounds) * fileSize(files) / 1e6;
+  std::cout << name
+            << "\tparse " << parseTime << " s (" << mb / parseTime << " MB/s)"
+            << "\ttokenize stream " << streamTime << " s (" << mb / streamTime << " MB/s)"
+            << "\tmapped " << mappedTime << " s (" << mb / mappedTime << " MB/s)"
+            << "\t[checksum " << lemon::countNodes(g) << " " << lemon::countEdges(g)
+            << " " << nTokensStream << " " << nTokensMapped << "]"
+            << std::endl;
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  bool pcst = false;
+  int rounds = 10;
+
+  lemon::ArgParser ap(argc, argv);
+  ap
+    .refOption("pcst", "Parse STP files as PCST instances", pcst, false)
+    .refOption("r", "Number of rounds (default: 10)", rounds, false)
+    .other("files", "STP files and pairs of node and edge files");
+  ap.parse();
+
+  g_verbosity = VERBOSE_NONE;
+
+  // STP files stand on their own, all other files are taken pairwise
+  StringVector pending;
+  bool ok = true;
+  for (StringVector::const_iterator it = ap.files().begin(); it != ap.files().end(); ++it)
+  {
+    const std::string& filename = *it;
+    if (filename.size() > 4 && filename.substr(filename.size() - 4) == ".stp")
+    {
+      StringVector files(1, filename);
+      if (pcst)
+      {
+        StpPcstParserType parser(filename);
+        ok &= run(filename, parser, files, rounds);
+      }
+      else
+      {
+        StpParserType parser(filename);
+        ok &= run(filename, parser, files, rounds);
+      }
+    }
+    else
+    {
+      pending.push_back(filename);
+      if (pending.size() == 2)
+      {
+        MwcsParserType parser(pending[0], pending[1]);
+        ok &= run(pending[0] + " " + pending[1], parser, pending, rounds);
+        pending.clear();
+      }
+    }
+  }
+
+  if (!pending.empty())
+  {
+    std::cerr << "Missing edge file for node file " << pending.front() << std::endl;
+    return 1;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/*
+ * benchinstance.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef BENCHINSTANCE_H
+#define BENCHINSTANCE_H
+
+#include <assert.h>
+#include <iostream>
+#include <set>
+#include <string>
+#include <lemon/arg_parser.h>
+#include <lemon/time_measure.h>
+
+#include "parser/mwcsparser.h"
+#include "parser/stpparser.h"
+
+#include "mwcsgraphparser.h"
+#include "mwcspreprocessedgraph.h"
+
+#include "utils.h"
+
+namespace nina {
+namespace mwcs {
+
+/// \brief Command line and input instance shared by the benchmarks
+///
+/// Reads an instance given by either '-stp' or '-n' and '-e', and
+/// preprocesses it unless '-p' is given. The number of rounds ('-r') and
+/// the seed ('-s') are up to the benchmark.
+class BenchInstance
+{
+public:
+  typedef Parser<Graph> ParserType;
+  typedef MwcsParser<Graph> MwcsParserType;
+  typedef StpParser<Graph> StpParserType;
+  typedef MwcsGraphParser<Graph> MwcsGraphType;
+  typedef MwcsPreprocessedGraph<Graph> MwcsPreprocessedGraphType;
+  typedef std::set<Node> NodeSet;
+
+  BenchInstance()
+    : _noPreprocess(false)
+    , _rounds(100)
+    , _seed(0)
+    , _preprocessTime(0)
+    , _pParser(NULL)
+    , _pMwcs(NULL)
+  {
+  }
+
+  ~BenchInstance()
+  {
+    delete _pMwcs;
+    delete _pParser;
+  }
+
+  /// Parses the command line and reads the instance, returns false on failure
+  bool init(int argc, char** argv);
+
+  const MwcsGraphType& getMwcsGraph() const
+  {
+    assert(_pMwcs);
+    return *_pMwcs;
+  }
+
+  int getRounds() const
+  {
+    return _rounds;
+  }
+
+  int getSeed() const
+  {
+    return _seed;
+  }
+
+  double getPreprocessTime() const
+  {
+    return _preprocessTime;
+  }
+
+private:
+  bool _noPreprocess;
+  int _rounds;
+  int _seed;
+  double _preprocessTime;
+  ParserType* _pParser;
+  MwcsGraphType* _pMwcs;
+
+  BenchInstance(const BenchInstance&);
+  void operator=(const BenchInstance&);
+};
+
+inline bool BenchInstance::init(int argc, char** argv)
+{
+  std::string stpFile;
+  std::string nodeFile;
+  std::string edgeFile;
+
+  lemon::ArgParser ap(argc, argv);
+  ap
+    .refOption("p", "Disable preprocessing", _noPreprocess, false)
+    .refOption("r", "Number of rounds (default: 100)", _rounds, false)
+    .refOption("s", "Random number generator seed (default: 0)", _seed, false)
+    .refOption("stp", "STP file", stpFile, false)
+    .refOption("e", "Edge list file", edgeFile, false)
+    .refOption("n", "Node file", nodeFile, false);
+  ap.parse();
+
+  if (!(ap.given("n") && ap.given("e")) && !ap.given("stp"))
+  {
+    std::cerr << "Please specify either '-n' and '-e', or '-stp'" << std::endl;
+    return false;
+  }
+
+  g_verbosity = VERBOSE_NONE;
+
+  if (!stpFile.empty())
+  {
+    _pParser = new StpParserType(stpFile);
+  }
+  else
+  {
+    _pParser = new MwcsParserType(nodeFile, edgeFile);
+  }
+
+  MwcsPreprocessedGraphType* pPreprocessedMwcs = NULL;
+  if (!_noPreprocess)
+  {
+    _pMwcs = pPreprocessedMwcs = new MwcsPreprocessedGraphType();
+  }
+  else
+  {
+    _pMwcs = new MwcsGraphType();
+  }
+
+  // node files carry scores, no p-values
+  if (!_pMwcs->init(_pParser, false))
+  {
+    return false;
+  }
+
+  lemon::Timer t;
+  if (pPreprocessedMwcs)
+  {
+    pPreprocessedMwcs->preprocess(NodeSet());
+  }
+  _preprocessTime = t.realTime();
+
+  std::cout << "// " << _pMwcs->getNodeCount() << " nodes, "
+            << _pMwcs->getEdgeCount() << " edges, preprocessing "
+            << _preprocessTime << " s" << std::endl;
+
+  return true;
+}
+
+} // namespace mwcs
+} // namespace nina
+
+#endif // BENCHINSTANCE_H
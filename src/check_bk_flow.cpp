@@ -0,0 +1,183 @@
+/*
+ *  check_bk_flow.cpp
+ *
+ *   Created on: 18-oct-2026
+ */
+
+#include <iostream>
+#include <vector>
+#include <lemon/arg_parser.h>
+#include <lemon/random.h>
+#include <lemon/smart_graph.h>
+#include <lemon/preflow.h>
+#include <lemon/tolerance.h>
+
+#include "solver/impl/cplex_cut/bk_alg.h"
+
+#include "utils.h"
+
+using namespace nina;
+using namespace nina::mwcs;
+
+typedef lemon::SmartDigraph Digraph;
+typedef BkFlowAlg<Digraph> BkAlg;
+typedef BkAlg::CapacityMap CapacityMap;
+typedef Digraph::Node DiNode;
+typedef Digraph::Arc DiArc;
+typedef Digraph::ArcIt DiArcIt;
+typedef std::vector<DiNode> DiNodeVector;
+typedef lemon::Preflow<Digraph, CapacityMap> PreflowType;
+
+// Random digraph on n nodes with at most one arc between every pair of
+// nodes (BkFlowAlg does not support reverse arcs), capacities are x-values
+// in [0,1] as in the node cut separation
+void generate(lemon::Random& rnd,
+              int n,
+              double density,
+              Digraph& h,
+              CapacityMap& cap,
+              DiNodeVector& nodes)
+{
+  for (int i = 0; i < n; ++i)
+  {
+    nodes.push_back(h.addNode());
+  }
+  for (int i = 0; i < n; ++i)
+  {
+    for (int j = i + 1; j < n; ++j)
+    {
+      if (rnd.boolean(density))
+      {
+        DiArc a = rnd.boolean() ? h.addArc(nodes[i], nodes[j]) : h.addArc(nodes[j], nodes[i]);
+        cap[a] = rnd.boolean(0.2) ? 1 : rnd();
+      }
+    }
+  }
+}
+
+// Returns whether the source side of bk separates source and target
+// by a cut whose capacity is the flow value
+bool isMinCut(const Digraph& h,
+              const BkAlg& bk,
+              DiNode source,
+              DiNode target,
+              double value)
+{
+  if (!bk.cut(source) || bk.cut(target))
+    return false;
+
+  double cutCap = 0;
+  for (DiArcIt a(h); a != lemon::INVALID; ++a)
+  {
+    if (bk.cut(a))
+      cutCap += bk.cap(a);
+  }
+
+  const lemon::Tolerance<double> tol(1e-6);
+  return !tol.different(cutCap, value);
+}
+
+int main(int argc, char** argv)
+{
+  int rounds = 200;
+  int maxNodes = 40;
+  int seed = 0;
+
+  lemon::ArgParser ap(argc, argv);
+  ap
+    .refOption("r", "Number of random networks (default: 200)", rounds, false)
+    .refOption("n", "Maximum number of nodes (default: 40)", maxNodes, false)
+    .refOption("s", "Random number generator seed (default: 0)", seed, false);
+  ap.parse();
+
+  g_verbosity = VERBOSE_NONE;
+
+  lemon::Random rnd(seed);
+  const lemon::Tolerance<double> tol(1e-6);
+  int nFlows = 0;
+  int nFailed = 0;
+  for (int r = 0; r < rounds; ++r)
+  {
+    const int n = 2 + rnd.integer(maxNodes - 1);
+
+    Digraph h;
+    CapacityMap cap(h);
+    DiNodeVector nodes;
+    generate(rnd, n, rnd(0.1, 0.6), h, cap, nodes);
+
+    // a sequence of targets for one source, as in separateMinCut(),
+    // targets may repeat so that a supply node becomes the target again
+    const DiNode source = nodes[rnd.integer(n)];
+    BkAlg bk(h, cap);
+    bk.setSource(source);
+
+    bool reuse = false;
+    for (int k = 0; k < n; ++k)
+    {
+      const DiNode target = nodes[rnd.integer(n)];
+      if (target == source)
+        continue;
+
+      bk.setTarget(target, reuse);
+      if (!reuse)
+      {
+        bk.setCap(cap);
+      }
+
+      // nested cuts raise the capacities of the cut arcs and the flow is
+      // reused for the same target, afterwards the capacities are reset
+      CapacityMap curCap(h);
+      lemon::mapCopy(h, cap, curCap);
+      const bool nestedCut = rnd.boolean(0.25);
+      for (int l = 0; l < (nestedCut ? 2 : 1); ++l)
+      {
+        if (l > 0)
+        {
+          for (DiArcIt a(h); a != lemon::INVALID; ++a)
+          {
+            if (bk.cut(a))
+            {
+              bk.incCap(a, 1);
+              curCap[a] += 1;
+            }
+          }
+        }
+
+        const double value = bk.run(reuse);
+        reuse = true;
+        ++nFlows;
+
+        BkAlg freshBk(h, curCap);
+        freshBk.setSource(source);
+        freshBk.setTarget(target);
+        const double freshValue = freshBk.run();
+
+        PreflowType preflow(h, curCap, source, target);
+        preflow.runMinCut();
+        const double refValue = preflow.flowValue();
+
+        if (tol.different(value, refValue)
+            || tol.different(freshValue, refValue)
+            || !isMinCut(h, bk, source, target, value))
+        {
+          std::cerr << "Network " << r << " (" << n << " nodes, "
+                    << lemon::countArcs(h) << " arcs), target " << k
+                    << (l > 0 ? " after nested cut" : "") << ": "
+                    << "reused flow " << value << ", "
+                    << "fresh flow " << freshValue << ", "
+                    << "preflow " << refValue << std::endl;
+          ++nFailed;
+        }
+      }
+
+      if (nestedCut)
+      {
+        reuse = false;
+      }
+    }
+  }
+
+  std::cout << nFlows - nFailed << " of " << nFlows << " reused flows agree" << std::endl;
+
+  return nFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/*
+ *  check_tree_solver.cpp
+ *
+ *   Created on: 18-oct-2026
+ */
+
+#include <iostream>
+#include <limits>
+#include <lemon/arg_parser.h>
+#include <lemon/random.h>
+#include <lemon/adaptors.h>
+#include <lemon/connectivity.h>
+#include <lemon/tolerance.h>
+
+#include "mwcsgraph.h"
+#include "solver/impl/treesolverunrootedimpl.h"
+
+#include "utils.h"
+
+using namespace nina;
+using namespace nina::mwcs;
+
+typedef MwcsGraph<Graph> MwcsGraphType;
+typedef TreeSolverUnrootedImpl<Graph> TreeSolverUnrootedImplType;
+typedef TreeSolverUnrootedImplType::NodeSet NodeSet;
+typedef NodeSet::const_iterator NodeSetIt;
+
+// Random forest on n nodes; every node but the first is attached to a
+// random earlier node, unless it starts a new tree
+void generate(lemon::Random& rnd,
+              int n,
+              bool allNegative,
+              Graph& g,
+              DoubleNodeMap& score)
+{
+  std::vector<Node> nodes;
+  for (int i = 0; i < n; ++i)
+  {
+    Node v = g.addNode();
+    score[v] = allNegative ? -rnd(1.0) - 1e-3 : rnd(-1.0, 1.0);
+    if (i > 0 && rnd.boolean(0.95))
+    {
+      g.addEdge(nodes[rnd.integer(i)], v);
+    }
+    nodes.push_back(v);
+  }
+}
+
+// Returns whether solutionSet is a non-empty connected module of weight score
+bool isValid(const Graph& g,
+             const DoubleNodeMap& weight,
+             const NodeSet& solutionSet,
+             double score)
+{
+  if (solutionSet.empty())
+    return false;
+
+  BoolNodeMap filter(g, false);
+  double sum = 0;
+  for (NodeSetIt nodeIt = solutionSet.begin(); nodeIt != solutionSet.end(); ++nodeIt)
+  {
+    filter[*nodeIt] = true;
+    sum += weight[*nodeIt];
+  }
+
+  const lemon::Tolerance<double> tol(1e-6);
+  return !tol.different(sum, score)
+      && lemon::connected(lemon::filterNodes(g, filter));
+}
+
+int main(int argc, char** argv)
+{
+  int rounds = 1000;
+  int maxNodes = 50;
+  int seed = 0;
+
+  lemon::ArgParser ap(argc, argv);
+  ap
+    .refOption("r", "Number of random forests (default: 1000)", rounds, false)
+    .refOption("n", "Maximum number of nodes (default: 50)", maxNodes, false)
+    .refOption("s", "Random number generator seed (default: 0)", seed, false);
+  ap.parse();
+
+  g_verbosity = VERBOSE_NONE;
+
+  lemon::Random rnd(seed);
+  const lemon::Tolerance<double> tol(1e-6);
+  int nFailed = 0;
+  for (int r = 0; r < rounds; ++r)
+  {
+    // every fourth forest has negative nodes only
+    const bool allNegative = r % 4 == 3;
+    const int n = 1 + rnd.integer(maxNodes);
+
+    Graph g;
+    DoubleNodeMap weight(g);
+    generate(rnd, n, allNegative, g, weight);
+
+    MwcsGraphType::LabelNodeMap label(g);
+    MwcsGraphType mwcsGraph;
+    mwcsGraph.init(&g, &label, &weight, NULL);
+
+    TreeSolverUnrootedImplType solver;
+    solver.init(mwcsGraph);
+
+    double score, scoreUB;
+    BoolNodeMap solutionMap(g, false);
+    NodeSet solutionSet;
+    solver.solve(score, scoreUB, solutionMap, solutionSet);
+
+    double refScore = -std::numeric_limits<double>::max();
+    double refScoreUB;
+    BoolNodeMap refSolutionMap(g, false);
+    NodeSet refSolutionSet;
+    solver.solveReference(refScore, refScoreUB, refSolutionMap, refSolutionSet);
+
+    if (tol.different(score, refScore)
+        || !isValid(g, weight, solutionSet, score)
+        || !isValid(g, weight, refSolutionSet, refScore))
+    {
+      std::cerr << "Forest " << r << " (" << n << " nodes"
+                << (allNegative ? ", all negative" : "") << "): "
+                << "solve() gives " << score << " on " << solutionSet.size() << " nodes, "
+                << "solveReference() gives " << refScore << " on " << refSolutionSet.size() << " nodes"
+                << std::endl;
+      ++nFailed;
+    }
+  }
+
+  std::cout << rounds - nFailed << " of " << rounds << " random forests agree" << std::endl;
+
+  return nFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,369 @@
+/*
+ * csrgraph.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include <vector>
+#include <lemon/core.h>
+#include <lemon/maps.h>
+#include <lemon/bits/graph_extender.h>
+
+namespace nina {
+
+/// Base of CsrGraph: undirected graph stored in compressed sparse row format
+///
+/// Arcs are identified by their position in the adjacency array, so the
+/// out-arcs of a node occupy a contiguous range. Every edge maps to two arcs:
+/// the arc with source u(e) and its twin with source v(e).
+class CsrGraphBase
+{
+public:
+  typedef CsrGraphBase Graph;
+
+  class Node;
+  class Arc;
+  class Edge;
+
+public:
+  class Node
+  {
+    friend class CsrGraphBase;
+
+  protected:
+    int _id;
+    explicit Node(int id) : _id(id) {}
+
+  public:
+    Node() {}
+    Node(lemon::Invalid) : _id(-1) {}
+    bool operator==(const Node& node) const { return _id == node._id; }
+    bool operator!=(const Node& node) const { return _id != node._id; }
+    bool operator<(const Node& node) const { return _id < node._id; }
+  };
+
+  class Edge
+  {
+    friend class CsrGraphBase;
+
+  protected:
+    int _id;
+    explicit Edge(int id) : _id(id) {}
+
+  public:
+    Edge() {}
+    Edge(lemon::Invalid) : _id(-1) {}
+    bool operator==(const Edge& edge) const { return _id == edge._id; }
+    bool operator!=(const Edge& edge) const { return _id != edge._id; }
+    bool operator<(const Edge& edge) const { return _id < edge._id; }
+  };
+
+  class Arc
+  {
+    friend class CsrGraphBase;
+
+  protected:
+    int _id;
+    int _edge;
+    Arc(int id, int edge) : _id(id), _edge(edge) {}
+
+  public:
+    Arc() {}
+    Arc(lemon::Invalid) : _id(-1), _edge(-1) {}
+    operator Edge() const { return Edge(_edge); }
+    bool operator==(const Arc& arc) const { return _id == arc._id; }
+    bool operator!=(const Arc& arc) const { return _id != arc._id; }
+    bool operator<(const Arc& arc) const { return _id < arc._id; }
+  };
+
+protected:
+  typedef std::vector<int> IntVector;
+
+  int _nodeNum;
+  int _edgeNum;
+  /// Offset of the first out-arc of every node, size _nodeNum + 1
+  IntVector _nodeFirstOut;
+  IntVector _arcSource;
+  IntVector _arcTarget;
+  IntVector _arcEdge;
+  IntVector _arcTwin;
+  /// Arc of every edge whose source is u(e)
+  IntVector _edgeArc;
+
+  CsrGraphBase()
+    : _nodeNum(0)
+    , _edgeNum(0)
+    , _nodeFirstOut(1, 0)
+    , _arcSource()
+    , _arcTarget()
+    , _arcEdge()
+    , _arcTwin()
+    , _edgeArc()
+  {
+  }
+
+  void clear()
+  {
+    _nodeNum = _edgeNum = 0;
+    _nodeFirstOut.assign(1, 0);
+    _arcSource.clear();
+    _arcTarget.clear();
+    _arcEdge.clear();
+    _arcTwin.clear();
+    _edgeArc.clear();
+  }
+
+  template<typename GR, typename NodeRefMap, typename EdgeRefMap>
+  void build(const GR& g, NodeRefMap& nodeRef, EdgeRefMap& edgeRef)
+  {
+    typedef typename GR::template NodeMap<int> IndexMap;
+
+    _nodeNum = lemon::countNodes(g);
+    _edgeNum = lemon::countEdges(g);
+
+    IndexMap index(g);
+    int i = 0;
+    for (typename GR::NodeIt v(g); v != lemon::INVALID; ++v, ++i)
+    {
+      index[v] = i;
+      nodeRef.set(v, Node(i));
+    }
+
+    // count degrees and turn them into row offsets
+    _nodeFirstOut.assign(_nodeNum + 1, 0);
+    for (typename GR::EdgeIt e(g); e != lemon::INVALID; ++e)
+    {
+      ++_nodeFirstOut[index[g.u(e)] + 1];
+      ++_nodeFirstOut[index[g.v(e)] + 1];
+    }
+    for (i = 0; i < _nodeNum; ++i)
+    {
+      _nodeFirstOut[i + 1] += _nodeFirstOut[i];
+    }
+
+    const int nArcs = 2 * _edgeNum;
+    _arcSource.resize(nArcs);
+    _arcTarget.resize(nArcs);
+    _arcEdge.resize(nArcs);
+    _arcTwin.resize(nArcs);
+    _edgeArc.resize(_edgeNum);
+
+    IntVector next(_nodeFirstOut.begin(), _nodeFirstOut.end() - 1);
+    int j = 0;
+    for (typename GR::EdgeIt e(g); e != lemon::INVALID; ++e, ++j)
+    {
+      int u = index[g.u(e)];
+      int v = index[g.v(e)];
+
+      int uv = next[u]++;
+      int vu = next[v]++;
+
+      _arcSource[uv] = _arcTarget[vu] = u;
+      _arcTarget[uv] = _arcSource[vu] = v;
+      _arcEdge[uv] = _arcEdge[vu] = j;
+      _arcTwin[uv] = vu;
+      _arcTwin[vu] = uv;
+      _edgeArc[j] = uv;
+
+      edgeRef.set(e, Edge(j));
+    }
+  }
+
+public:
+  Node operator()(int index) const { return Node(index); }
+  static int index(const Node& node) { return node._id; }
+
+  int degree(const Node& node) const
+  {
+    return _nodeFirstOut[node._id + 1] - _nodeFirstOut[node._id];
+  }
+
+  typedef lemon::True NodeNumTag;
+  typedef lemon::True EdgeNumTag;
+  typedef lemon::True ArcNumTag;
+
+  int nodeNum() const { return _nodeNum; }
+  int edgeNum() const { return _edgeNum; }
+  int arcNum() const { return 2 * _edgeNum; }
+
+  int maxNodeId() const { return _nodeNum - 1; }
+  int maxEdgeId() const { return _edgeNum - 1; }
+  int maxArcId() const { return 2 * _edgeNum - 1; }
+
+  static int id(const Node& node) { return node._id; }
+  static int id(const Edge& edge) { return edge._id; }
+  static int id(const Arc& arc) { return arc._id; }
+
+  static Node nodeFromId(int id) { return Node(id); }
+  static Edge edgeFromId(int id) { return Edge(id); }
+  Arc arcFromId(int id) const { return Arc(id, _arcEdge[id]); }
+
+  Node u(const Edge& edge) const { return Node(_arcSource[_edgeArc[edge._id]]); }
+  Node v(const Edge& edge) const { return Node(_arcTarget[_edgeArc[edge._id]]); }
+
+  Node source(const Arc& arc) const { return Node(_arcSource[arc._id]); }
+  Node target(const Arc& arc) const { return Node(_arcTarget[arc._id]); }
+
+  bool direction(const Arc& arc) const
+  {
+    return _edgeArc[arc._edge] == arc._id;
+  }
+
+  Arc direct(const Edge& edge, bool dir) const
+  {
+    int id = _edgeArc[edge._id];
+    return Arc(dir ? id : _arcTwin[id], edge._id);
+  }
+
+  void first(Node& node) const
+  {
+    node._id = _nodeNum - 1;
+  }
+
+  static void next(Node& node)
+  {
+    --node._id;
+  }
+
+  void first(Edge& edge) const
+  {
+    edge._id = _edgeNum - 1;
+  }
+
+  static void next(Edge& edge)
+  {
+    --edge._id;
+  }
+
+  void first(Arc& arc) const
+  {
+    arc._id = 2 * _edgeNum - 1;
+    arc._edge = arc._id != -1 ? _arcEdge[arc._id] : -1;
+  }
+
+  void next(Arc& arc) const
+  {
+    --arc._id;
+    arc._edge = arc._id != -1 ? _arcEdge[arc._id] : -1;
+  }
+
+  void firstOut(Arc& arc, const Node& node) const
+  {
+    int id = _nodeFirstOut[node._id];
+    setArc(arc, id != _nodeFirstOut[node._id + 1] ? id : -1);
+  }
+
+  void nextOut(Arc& arc) const
+  {
+    int id = arc._id + 1;
+    setArc(arc, id != _nodeFirstOut[_arcSource[arc._id] + 1] ? id : -1);
+  }
+
+  void firstIn(Arc& arc, const Node& node) const
+  {
+    int id = _nodeFirstOut[node._id];
+    setArc(arc, id != _nodeFirstOut[node._id + 1] ? _arcTwin[id] : -1);
+  }
+
+  void nextIn(Arc& arc) const
+  {
+    int id = _arcTwin[arc._id] + 1;
+    setArc(arc, id != _nodeFirstOut[_arcTarget[arc._id] + 1] ? _arcTwin[id] : -1);
+  }
+
+  void firstInc(Edge& edge, bool& dir, const Node& node) const
+  {
+    int id = _nodeFirstOut[node._id];
+    setInc(edge, dir, id != _nodeFirstOut[node._id + 1] ? id : -1);
+  }
+
+  void nextInc(Edge& edge, bool& dir) const
+  {
+    int id = _edgeArc[edge._id];
+    if (!dir)
+      id = _arcTwin[id];
+    int next = id + 1;
+    setInc(edge, dir, next != _nodeFirstOut[_arcSource[id] + 1] ? next : -1);
+  }
+
+private:
+  void setArc(Arc& arc, int id) const
+  {
+    arc._id = id;
+    arc._edge = id != -1 ? _arcEdge[id] : -1;
+  }
+
+  void setInc(Edge& edge, bool& dir, int id) const
+  {
+    if (id == -1)
+    {
+      edge._id = -1;
+      dir = true;
+    }
+    else
+    {
+      edge._id = _arcEdge[id];
+      dir = _edgeArc[edge._id] == id;
+    }
+  }
+};
+
+typedef lemon::GraphExtender<CsrGraphBase> ExtendedCsrGraphBase;
+
+/// \brief Read-only undirected graph in compressed sparse row format
+///
+/// Nodes, arcs and edges live in contiguous arrays, and the out-arcs
+/// (incident edges) of every node are stored consecutively. This makes
+/// neighborhood walks far cheaper than on lemon::ListGraph, at the price of
+/// not supporting any modification after build(). It is meant to be filled
+/// with the (preprocessed) ListGraph right before solving, and conforms to
+/// the LEMON graph concept, so MwcsGraph and the solver implementations can
+/// be instantiated with it.
+class CsrGraph : public ExtendedCsrGraphBase
+{
+  typedef ExtendedCsrGraphBase Parent;
+
+private:
+  CsrGraph(const CsrGraph&) : ExtendedCsrGraphBase() {}
+  void operator=(const CsrGraph&) {}
+
+public:
+  CsrGraph()
+    : Parent()
+  {
+  }
+
+  /// Build the graph as a copy of \c g, filling the node and edge references
+  template<typename GR, typename NodeRefMap, typename EdgeRefMap>
+  void build(const GR& g, NodeRefMap& nodeRef, EdgeRefMap& edgeRef)
+  {
+    clear();
+    CsrGraphBase::build(g, nodeRef, edgeRef);
+    notifier(Node()).build();
+    notifier(Edge()).build();
+    notifier(Arc()).build();
+  }
+
+  /// Build the graph as a copy of \c g, filling the node references
+  template<typename GR, typename NodeRefMap>
+  void build(const GR& g, NodeRefMap& nodeRef)
+  {
+    lemon::NullMap<typename GR::Edge, Edge> edgeRef;
+    build(g, nodeRef, edgeRef);
+  }
+
+  void clear()
+  {
+    notifier(Arc()).clear();
+    notifier(Edge()).clear();
+    notifier(Node()).clear();
+    CsrGraphBase::clear();
+  }
+};
+
+} // namespace nina
+
+#endif // CSRGRAPH_H
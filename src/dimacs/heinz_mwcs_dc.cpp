@@ -23,6 +23,7 @@
 #include "solver/impl/cutsolverrootedimpl.h"
 #include "solver/impl/cutsolverunrootedimpl.h"
 #include "solver/impl/cplex_cut/backoff.h"
+#include "solver/impl/callbackstats.h"
 
 #define PROBLEM "MWCS"
 #define METHOD "heinz-mwcs-dc"
@@ -43,12 +44,12 @@ typedef SolverType::NodeSet NodeSet;
 
 void printUsage(std::ostream& out, const char* argv0)
 {
-  out << "Usage: " << argv0 << " filename time threads outputfile" << std::endl;
+  out << "Usage: " << argv0 << " filename time threads outputfile [statsfile]" << std::endl;
 }
 
 int main(int argc, char** argv)
 {
-  if (argc != 5)
+  if (argc != 5 && argc != 6)
   {
     printUsage(std::cerr, argv[0]);
     return 1;
@@ -58,6 +59,7 @@ int main(int argc, char** argv)
   const int timelimit = atoi(argv[2]);
   const int threads = atoi(argv[3]);
   const std::string output = argv[4];
+  const std::string statsFile = argc == 6 ? argv[5] : "";
   
   if (timelimit <= 0)
   {
@@ -71,6 +73,8 @@ int main(int argc, char** argv)
     return 1;
   }
   
+  g_callbackStats.enable(!statsFile.empty());
+  
   bool std_out_used = false;
   if (output != "-")
   {
@@ -124,6 +128,11 @@ int main(int argc, char** argv)
   instance.printMwcsDimacs(solver.getSolutionModule(), *g_pOut);
   *g_pOut << "End" << std::endl;
   
+  if (!statsFile.empty() && !g_callbackStats.writeJson(statsFile))
+  {
+    std::cerr << "Could not write '" << statsFile << "'" << std::endl;
+  }
+  
   if (!std_out_used)
     delete g_pOut;
   
@@ -74,6 +74,9 @@ int main (int argc, char** argv)
   int n = -1;
   int timeLimit = -1;
   int h = 1;
+  int nThreads = 1;
+  int seed = 0;
+  double perturbation = 0;
 
   lemon::ArgParser ap(argc, argv);
 
@@ -102,7 +105,12 @@ int main (int argc, char** argv)
                     "     2 - uniform_edge\n"
                     "     3 - min_max_edge", h, false)
     .refOption("m", "Number of Monte Carlo iterations", n, false)
-    .refOption("z", "Enable negative hubs sampling", analyze, false);
+    .refOption("z", "Enable negative hubs sampling", analyze, false)
+    .refOption("threads", "Number of threads running Monte Carlo iterations (default: 1)", nThreads, false)
+    .refOption("s", "Random number generator seed (default: 0)", seed, false)
+    .refOption("perturb", "Fraction of nodes resampled per iteration, the spanning tree\n"
+                          "     is then updated incrementally (only for -h 1 and -h 2,\n"
+                          "     default: 0, i.e. resample all nodes)", perturbation, false);
   ap.parse();
 
   if (ap.given("version"))
@@ -117,6 +125,12 @@ int main (int argc, char** argv)
     return 1;
   }
 
+  if (nThreads <= 0)
+  {
+    std::cerr << "Invalid thread count '" << nThreads << "'" << std::endl;
+    return 1;
+  }
+
   bool pval = ap.given("FDR") && ap.given("lambda") && ap.given("a");
   if (pval)
   {
@@ -145,7 +159,7 @@ int main (int argc, char** argv)
   }
   
   Options options(static_cast<TreeHeuristicSolverImplType::EdgeHeuristic>(h),
-                  analyze, n, timeLimit);
+                  analyze, n, timeLimit, nThreads, seed, perturbation);
 
   g_verbosity = static_cast<VerbosityLevel>(verbosityLevel);
 
@@ -11,6 +11,10 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <limits>
 
 
 // ILOG stuff
@@ -32,7 +36,10 @@
 #include "solver/impl/cplexsolverimpl.h"
 #include "solver/impl/cutsolverrootedimpl.h"
 #include "solver/impl/cutsolverunrootedimpl.h"
+#include "solver/impl/cutsolverpcstimpl.h"
+#include "solver/impl/treeheuristicsolverunrootedimpl.h"
 #include "solver/impl/cplex_cut/backoff.h"
+#include "solver/impl/callbackstats.h"
 
 #include "mwcs.h"
 #include "utils.h"
@@ -57,7 +64,15 @@ typedef CplexSolverImpl<Graph> CplexSolverImplType;
 typedef CplexSolverImplType::Options Options;
 typedef CutSolverRootedImpl<Graph> CutSolverRootedImplType;
 typedef CutSolverUnrootedImpl<Graph> CutSolverUnrootedImplType;
+typedef CutSolverPcstImpl<Graph> CutSolverPcstImplType;
+typedef TreeHeuristicSolverImpl<Graph> TreeHeuristicSolverImplType;
+typedef TreeHeuristicSolverUnrootedImpl<Graph> TreeHeuristicSolverUnrootedImplType;
+typedef TreeHeuristicSolverImplType::Options McOptions;
 typedef SolverType::NodeSet NodeSet;
+typedef SolverType::NodeSetIt NodeSetIt;
+typedef std::vector<std::string> StringVector;
+typedef std::vector<double> DoubleVector;
+typedef DoubleVector::const_iterator DoubleVectorIt;
 
 BackOff createBackOff(int function, int period)
 {
@@ -71,6 +86,87 @@ BackOff createBackOff(int function, int period)
   }
 }
 
+// Determines a module to start the first unrooted solve from:
+// the best node of the (preprocessed) graph or a Monte Carlo module.
+// Returns its score, which is a lower bound on the optimal score.
+double determineStartModule(const MwcsGraphType& mwcs,
+                            int startModule,
+                            int nIterations,
+                            int timeLimit,
+                            SolverType::StringSet& startLabels)
+{
+  NodeSet module;
+  double score = -std::numeric_limits<double>::max();
+  if (startModule == 1)
+  {
+    const Graph& g = mwcs.getGraph();
+    const Graph::Node v = lemon::mapMax(g, mwcs.getScores());
+    if (v != lemon::INVALID)
+    {
+      module.insert(v);
+      score = mwcs.getScores()[v];
+    }
+  }
+  else
+  {
+    McOptions mcOptions(TreeHeuristicSolverImplType::EDGE_COST_RANDOM,
+                        false, nIterations, timeLimit);
+    SolverUnrootedType solver(new TreeHeuristicSolverUnrootedImplType(mcOptions));
+    if (solver.solve(mwcs))
+    {
+      module = solver.getSolutionModule();
+      score = solver.getSolutionWeight();
+    }
+  }
+
+  const NodeSet orgModule = mwcs.getOrgNodes(module);
+  for (NodeSetIt nodeIt = orgModule.begin(); nodeIt != orgModule.end(); ++nodeIt)
+  {
+    startLabels.insert(mwcs.getOrgLabel(*nodeIt));
+  }
+
+  if (g_verbosity >= VERBOSE_ESSENTIAL && !module.empty())
+  {
+    std::cout << "// Start module with " << orgModule.size()
+              << " node(s) and score " << score << std::endl;
+  }
+
+  return score;
+}
+
+// Parses a comma-separated list of FDR values and sorts it in increasing order
+bool parseFdrList(const std::string& str,
+                  StringVector& tokens,
+                  DoubleVector& fdrs)
+{
+  typedef std::pair<double, std::string> FdrPair;
+  std::vector<FdrPair> pairs;
+
+  std::stringstream ss(str);
+  std::string token;
+  while (std::getline(ss, token, ','))
+  {
+    double value = 0;
+    if (!FileTokenizer::parseDouble(token.data(), token.data() + token.size(), value))
+    {
+      return false;
+    }
+    pairs.push_back(std::make_pair(value, token));
+  }
+
+  std::sort(pairs.begin(), pairs.end());
+
+  tokens.clear();
+  fdrs.clear();
+  for (size_t i = 0; i < pairs.size(); ++i)
+  {
+    fdrs.push_back(pairs[i].first);
+    tokens.push_back(pairs[i].second);
+  }
+
+  return !fdrs.empty();
+}
+
 int main(int argc, char** argv)
 {
   // parse command line arguments
@@ -79,19 +175,31 @@ int main(int argc, char** argv)
   int timeLimit = -1;
   int memoryLimit = -1;
   bool noPreprocess = false;
+  bool pcstEdgeCosts = false;
+  bool nestedCuts = false;
+  bool noBackCuts = false;
+  bool cutTree = false;
+  bool minimalSeparators = false;
+  bool branchRoots = false;
   int enum_scheme = 1;
   int multiThreading = 1;
   int backOffFunction = 1;
   int backOffPeriod = 1;
+  int startModule = 0;
+  int startIterations = 10;
   std::string root;
   std::string outputFile;
   double lambda = 0;
   double a = 0;
   double fdr = 0;
+  std::string fdrList;
   std::string stpFile;
   std::string stpPcstFile;
   std::string nodeFile;
   std::string edgeFile;
+  std::string binFile;
+  std::string binOutFile;
+  std::string statsFile;
 
   lemon::ArgParser ap(argc, argv);
 
@@ -107,7 +215,8 @@ int main(int argc, char** argv)
                         "     1 - Linear waiting (default)\n"
                         "     2 - Quadratic waiting\n"
                         "     3 - Exponential waiting\n"
-                        "     4 - Infinite waiting", backOffFunction, false)
+                        "     4 - Infinite waiting\n"
+                        "     5 - Adaptive waiting (stops the cut loop on tailing off, ignores '-maxCuts')", backOffFunction, false)
     .refOption("no-pre", "Disable preprocessing", noPreprocess, false)
 //    .synonym("no-pre", "p")  // backwards compatability
     //.refOption("no-enum", "Disable graph-based decomposition/enumeration scheme", noEnum, false)
@@ -117,6 +226,11 @@ int main(int argc, char** argv)
                         "     2 - triconnected components", enum_scheme, false)
     .refOption("stp", "STP file", stpFile, false)
     .refOption("stp-pcst", "STP-PCST file", stpPcstFile, false)
+    .refOption("pcst-costs", "Keep the edge costs of the STP-PCST file on the edges rather than\n"
+                             "     splitting every edge by a node (implies '-no-pre' and '-enum 0')",
+               pcstEdgeCosts, false)
+    .refOption("bin", "Binary snapshot file (see '-bin-out')", binFile, false)
+    .refOption("bin-out", "Write a binary snapshot of the (preprocessed) instance to file", binOutFile, false)
     .refOption("v", "Specifies the verbosity level:\n"
                     "     0 - No output\n"
                     "     1 - Only necessary output\n"
@@ -129,8 +243,25 @@ int main(int argc, char** argv)
     .refOption("lambda", "Specifies lambda", lambda, false)
     .refOption("a", "Specifies a", a, false)
     .refOption("FDR", "Specifies fdr", fdr, false)
-    .refOption("maxCuts", "Specifies the number of cut iterations per node in the B&B tree (default: 3)",
-               maxNumberOfCuts, false);
+    .refOption("FDRs", "Specifies a comma-separated list of fdr values, each is solved in turn", fdrList, false)
+    .refOption("maxCuts", "Specifies the number of cut iterations per node in the B&B tree (default: 3, not used by '-b 5')",
+               maxNumberOfCuts, false)
+    .refOption("nested", "Generate nested cuts in the user cut separation", nestedCuts, false)
+    .refOption("no-back", "Disable back cuts in the user cut separation", noBackCuts, false)
+    .refOption("cut-tree", "Separate user cuts using a Gomory-Hu cut tree on the support graph (unrooted only)",
+               cutTree, false)
+    .refOption("min-sep", "Strengthen the lazy constraints using minimal separators (not used by PCST)",
+               minimalSeparators, false)
+    .refOption("branch-y", "Branch on the root selection variables first (unrooted only)",
+               branchRoots, false)
+    .refOption("start", "Module to start the first unrooted solve from, its score and the\n"
+                        "     preprocessing lower bound are used as objective cutoff:\n"
+                        "     0 - None (default)\n"
+                        "     1 - Best node after preprocessing\n"
+                        "     2 - Monte Carlo tree heuristic", startModule, false)
+    .refOption("start-m", "Number of Monte Carlo iterations of '-start 2' (default: 10)",
+               startIterations, false)
+    .refOption("stats", "Write statistics of the CPLEX callbacks as JSON to file", statsFile, false);
   ap.parse();
 
   if (ap.given("version"))
@@ -139,20 +270,43 @@ int main(int argc, char** argv)
     return 0;
   }
 
-  if (!(ap.given("n") && ap.given("e")) && !ap.given("stp") &&  !ap.given("stp-pcst"))
+  g_callbackStats.enable(!statsFile.empty());
+
+  if (!(ap.given("n") && ap.given("e")) && !ap.given("stp") &&  !ap.given("stp-pcst") && !ap.given("bin"))
   {
-    std::cerr << "Please specify either '-n' and '-e', or '-stp', or '-stp-pcst'" << std::endl;
+    std::cerr << "Please specify either '-n' and '-e', or '-stp', or '-stp-pcst', or '-bin'" << std::endl;
     return 1;
   }
 
-  bool pval = ap.given("FDR");
+  // thresholds to solve, in increasing order
+  const bool sweep = ap.given("FDRs");
+  StringVector fdrTokens;
+  DoubleVector fdrs;
+  if (sweep)
+  {
+    if (!parseFdrList(fdrList, fdrTokens, fdrs))
+    {
+      std::cerr << "Value of FDRs should be a comma-separated list of numbers" << std::endl;
+      return 1;
+    }
+  }
+  else
+  {
+    fdrTokens.push_back(fdrList);
+    fdrs.push_back(fdr);
+  }
+
+  bool pval = ap.given("FDR") || sweep;
   if (pval)
   {
     // check if ok
-    if (!(0 <= fdr && fdr <= 1))
+    for (DoubleVectorIt fdrIt = fdrs.begin(); fdrIt != fdrs.end(); ++fdrIt)
     {
-      std::cerr << "Value of FDR should be in the range [0,1]" << std::endl;
-      return 1;
+      if (!(0 <= *fdrIt && *fdrIt <= 1))
+      {
+        std::cerr << "Value of FDR should be in the range [0,1]" << std::endl;
+        return 1;
+      }
     }
     if (ap.given("lambda") && !(0 <= lambda && lambda <= 1))
     {
@@ -176,9 +330,11 @@ int main(int argc, char** argv)
   }
   else if (!stpPcstFile.empty())
   {
-    pParser = new StpPcstParserType(stpPcstFile);
+    pParser = new StpPcstParserType(stpPcstFile, pcstEdgeCosts);
+    // preprocessing and decomposition do not support edge costs
+    noPreprocess |= pcstEdgeCosts;
   }
-  else
+  else if (binFile.empty())
   {
     pParser = new MwcsParserType(nodeFile, edgeFile);
   }
@@ -195,84 +351,187 @@ int main(int argc, char** argv)
     pMwcs = new MwcsGraphType();
   }
 
-  if (!pMwcs->init(pParser, pval))
+  if (pParser ? !pMwcs->init(pParser, pval) : !pMwcs->readBinary(binFile))
   {
     delete pParser;
     return 1;
   }
 
-  // compute scores
-  if (pval)
+  if (pval && !pMwcs->hasPValues())
   {
-    if (ap.given("a") && ap.given("lambda"))
-      pMwcs->computeScores(lambda, a, fdr);
-    else
-      pMwcs->computeScores(fdr);
+    std::cerr << "Snapshot '" << binFile << "' contains no p-values" << std::endl;
+    delete pParser;
+    return 1;
   }
 
-  // Solve
-  const NodeSet rootNodeSet = pMwcs->getNodeByLabel(root);
-  assert(rootNodeSet.size() == 0 || rootNodeSet.size() == 1);
-
-  if (pPreprocessedMwcs && (enum_scheme == 0 || rootNodeSet.size() > 0))
+  if (pPreprocessedMwcs && pMwcs->hasEdgeCosts())
   {
-    pPreprocessedMwcs->preprocess(rootNodeSet);
+    std::cerr << "Snapshot '" << binFile << "' has edge costs, which require '-no-pre'" << std::endl;
+    delete pParser;
+    delete pMwcs;
+    return 1;
   }
 
-  SolverType* pSolver = NULL;
-
-  Options options(createBackOff(backOffFunction, backOffPeriod),
-                  true,
+  // options keep a reference to the back-off, which is shared by all solves
+  const BackOff backOff = createBackOff(backOffFunction, backOffPeriod);
+  // the analysis only considers node weights
+  Options options(backOff,
+                  !pcstEdgeCosts,
                   maxNumberOfCuts,
                   enum_scheme,
                   timeLimit,
                   multiThreading,
                   memoryLimit,
-                  !stpPcstFile.empty());
-
-  if (rootNodeSet.size() == 0 && !root.empty())
+                  !stpPcstFile.empty(),
+                  nestedCuts,
+                  !noBackCuts,
+                  cutTree,
+                  minimalSeparators,
+                  branchRoots);
+
+  // labels of the original nodes of the previous module, modules are
+  // nested as the FDR grows, so each solve starts from the previous one
+  SolverType::StringSet startLabels;
+
+  for (size_t fdrIdx = 0; fdrIdx < fdrs.size(); ++fdrIdx)
   {
-    std::cerr << "No node with label '" << root
-              << "' present. Defaulting to unrooted formulation." << std::endl;
-  }
+    const double fdrValue = fdrs[fdrIdx];
 
-  if (rootNodeSet.size() == 1)
-  {
-    SolverRootedType* pSolverRooted = new SolverRootedType(new CutSolverRootedImplType(options));
-    pSolverRooted->solve(*pMwcs, rootNodeSet);
-    pSolver = pSolverRooted;
-  }
-  else if (enum_scheme == 0)
-  {
-    SolverUnrootedType* pSolverUnrooted = new SolverUnrootedType(new CutSolverUnrootedImplType(options));
-    pSolverUnrooted->solve(*pMwcs);
-    pSolver = pSolverUnrooted;
-  }
-  else
-  {
-    SolverUnrootedType* pSolverUnrooted = new EnumSolverUnrootedType(new CutSolverUnrootedImplType(options),
-                                                                     new CutSolverRootedImplType(options),
-                                                                     !noPreprocess, enum_scheme);
-    pSolverUnrooted->solve(*pMwcs);
-    pSolver = pSolverUnrooted;
-  }
+    // compute scores
+    if (pval)
+    {
+      if (sweep && g_verbosity >= VERBOSE_ESSENTIAL)
+      {
+        std::cout << std::endl << "// FDR " << fdrValue << " ("
+                  << fdrIdx + 1 << "/" << fdrs.size() << ")" << std::endl;
+      }
+
+      if (ap.given("a") && ap.given("lambda"))
+        pMwcs->computeScores(lambda, a, fdrValue);
+      else
+        pMwcs->computeScores(fdrValue);
+    }
 
-  if (outputFile != "-" && !outputFile.empty())
-  {
-    std::ofstream outFile(outputFile.c_str());
-    pMwcs->printHeinz(pSolver->getSolutionModule(), outFile);
-    pMwcs->printModule(pSolver->getSolutionModule(), std::cout, false);
-  }
-  else if (outputFile == "-")
-  {
-    pMwcs->printHeinz(pSolver->getSolutionModule(), std::cout);
-  }
-  else
-  {
-    pMwcs->printModule(pSolver->getSolutionModule(), std::cout, false);
+    // a preprocessed snapshot can only be reused for the same root
+    if (pPreprocessedMwcs && pPreprocessedMwcs->isPreprocessed())
+    {
+      NodeSet orgRootNodeSet;
+      if (pMwcs->getOrgNodeByLabel(root) != lemon::INVALID)
+      {
+        orgRootNodeSet.insert(pMwcs->getOrgNodeByLabel(root));
+      }
+      if (orgRootNodeSet != pPreprocessedMwcs->getPreprocessedRootNodes())
+      {
+        pPreprocessedMwcs->clear();
+      }
+    }
+
+    // Solve
+    const NodeSet rootNodeSet = pMwcs->getNodeByLabel(root);
+    assert(rootNodeSet.size() == 0 || rootNodeSet.size() == 1);
+
+    if (pPreprocessedMwcs && !pPreprocessedMwcs->isPreprocessed()
+        && (enum_scheme == 0 || rootNodeSet.size() > 0))
+    {
+      pPreprocessedMwcs->setThreads(multiThreading);
+      pPreprocessedMwcs->preprocess(rootNodeSet);
+    }
+
+    if (fdrIdx == 0 && !binOutFile.empty() && !pMwcs->writeBinary(binOutFile))
+    {
+      delete pParser;
+      delete pMwcs;
+      return 1;
+    }
+
+    // lower bound for the direct unrooted solve, the subproblems of the
+    // enumeration and the rooted problem need not attain it
+    double LB = -std::numeric_limits<double>::max();
+    if (startModule != 0 && rootNodeSet.empty() && !pMwcs->hasEdgeCosts())
+    {
+      if (startLabels.empty())
+      {
+        LB = determineStartModule(*pMwcs, startModule, startIterations, timeLimit, startLabels);
+      }
+      if (pPreprocessedMwcs && pPreprocessedMwcs->getLowerBound() > 0)
+      {
+        LB = std::max(LB, pPreprocessedMwcs->getLowerBound());
+      }
+    }
+
+    SolverType* pSolver = NULL;
+
+    if (rootNodeSet.size() == 0 && !root.empty())
+    {
+      std::cerr << "No node with label '" << root
+                << "' present. Defaulting to unrooted formulation." << std::endl;
+    }
+
+    if (pMwcs->hasEdgeCosts())
+    {
+      if (!root.empty())
+      {
+        std::cerr << "Root node is not supported with edge costs. Defaulting to unrooted formulation." << std::endl;
+      }
+
+      SolverUnrootedType* pSolverUnrooted = new SolverUnrootedType(new CutSolverPcstImplType(options));
+      pSolverUnrooted->setStartModule(startLabels);
+      pSolverUnrooted->solve(*pMwcs);
+      pSolver = pSolverUnrooted;
+    }
+    else if (rootNodeSet.size() == 1)
+    {
+      SolverRootedType* pSolverRooted = new SolverRootedType(new CutSolverRootedImplType(options));
+      pSolverRooted->setStartModule(startLabels);
+      pSolverRooted->solve(*pMwcs, rootNodeSet);
+      pSolver = pSolverRooted;
+    }
+    else if (enum_scheme == 0)
+    {
+      SolverUnrootedType* pSolverUnrooted = new SolverUnrootedType(new CutSolverUnrootedImplType(options));
+      pSolverUnrooted->setStartModule(startLabels);
+      pSolverUnrooted->setLowerBound(LB);
+      pSolverUnrooted->solve(*pMwcs);
+      pSolver = pSolverUnrooted;
+    }
+    else
+    {
+      SolverUnrootedType* pSolverUnrooted = new EnumSolverUnrootedType(new CutSolverUnrootedImplType(options),
+                                                                       new CutSolverRootedImplType(options),
+                                                                       !noPreprocess, enum_scheme);
+      pSolverUnrooted->setStartModule(startLabels);
+      pSolverUnrooted->solve(*pMwcs);
+      pSolver = pSolverUnrooted;
+    }
+
+    const NodeSet& module = pSolver->getSolutionModule();
+    if (outputFile != "-" && !outputFile.empty())
+    {
+      // one output file per threshold
+      std::string filename = sweep ? outputFile + "_FDR" + fdrTokens[fdrIdx] : outputFile;
+      std::ofstream outFile(filename.c_str());
+      pMwcs->printHeinz(module, outFile);
+      pMwcs->printModule(module, std::cout, false);
+    }
+    else if (outputFile == "-")
+    {
+      pMwcs->printHeinz(module, std::cout);
+    }
+    else
+    {
+      pMwcs->printModule(module, std::cout, false);
+    }
+
+    startLabels.clear();
+    const NodeSet orgModule = pMwcs->getOrgNodes(module);
+    for (NodeSetIt nodeIt = orgModule.begin(); nodeIt != orgModule.end(); ++nodeIt)
+    {
+      startLabels.insert(pMwcs->getOrgLabel(*nodeIt));
+    }
+
+    delete pSolver;
   }
 
-  delete pSolver;
 
 //  if (rootNode == lemon::INVALID)
 //  {
@@ -349,6 +608,11 @@ int main(int argc, char** argv)
 
   std::cerr << "Time: " << g_timer.realTime() << "s" << std::endl;
 
+  if (!statsFile.empty() && !g_callbackStats.writeJson(statsFile))
+  {
+    std::cerr << "Could not write '" << statsFile << "'" << std::endl;
+  }
+
   delete pParser;
   delete pMwcs;
 
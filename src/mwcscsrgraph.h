@@ -0,0 +1,157 @@
+/*
+ * mwcscsrgraph.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef MWCSCSRGRAPH_H
+#define MWCSCSRGRAPH_H
+
+#include <set>
+#include <string>
+#include <lemon/core.h>
+#include "csrgraph.h"
+#include "mwcsgraph.h"
+
+namespace nina {
+namespace mwcs {
+
+/// Owns the CsrGraph snapshot and its maps. Kept in a separate base class
+/// that is constructed before and destroyed after MwcsGraph, whose component
+/// map is registered with the snapshot graph.
+template<typename SNODE>
+class MwcsCsrGraphStorage
+{
+protected:
+  typedef CsrGraph::NodeMap<std::string> CsrLabelNodeMap;
+  typedef CsrGraph::NodeMap<double> CsrWeightNodeMap;
+  typedef CsrGraph::NodeMap<SNODE> ToSourceNodeMap;
+
+  CsrGraph* _pCsrG;
+  CsrLabelNodeMap* _pCsrLabel;
+  CsrWeightNodeMap* _pCsrScore;
+  ToSourceNodeMap* _pToSource;
+
+  MwcsCsrGraphStorage()
+    : _pCsrG(NULL)
+    , _pCsrLabel(NULL)
+    , _pCsrScore(NULL)
+    , _pToSource(NULL)
+  {
+  }
+
+  ~MwcsCsrGraphStorage()
+  {
+    clear();
+  }
+
+  void clear()
+  {
+    // maps must go before the graph they are registered with
+    delete _pToSource;
+    delete _pCsrScore;
+    delete _pCsrLabel;
+    delete _pCsrG;
+    _pToSource = NULL;
+    _pCsrScore = NULL;
+    _pCsrLabel = NULL;
+    _pCsrG = NULL;
+  }
+};
+
+/// \brief MWCS instance backed by a CsrGraph
+///
+/// Takes a snapshot of the current graph of another MwcsGraph (typically a
+/// preprocessed one) and stores it in CSR format, so that solvers can be
+/// instantiated with CsrGraph. Solutions are mapped back to nodes of the
+/// source graph with mapToSource().
+template<typename MWCSGR>
+class MwcsCsrGraph : private MwcsCsrGraphStorage<typename MWCSGR::Graph::Node>
+                   , public MwcsGraph<CsrGraph>
+{
+public:
+  typedef MWCSGR SourceMwcsGraphType;
+  typedef typename SourceMwcsGraphType::Graph SourceGraph;
+  typedef typename SourceGraph::Node SourceNode;
+  typedef typename SourceGraph::NodeIt SourceNodeIt;
+  typedef typename SourceMwcsGraphType::NodeSet SourceNodeSet;
+
+  typedef MwcsCsrGraphStorage<SourceNode> Storage;
+  typedef MwcsGraph<CsrGraph> Parent;
+  typedef Parent::Graph Graph;
+  typedef Parent::WeightNodeMap WeightNodeMap;
+  typedef Parent::LabelNodeMap LabelNodeMap;
+  typedef Parent::NodeSet NodeSet;
+  typedef Parent::NodeSetIt NodeSetIt;
+
+  TEMPLATE_GRAPH_TYPEDEFS(Graph);
+
+  typedef typename Storage::ToSourceNodeMap ToSourceNodeMap;
+  typedef typename SourceGraph::template NodeMap<Node> ToCsrNodeMap;
+
+  using Parent::init;
+
+public:
+  MwcsCsrGraph()
+    : Storage()
+    , Parent()
+  {
+  }
+
+  /// Build the CSR snapshot of the current graph of \c source
+  bool init(const SourceMwcsGraphType& source);
+
+  SourceNode toSource(Node v) const
+  {
+    assert(this->_pToSource);
+    return (*this->_pToSource)[v];
+  }
+
+  void mapToSource(const NodeSet& nodes, SourceNodeSet& result) const
+  {
+    for (NodeSetIt nodeIt = nodes.begin(); nodeIt != nodes.end(); ++nodeIt)
+    {
+      result.insert(toSource(*nodeIt));
+    }
+  }
+};
+
+template<typename MWCSGR>
+inline bool MwcsCsrGraph<MWCSGR>::init(const SourceMwcsGraphType& source)
+{
+  const SourceGraph& g = source.getGraph();
+  const typename SourceMwcsGraphType::WeightNodeMap& score = source.getScores();
+  const typename SourceMwcsGraphType::LabelNodeMap& label = source.getLabels();
+
+  Graph* pCsrG = new Graph();
+  ToCsrNodeMap toCsr(g);
+  pCsrG->build(g, toCsr);
+
+  LabelNodeMap* pCsrLabel = new LabelNodeMap(*pCsrG);
+  WeightNodeMap* pCsrScore = new WeightNodeMap(*pCsrG);
+  ToSourceNodeMap* pToSource = new ToSourceNodeMap(*pCsrG);
+  for (SourceNodeIt v(g); v != lemon::INVALID; ++v)
+  {
+    Node csrV = toCsr[v];
+    (*pCsrLabel)[csrV] = label[v];
+    (*pCsrScore)[csrV] = score[v];
+    (*pToSource)[csrV] = v;
+  }
+
+  // Parent::init() releases the component map of the previous snapshot,
+  // only then can the previous graph be freed
+  bool res = Parent::init(pCsrG, pCsrLabel, pCsrScore, NULL);
+
+  Storage::clear();
+  this->_pCsrG = pCsrG;
+  this->_pCsrLabel = pCsrLabel;
+  this->_pCsrScore = pCsrScore;
+  this->_pToSource = pToSource;
+
+  return res;
+}
+
+} // namespace mwcs
+} // namespace nina
+
+#endif // MWCSCSRGRAPH_H
@@ -14,11 +14,15 @@
 #include <sstream>
 #include <vector>
 #include <set>
+#include <iterator>
 #include <lemon/core.h>
+#include <lemon/adaptors.h>
+#include <lemon/kruskal.h>
 #include <lemon/lgf_writer.h>
 #include <lemon/connectivity.h>
 #include "utils.h"
 #include "parser/parser.h"
+#include "parser/binaryfile.h"
 #include "solver/spqrtree.h"
 
 namespace nina {
@@ -48,12 +52,15 @@ public:
   typedef typename NodeSet::const_iterator NodeSetIt;
   typedef typename std::vector<NodeSet> NodeSetVector;
   typedef typename NodeSetVector::const_iterator NodeSetVectorIt;
+  typedef typename std::vector<Edge> EdgeVector;
+  typedef typename EdgeVector::const_iterator EdgeVectorIt;
   
 public:
   MwcsGraph();
   virtual ~MwcsGraph()
   {
     delete _pComp;
+    delete _pEdgeCost;
 
     if (_parserInit)
     {
@@ -69,6 +76,11 @@ public:
                     WeightNodeMap* pScore,
                     WeightNodeMap* pPval);
 
+  /// Writes the instance to a binary snapshot that can be loaded by readBinary()
+  bool writeBinary(const std::string& filename) const;
+  /// Loads an instance from a binary snapshot written by writeBinary()
+  bool readBinary(const std::string& filename);
+
 private:
   Graph* _pG;
   LabelNodeMap* _pLabel;
@@ -76,10 +88,13 @@ private:
   WeightNodeMap* _pScore;
   InvLabelNodeMap _invLabel;
   IntNodeMap* _pComp;
+  /// Edge costs, only present for instances parsed with edge weights
+  WeightEdgeMap* _pEdgeCost;
   int _nNodes;
   int _nEdges;
   int _nArcs;
   int _nComponents;
+  bool _hasPVal;
 
 protected:
   bool _parserInit;
@@ -92,6 +107,19 @@ protected:
   {
   }
 
+  virtual void writeSnapshot(BinaryWriter& out) const;
+
+  /// Loading a snapshot requires a graph that can be modified, which is
+  /// only the case for instances that own their graph (MwcsGraphParser)
+  virtual bool readSnapshot(BinaryReader& in)
+  {
+    return false;
+  }
+
+  /// Rebuilds the graph and its maps from a snapshot. Not virtual, so that
+  /// it is only instantiated for graphs supporting addNode() and addEdge().
+  bool readGraphSnapshot(BinaryReader& in);
+
 public:
   virtual const Graph& getGraph() const
   {
@@ -243,6 +271,38 @@ public:
     return _pPVal;
   }
 
+  /// Whether the weights of the input were p-values
+  bool hasPValues() const
+  {
+    return _hasPVal;
+  }
+
+  /// Whether the instance has edge costs, which are subtracted from the
+  /// weight of a module along a spanning tree. Preprocessing does not
+  /// support edge costs, so they refer to both the original and the
+  /// current graph.
+  bool hasEdgeCosts() const
+  {
+    return _pEdgeCost != NULL;
+  }
+
+  const WeightEdgeMap& getEdgeCosts() const
+  {
+    assert(_pEdgeCost);
+    return *_pEdgeCost;
+  }
+
+  double getEdgeCost(Edge e) const
+  {
+    assert(_pEdgeCost && e != lemon::INVALID);
+    return (*_pEdgeCost)[e];
+  }
+
+  /// Determines a minimum cost spanning forest of the subgraph induced
+  /// by \c module, returns its cost
+  double getSpanningTree(const NodeSet& module,
+                         EdgeVector& treeEdges) const;
+
   int getOrgNodeCount() const
   {
     return _nNodes;
@@ -361,10 +421,12 @@ inline MwcsGraph<GR, NWGHT, NLBL, EWGHT>::MwcsGraph()
   , _pScore(NULL)
   , _invLabel()
   , _pComp(NULL)
+  , _pEdgeCost(NULL)
   , _nNodes(0)
   , _nEdges(0)
   , _nArcs(0)
   , _nComponents(0)
+  , _hasPVal(false)
   , _parserInit(false)
 {
 }
@@ -374,6 +436,9 @@ inline bool MwcsGraph<GR, NWGHT, NLBL, EWGHT>::init(ParserType* pParser, bool pv
 {
   assert(pParser);
 
+  delete _pEdgeCost;
+  _pEdgeCost = NULL;
+
   if (_parserInit)
   {
     delete _pLabel;
@@ -389,6 +454,12 @@ inline bool MwcsGraph<GR, NWGHT, NLBL, EWGHT>::init(ParserType* pParser, bool pv
   pParser->setGraph(_pG);
   pParser->setIdNodeMap(_pLabel);
 
+  if (pParser->hasEdgeWeights())
+  {
+    _pEdgeCost = new WeightEdgeMap(*_pG);
+    pParser->setWeightEdgeMap(_pEdgeCost);
+  }
+
   if (pval)
     pParser->setWeightNodeMap(_pPVal);
   else
@@ -398,6 +469,7 @@ inline bool MwcsGraph<GR, NWGHT, NLBL, EWGHT>::init(ParserType* pParser, bool pv
 
   if (pParser->parse())
   {
+    _hasPVal = pval;
     _nNodes = pParser->getNodeCount();
     _nEdges = pParser->getEdgeCount();
 
@@ -720,6 +792,19 @@ inline void MwcsGraph<GR, NWGHT, NLBL, EWGHT>::printPcstDimacs(const NodeSet& mo
     }
   }
   
+  // with edge costs, a module is connected by a minimum spanning tree
+  if (_pEdgeCost)
+  {
+    const Graph& g = getGraph();
+    EdgeVector treeEdges;
+    getSpanningTree(module, treeEdges);
+    for (EdgeVectorIt edgeIt = treeEdges.begin(); edgeIt != treeEdges.end(); ++edgeIt)
+    {
+      edges.push_back(std::make_pair(atoi(getLabel(g.u(*edgeIt)).c_str()),
+                                     atoi(getLabel(g.v(*edgeIt)).c_str())));
+    }
+  }
+  
   out << "Vertices " << vertices.size() << std::endl;
   for (IntVectorIt nodeIt = vertices.begin(); nodeIt != vertices.end(); ++nodeIt)
   {
@@ -787,6 +872,9 @@ inline bool MwcsGraph<GR, NWGHT, NLBL, EWGHT>::init(Graph* pG,
                                                     WeightNodeMap* pScore,
                                                     WeightNodeMap* pPVal)
 {
+  delete _pEdgeCost;
+  _pEdgeCost = NULL;
+
   if (_parserInit)
   {
     delete _pLabel;
@@ -800,6 +888,7 @@ inline bool MwcsGraph<GR, NWGHT, NLBL, EWGHT>::init(Graph* pG,
   _pLabel = pLabel;
   _pPVal = pPVal;
   _pScore = pScore;
+  _hasPVal = pPVal != NULL;
 
   _nNodes = lemon::countNodes(*_pG);
   _nEdges = lemon::countEdges(*_pG);
@@ -814,6 +903,204 @@ inline bool MwcsGraph<GR, NWGHT, NLBL, EWGHT>::init(Graph* pG,
   return true;
 }
 
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline bool MwcsGraph<GR, NWGHT, NLBL, EWGHT>::writeBinary(const std::string& filename) const
+{
+  BinaryWriter out;
+  if (!out.open(filename))
+  {
+    std::cerr << "Error: could not open file "
+              << filename << " for writing" << std::endl;
+    return false;
+  }
+
+  writeSnapshot(out);
+
+  if (!out.good())
+  {
+    std::cerr << "Error: could not write to file " << filename << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline bool MwcsGraph<GR, NWGHT, NLBL, EWGHT>::readBinary(const std::string& filename)
+{
+  BinaryReader in;
+  if (!in.open(filename))
+  {
+    std::cerr << "Error: could not open file "
+              << filename << " for reading or it is not a snapshot" << std::endl;
+    return false;
+  }
+
+  if (!readSnapshot(in))
+  {
+    std::cerr << "Error: snapshot " << filename << " is corrupt" << std::endl;
+    return false;
+  }
+
+  if (g_verbosity >= VERBOSE_ESSENTIAL)
+  {
+    std::cout << "// Successfully loaded '"
+              << filename
+              << "': contains " << _nNodes << " nodes, "
+              << _nEdges << " edges and "
+              << _nComponents << " component(s)" << std::endl;
+  }
+
+  return true;
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void MwcsGraph<GR, NWGHT, NLBL, EWGHT>::writeSnapshot(BinaryWriter& out) const
+{
+  const Graph& g = *_pG;
+
+  // nodes are numbered in iteration order
+  IntNodeMap index(g);
+  std::vector<std::string> labels;
+  std::vector<double> pval, score;
+  std::vector<int32_t> comp;
+  int32_t nNodes = 0;
+  for (NodeIt v(g); v != lemon::INVALID; ++v, ++nNodes)
+  {
+    index[v] = nNodes;
+    labels.push_back((*_pLabel)[v]);
+    if (_hasPVal)
+    {
+      pval.push_back((*_pPVal)[v]);
+    }
+    score.push_back((*_pScore)[v]);
+    comp.push_back((*_pComp)[v]);
+  }
+
+  std::vector<int32_t> edges;
+  std::vector<double> edgeCost;
+  for (EdgeIt e(g); e != lemon::INVALID; ++e)
+  {
+    edges.push_back(index[g.u(e)]);
+    edges.push_back(index[g.v(e)]);
+    if (_pEdgeCost)
+    {
+      edgeCost.push_back((*_pEdgeCost)[e]);
+    }
+  }
+
+  out.writeInt(nNodes);
+  out.writeInt(static_cast<int32_t>(edges.size() / 2));
+  out.writeInt(_nComponents);
+  out.writeUInt((_hasPVal ? 1 : 0) | (_pEdgeCost ? 2 : 0));
+  out.writeStrings(labels);
+  out.writeArray(pval);
+  out.writeArray(score);
+  out.writeArray(comp);
+  out.writeArray(edges);
+  out.writeArray(edgeCost);
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline bool MwcsGraph<GR, NWGHT, NLBL, EWGHT>::readGraphSnapshot(BinaryReader& in)
+{
+  int32_t nNodes = -1, nEdges = -1, nComponents = -1;
+  uint32_t flags = 0;
+  if (!in.readInt(nNodes) || !in.readInt(nEdges)
+      || !in.readInt(nComponents) || !in.readUInt(flags)
+      || nNodes < 0 || nEdges < 0 || nComponents < 0)
+  {
+    return false;
+  }
+
+  const bool hasPVal = flags & 1;
+  const bool hasEdgeCosts = flags & 2;
+  const uint64_t* pLabelOffsets = NULL;
+  const char* pLabelChars = NULL;
+  in.readStrings(nNodes, pLabelOffsets, pLabelChars);
+  const double* pPVal = hasPVal ? in.readArray<double>(nNodes) : NULL;
+  const double* pScore = in.readArray<double>(nNodes);
+  const int32_t* pComp = in.readArray<int32_t>(nNodes);
+  const int32_t* pEdges = in.readArray<int32_t>(2 * static_cast<size_t>(nEdges));
+  const double* pEdgeCost = hasEdgeCosts ? in.readArray<double>(nEdges) : NULL;
+  if (!in.good())
+  {
+    return false;
+  }
+
+  for (int32_t i = 0; i < nNodes; ++i)
+  {
+    if (pLabelOffsets[i] > pLabelOffsets[i + 1])
+      return false;
+  }
+  for (int32_t i = 0; i < 2 * nEdges; ++i)
+  {
+    if (!(0 <= pEdges[i] && pEdges[i] < nNodes))
+      return false;
+  }
+
+  delete _pEdgeCost;
+  _pEdgeCost = NULL;
+
+  if (_parserInit)
+  {
+    delete _pLabel;
+    delete _pPVal;
+    delete _pScore;
+    delete _pG;
+  }
+
+  delete _pComp;
+  _parserInit = true;
+  initParserMembers(_pG, _pLabel, _pPVal, _pScore);
+  if (hasEdgeCosts)
+  {
+    _pEdgeCost = new WeightEdgeMap(*_pG);
+  }
+
+  _pG->reserveNode(nNodes);
+  _pG->reserveEdge(nEdges);
+  _invLabel.clear();
+  _invLabel.reserve(nNodes);
+
+  // add the nodes in reverse, so that they are iterated in the order
+  // in which they were written (and get the ids they had when parsed)
+  std::vector<Node> nodes(nNodes);
+  for (int32_t i = nNodes - 1; i >= 0; --i)
+  {
+    nodes[i] = _pG->addNode();
+  }
+
+  _pComp = new IntNodeMap(*_pG, -1);
+  for (int32_t i = 0; i < nNodes; ++i)
+  {
+    Node v = nodes[i];
+    std::string label(pLabelChars + pLabelOffsets[i], pLabelChars + pLabelOffsets[i + 1]);
+    _pLabel->set(v, label);
+    _invLabel[label] = v;
+    _pPVal->set(v, hasPVal ? pPVal[i] : 0);
+    _pScore->set(v, pScore[i]);
+    _pComp->set(v, pComp[i]);
+  }
+
+  for (int32_t i = nEdges - 1; i >= 0; --i)
+  {
+    Edge e = _pG->addEdge(nodes[pEdges[2 * i]], nodes[pEdges[2 * i + 1]]);
+    if (_pEdgeCost)
+    {
+      _pEdgeCost->set(e, pEdgeCost[i]);
+    }
+  }
+
+  _hasPVal = hasPVal;
+  _nNodes = nNodes;
+  _nEdges = nEdges;
+  _nArcs = 2 * nEdges;
+  _nComponents = nComponents;
+
+  return true;
+}
+
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
 inline double MwcsGraph<GR, NWGHT, NLBL, EWGHT>::getTotalNodeProfitPCST() const
 {
@@ -822,6 +1109,13 @@ inline double MwcsGraph<GR, NWGHT, NLBL, EWGHT>::getTotalNodeProfitPCST() const
   const Graph& orgG = getOrgGraph();
   for (NodeIt v(orgG); v != lemon::INVALID; ++v)
   {
+    // without edge costs, the edges are nodes labeled 'u--v'
+    if (_pEdgeCost)
+    {
+      res += getOrgScore(v);
+      continue;
+    }
+
     const std::string& label = getOrgLabel(v);
     
     int idU = -1;
@@ -834,6 +1128,26 @@ inline double MwcsGraph<GR, NWGHT, NLBL, EWGHT>::getTotalNodeProfitPCST() const
   
   return res;
 }
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline double MwcsGraph<GR, NWGHT, NLBL, EWGHT>::getSpanningTree(const NodeSet& module,
+                                                                 EdgeVector& treeEdges) const
+{
+  typedef lemon::FilterNodes<const Graph, const BoolNodeMap> SubGraph;
+
+  assert(_pEdgeCost);
+
+  const Graph& g = getGraph();
+  BoolNodeMap filter(g, false);
+  for (NodeSetIt nodeIt = module.begin(); nodeIt != module.end(); ++nodeIt)
+  {
+    filter[*nodeIt] = true;
+  }
+
+  treeEdges.clear();
+  std::back_insert_iterator<EdgeVector> out(treeEdges);
+  return lemon::kruskal(SubGraph(g, filter), *_pEdgeCost, out);
+}
   
 } // namespace mwcs
 } // namespace nina
@@ -152,6 +152,11 @@ public:
   }
 
 protected:
+  virtual bool readSnapshot(BinaryReader& in)
+  {
+    return Parent::readGraphSnapshot(in);
+  }
+
   virtual void initParserMembers(Graph*& pG,
                                  LabelNodeMap*& pLabel,
                                  WeightNodeMap*& pPVal,
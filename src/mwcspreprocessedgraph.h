@@ -13,7 +13,11 @@
 #include <set>
 #include <vector>
 #include <algorithm>
+#include <thread>
+#include <atomic>
+#include <limits>
 #include <lemon/core.h>
+#include <lemon/time_measure.h>
 
 #include "preprocessing/negdeg01.h"
 #include "preprocessing/posedge.h"
@@ -52,9 +56,15 @@ public:
   typedef typename RuleType::NodeSet NodeSet;
   typedef typename RuleType::NodeSetIt NodeSetIt;
   typedef typename RuleType::NodeSetMap NodeSetMap;
+  typedef typename RuleType::NeighborSet NeighborSet;
+  typedef typename RuleType::NeighborMap NeighborMap;
+  typedef typename RuleType::DirtyNodeLogType DirtyNodeLogType;
   
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
   
+  typedef std::vector<Node> NodeVector;
+  typedef typename NodeVector::const_iterator NodeVectorIt;
+  
   typedef std::set<Edge> EdgeSet;
   typedef typename EdgeSet::const_iterator EdgeSetIt;
 
@@ -85,6 +95,42 @@ public:
   virtual ~MwcsPreprocessedGraph();
   virtual bool init(ParserType* pParser, bool pval);
   void preprocess(const NodeSet& rootNodes);
+  
+  /// Sets the number of threads used by preprocess(). If larger than 1,
+  /// the connected components are preprocessed concurrently.
+  void setThreads(int threads)
+  {
+    assert(threads >= 1);
+    _nThreads = threads;
+  }
+  
+  int getThreads() const
+  {
+    return _nThreads;
+  }
+  
+  /// Whether preprocess() has been applied since the last clear(),
+  /// either in this run or in the run that wrote the loaded snapshot
+  bool isPreprocessed() const
+  {
+    return _preprocessed;
+  }
+  
+  /// Lower bound on the score of an unrooted optimal module determined by
+  /// the last preprocess(): the largest score of a node encountered while
+  /// applying the rules, or 0 (the empty module). Unknown, i.e. -max,
+  /// if the preprocessed graph was loaded from a snapshot.
+  double getLowerBound() const
+  {
+    return _lowerBound;
+  }
+  
+  /// Original nodes corresponding to the root nodes passed to preprocess()
+  const NodeSet& getPreprocessedRootNodes() const
+  {
+    return _preprocessedRootNodes;
+  }
+  
   void updateComponentMap()
   {
     _pGraph->_nComponents = lemon::connectedComponents(*_pGraph->_pG, *_pGraph->_pComp);
@@ -142,11 +188,73 @@ private:
       delete _pG;
     }
   } GraphStruct;
+  
+  /// One or more connected components of the graph, preprocessed
+  /// independently of the rest of the graph
+  typedef struct Piece
+  {
+    /// Nodes of the preprocessed graph in this piece
+    NodeVector _nodes;
+    /// One node per node in _nodes, these play the role of original nodes
+    Graph _orgG;
+    NodeMap* _pToPre;
+    GraphStruct* _pGraph;
+    /// One plus the index in _nodes of the nodes present from the start, 0 otherwise
+    /// (maps reset the values of erased nodes)
+    IntNodeMap* _pInitial;
+    NodeSet _rootNodes;
+    RuleMatrix _rules;
+    double _LB;
+    
+    Piece(const RuleMatrix& rules, double LB)
+      : _nodes()
+      , _orgG()
+      , _pToPre(NULL)
+      , _pGraph(NULL)
+      , _pInitial(NULL)
+      , _rootNodes()
+      , _rules(rules.size())
+      , _LB(LB)
+    {
+      for (size_t phase = 0; phase < rules.size(); ++phase)
+      {
+        for (RuleVectorIt ruleIt = rules[phase].begin(); ruleIt != rules[phase].end(); ruleIt++)
+        {
+          _rules[phase].push_back((*ruleIt)->clone());
+        }
+      }
+    }
+    
+    ~Piece()
+    {
+      for (size_t phase = 0; phase < _rules.size(); ++phase)
+      {
+        for (RuleVectorNonConstIt ruleIt = _rules[phase].begin(); ruleIt != _rules[phase].end(); ruleIt++)
+        {
+          delete *ruleIt;
+        }
+      }
+      
+      // maps must go before the graphs they are registered with
+      delete _pInitial;
+      delete _pGraph;
+      delete _pToPre;
+    }
+  } Piece;
+  
+  typedef std::vector<Piece*> PieceVector;
+  typedef typename PieceVector::const_iterator PieceVectorIt;
 
 private:
   GraphStruct* _pGraph;
   GraphStruct* _pBackupGraph;
   RuleMatrix _rules;
+  int _nThreads;
+  bool _preprocessed;
+  NodeSet _preprocessedRootNodes;
+  double _lowerBound;
+  
+  static const uint32_t s_preprocessedSection = 0x45525048; // "HPRE"
 
 protected:
   virtual void initParserMembers(Graph*& pG,
@@ -157,6 +265,9 @@ protected:
     Parent::initParserMembers(pG, pLabel, pScore, pPVal);
     _pGraph = new GraphStruct(*pG);
   }
+  
+  virtual void writeSnapshot(BinaryWriter& out) const;
+  virtual bool readSnapshot(BinaryReader& in);
 
 public:
   virtual const Graph& getGraph() const
@@ -305,6 +416,9 @@ public:
     }
     
     _pGraph->_pG->clear();
+    _preprocessed = false;
+    _preprocessedRootNodes.clear();
+    _lowerBound = -std::numeric_limits<double>::max();
     _pGraph->_nNodes = getOrgNodeCount();
     _pGraph->_nEdges = getOrgEdgeCount();
     _pGraph->_nArcs = getOrgArcCount();
@@ -526,9 +640,29 @@ public:
   }
 
 protected:
-  void constructDegreeMap(DegreeNodeMap& degree,
-                          DegreeNodeSetVector& degreeVector) const;
-  void constructNeighborMap(NodeSetMap& neighbors) const;
+  static void constructDegreeMap(const Graph& g,
+                                 DegreeNodeMap& degree,
+                                 DegreeNodeSetVector& degreeVector);
+  static void constructNeighborMap(const Graph& g,
+                                   NeighborMap& neighbors);
+  
+  /// Applies rules until none of them changes graph
+  static void applyRules(GraphStruct& graph,
+                         const RuleMatrix& rules,
+                         const NodeSet& rootNodes,
+                         double& LB,
+                         bool verbose);
+  
+private:
+  void preprocessComponents(const NodeSet& rootNodes, double& LB);
+  void initPiece(Piece& piece,
+                 const NodeSet& rootNodes,
+                 const IntNodeMap& index) const;
+  void preprocessPieces(const PieceVector* pPieces,
+                        std::atomic<size_t>* pNext,
+                        const NodeSet* pRootNodes,
+                        const IntNodeMap* pIndex) const;
+  void mergePiece(const Piece& piece);
 };
 
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
@@ -537,6 +671,10 @@ inline MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::MwcsPreprocessedGraph()
   , _pGraph(NULL)
   , _pBackupGraph(NULL)
   , _rules()
+  , _nThreads(1)
+  , _preprocessed(false)
+  , _preprocessedRootNodes()
+  , _lowerBound(-std::numeric_limits<double>::max())
 {
   addPreprocessRule(1, new NegDeg01Type());
   addPreprocessRule(1, new PosEdgeType());
@@ -547,7 +685,7 @@ inline MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::MwcsPreprocessedGraph()
   
   addPreprocessRule(2, new PosDiamondType());
   addPreprocessRule(2, new NegMirroredHubsType());
-  //addPreprocessRule(2, new NegDominatedHubsType());
+  addPreprocessRule(2, new NegDominatedHubsType());
   
   addPreprocessRule(3, new ShortestPathType());
   
@@ -571,16 +709,95 @@ inline MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::~MwcsPreprocessedGraph()
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
 inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::preprocess(const NodeSet& rootNodes)
 {
-  DegreeNodeMap degree(*_pGraph->_pG);
-  DegreeNodeSetVector degreeVector;
-  NodeSetMap neighbors(*_pGraph->_pG);
+  for (size_t phase = 0; phase < _rules.size(); ++phase)
+  {
+    for (RuleVectorIt ruleIt = _rules[phase].begin(); ruleIt != _rules[phase].end(); ruleIt++)
+    {
+      (*ruleIt)->resetStatistics();
+    }
+  }
+  
+  _preprocessed = true;
+  _preprocessedRootNodes = getOrgNodes(rootNodes);
   
-  constructDegreeMap(degree, degreeVector);
-  constructNeighborMap(neighbors);
-
   // determine max score
   double LB = std::max((*_pGraph->_pScore)[lemon::mapMax(*_pGraph->_pG, *_pGraph->_pScore)], 0.);
   
+  if (_nThreads > 1)
+  {
+    updateComponentMap();
+  }
+  
+  if (_nThreads > 1 && _pGraph->_nComponents > 1)
+  {
+    preprocessComponents(rootNodes, LB);
+  }
+  else
+  {
+    applyRules(*_pGraph, _rules, rootNodes, LB, g_verbosity >= VERBOSE_DEBUG);
+  }
+  _lowerBound = LB;
+  
+  if (g_verbosity >= VERBOSE_NON_ESSENTIAL)
+  {
+    for (size_t phase = 0; phase < _rules.size(); ++phase)
+    {
+      for (RuleVectorIt ruleIt = _rules[phase].begin(); ruleIt != _rules[phase].end(); ruleIt++)
+      {
+        std::cout << "// Phase " << phase + 1
+                  << ": rule '" << (*ruleIt)->name()
+                  << "' applied " << (*ruleIt)->getApplied()
+                  << " time(s), removed " << (*ruleIt)->getRemovedNodes()
+                  << " node(s) in " << (*ruleIt)->getTime() << " s" << std::endl;
+      }
+    }
+  }
+
+  // determine the connected components
+  updateComponentMap();
+
+  if (g_verbosity >= VERBOSE_ESSENTIAL)
+  {
+    std::cout << "// Preprocessing successfully applied"
+              << ": " << _pGraph->_nNodes << " nodes, "
+              << _pGraph->_nEdges << " edges and "
+              << _pGraph->_nComponents << " component(s) remaining" << std::endl;
+  }
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::applyRules(GraphStruct& graph,
+                                                                      const RuleMatrix& rules,
+                                                                      const NodeSet& rootNodes,
+                                                                      double& LB,
+                                                                      bool verbose)
+{
+  Graph& g = *graph._pG;
+  DegreeNodeMap degree(g);
+  DegreeNodeSetVector degreeVector;
+  NeighborMap neighbors(g);
+  
+  constructDegreeMap(g, degree, degreeVector);
+  constructNeighborMap(g, neighbors);
+  
+  // initially every node is dirty, afterwards rules only revisit
+  // the nodes that were touched since their previous application
+  DirtyNodeLogType dirty;
+  for (NodeIt v(g); v != lemon::INVALID; ++v)
+  {
+    dirty.mark(v);
+  }
+  
+  for (size_t phase = 0; phase < rules.size(); ++phase)
+  {
+    for (RuleVectorIt ruleIt = rules[phase].begin(); ruleIt != rules[phase].end(); ruleIt++)
+    {
+      (*ruleIt)->setDirtyNodeLog(&dirty);
+    }
+  }
+  
+  lemon::Timer t;
+  
   // now let's preprocess the graph
   // in phases: first do phase 0 until no more change
   // then move on to phase 1 upon change fallback to phase 0
@@ -589,27 +806,33 @@ inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::preprocess(const Node
   do
   {
     uberTotRemovedNodes = 0;
-    for (size_t phase = 0; phase < _rules.size(); ++phase)
+    for (size_t phase = 0; phase < rules.size(); ++phase)
     {
       int totRemovedNodes;
       do
       {
         totRemovedNodes = 0;
-        for (RuleVectorIt ruleIt = _rules[phase].begin(); ruleIt != _rules[phase].end(); ruleIt++)
+        for (RuleVectorIt ruleIt = rules[phase].begin(); ruleIt != rules[phase].end(); ruleIt++)
         {
-          int removedNodes = (*ruleIt)->apply(*_pGraph->_pG, rootNodes,
-                                              *_pGraph->_pLabel,
-                                              *_pGraph->_pScore, *_pGraph->_pMapToPre,
-                                              *_pGraph->_pPreOrigNodes, neighbors,
-                                              _pGraph->_nNodes, _pGraph->_nArcs, _pGraph->_nEdges,
+          // nothing changed since the rule was last applied
+          if (!(*ruleIt)->isDirty())
+            continue;
+          
+          t.restart();
+          int removedNodes = (*ruleIt)->apply(g, rootNodes,
+                                              *graph._pLabel,
+                                              *graph._pScore, *graph._pMapToPre,
+                                              *graph._pPreOrigNodes, neighbors,
+                                              graph._nNodes, graph._nArcs, graph._nEdges,
                                               degree, degreeVector, LB);
+          (*ruleIt)->addStatistics(removedNodes, t.realTime());
           
-          assert(lemon::countNodes(*_pGraph->_pG) == _pGraph->_nNodes);
-          assert(lemon::countEdges(*_pGraph->_pG) == _pGraph->_nEdges);
+          assert(lemon::countNodes(g) == graph._nNodes);
+          assert(lemon::countEdges(g) == graph._nEdges);
           
           totRemovedNodes += removedNodes;
 
-          if (g_verbosity >= VERBOSE_DEBUG && removedNodes > 0)
+          if (verbose && removedNodes > 0)
           {
             std::cout << "// Phase " << phase + 1
                       << ": applied rule '" << (*ruleIt)->name()
@@ -626,16 +849,261 @@ inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::preprocess(const Node
       } while (totRemovedNodes > 0);
     }
   } while (uberTotRemovedNodes > 0);
+  
+  for (size_t phase = 0; phase < rules.size(); ++phase)
+  {
+    for (RuleVectorIt ruleIt = rules[phase].begin(); ruleIt != rules[phase].end(); ruleIt++)
+    {
+      (*ruleIt)->setDirtyNodeLog(NULL);
+    }
+  }
+}
 
-  // determine the connected components
-  updateComponentMap();
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::preprocessComponents(const NodeSet& rootNodes,
+                                                                                double& LB)
+{
+  const Graph& g = *_pGraph->_pG;
+  const IntNodeMap& comp = *_pGraph->_pComp;
+  const int nComponents = _pGraph->_nComponents;
+  
+  // distribute the components over the pieces, largest component first,
+  // such that pieces are of about equal size
+  std::vector<int> compSize(nComponents, 0);
+  for (NodeIt v(g); v != lemon::INVALID; ++v)
+  {
+    ++compSize[comp[v]];
+  }
+  
+  std::vector<std::pair<int, int> > order;
+  for (int c = 0; c < nComponents; ++c)
+  {
+    order.push_back(std::make_pair(-compSize[c], c));
+  }
+  std::sort(order.begin(), order.end());
+  
+  const size_t nPieces = std::min(static_cast<size_t>(nComponents),
+                                  static_cast<size_t>(4 * _nThreads));
+  PieceVector pieces;
+  std::vector<int> pieceSize(nPieces, 0);
+  for (size_t i = 0; i < nPieces; ++i)
+  {
+    pieces.push_back(new Piece(_rules, LB));
+  }
+  
+  std::vector<int> compToPiece(nComponents);
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    size_t minPiece = std::min_element(pieceSize.begin(), pieceSize.end()) - pieceSize.begin();
+    compToPiece[order[i].second] = static_cast<int>(minPiece);
+    pieceSize[minPiece] -= order[i].first;
+  }
+  
+  IntNodeMap index(g);
+  for (NodeIt v(g); v != lemon::INVALID; ++v)
+  {
+    NodeVector& nodes = pieces[compToPiece[comp[v]]]->_nodes;
+    index[v] = static_cast<int>(nodes.size());
+    nodes.push_back(v);
+  }
+  
+  // pieces only read the graph and maps of this instance
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < std::min(_nThreads, static_cast<int>(nPieces)); ++i)
+  {
+    threads.push_back(std::thread(&MwcsPreprocessedGraph::preprocessPieces, this,
+                                  &pieces, &next, &rootNodes, &index));
+  }
+  for (size_t i = 0; i < threads.size(); ++i)
+  {
+    threads[i].join();
+  }
+  
+  for (PieceVectorIt pieceIt = pieces.begin(); pieceIt != pieces.end(); ++pieceIt)
+  {
+    mergePiece(**pieceIt);
+    LB = std::max(LB, (*pieceIt)->_LB);
+    
+    const RuleMatrix& pieceRules = (*pieceIt)->_rules;
+    for (size_t phase = 0; phase < _rules.size(); ++phase)
+    {
+      for (size_t i = 0; i < _rules[phase].size(); ++i)
+      {
+        _rules[phase][i]->addStatistics(*pieceRules[phase][i]);
+      }
+    }
+    delete *pieceIt;
+  }
+  
+  _pGraph->_nNodes = lemon::countNodes(*_pGraph->_pG);
+  _pGraph->_nEdges = lemon::countEdges(*_pGraph->_pG);
+  _pGraph->_nArcs = 2 * _pGraph->_nEdges;
+}
 
-  if (g_verbosity >= VERBOSE_ESSENTIAL)
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::preprocessPieces(const PieceVector* pPieces,
+                                                                            std::atomic<size_t>* pNext,
+                                                                            const NodeSet* pRootNodes,
+                                                                            const IntNodeMap* pIndex) const
+{
+  size_t i;
+  while ((i = (*pNext)++) < pPieces->size())
   {
-    std::cout << "// Preprocessing successfully applied"
-              << ": " << _pGraph->_nNodes << " nodes, "
-              << _pGraph->_nEdges << " edges and "
-              << _pGraph->_nComponents << " component(s) remaining" << std::endl;
+    Piece& piece = *(*pPieces)[i];
+    initPiece(piece, *pRootNodes, *pIndex);
+    applyRules(*piece._pGraph, piece._rules, piece._rootNodes, piece._LB, false);
+  }
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::initPiece(Piece& piece,
+                                                                     const NodeSet& rootNodes,
+                                                                     const IntNodeMap& index) const
+{
+  const Graph& g = *_pGraph->_pG;
+  const LabelNodeMap& label = *_pGraph->_pLabel;
+  const WeightNodeMap& score = *_pGraph->_pScore;
+  
+  // all graphs and maps of the piece are created by the calling thread
+  for (NodeVectorIt nodeIt = piece._nodes.begin(); nodeIt != piece._nodes.end(); ++nodeIt)
+  {
+    piece._orgG.addNode();
+  }
+  piece._pToPre = new NodeMap(piece._orgG);
+  piece._pGraph = new GraphStruct(piece._orgG);
+  
+  GraphStruct& graph = *piece._pGraph;
+  Graph& pieceG = *graph._pG;
+  piece._pInitial = new IntNodeMap(pieceG);
+  
+  NodeVector pieceNodes;
+  pieceNodes.reserve(piece._nodes.size());
+  NodeIt orgNode(piece._orgG);
+  for (NodeVectorIt nodeIt = piece._nodes.begin(); nodeIt != piece._nodes.end(); ++nodeIt, ++orgNode)
+  {
+    Node v = *nodeIt;
+    Node pieceNode = pieceG.addNode();
+    pieceNodes.push_back(pieceNode);
+    
+    (*piece._pInitial)[pieceNode] = static_cast<int>(pieceNodes.size());
+    (*piece._pToPre)[orgNode] = v;
+    (*graph._pLabel)[pieceNode] = label[v];
+    (*graph._pScore)[pieceNode] = score[v];
+    (*graph._pPreOrigNodes)[pieceNode].insert(orgNode);
+    (*graph._pMapToPre)[orgNode].insert(pieceNode);
+    
+    if (rootNodes.find(v) != rootNodes.end())
+    {
+      piece._rootNodes.insert(pieceNode);
+    }
+  }
+  
+  for (size_t i = 0; i < piece._nodes.size(); ++i)
+  {
+    Node v = piece._nodes[i];
+    for (IncEdgeIt e(g, v); e != lemon::INVALID; ++e)
+    {
+      Node u = g.oppositeNode(v, e);
+      if (g.id(v) < g.id(u))
+      {
+        pieceG.addEdge(pieceNodes[i], pieceNodes[index[u]]);
+        ++graph._nEdges;
+      }
+    }
+  }
+  
+  graph._nNodes = static_cast<int>(piece._nodes.size());
+  graph._nArcs = 2 * graph._nEdges;
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::mergePiece(const Piece& piece)
+{
+  Graph& g = *_pGraph->_pG;
+  NodeSetMap& preOrigNodes = *_pGraph->_pPreOrigNodes;
+  NodeSetMap& mapToPre = *_pGraph->_pMapToPre;
+  const GraphStruct& graph = *piece._pGraph;
+  const Graph& pieceG = *graph._pG;
+  const IntNodeMap& initial = *piece._pInitial;
+  
+  // the original nodes of the piece are nodes of this graph,
+  // determine the corresponding nodes of the original graph first
+  NodeVector pieceNodes;
+  std::vector<NodeSet> orgNodes;
+  for (NodeIt pieceNode(pieceG); pieceNode != lemon::INVALID; ++pieceNode)
+  {
+    pieceNodes.push_back(pieceNode);
+    orgNodes.push_back(NodeSet());
+    
+    const NodeSet& pieceOrgNodes = (*graph._pPreOrigNodes)[pieceNode];
+    for (NodeSetIt nodeIt = pieceOrgNodes.begin(); nodeIt != pieceOrgNodes.end(); ++nodeIt)
+    {
+      const NodeSet& nodes = preOrigNodes[(*piece._pToPre)[*nodeIt]];
+      orgNodes.back().insert(nodes.begin(), nodes.end());
+    }
+  }
+  
+  EdgeSet edges;
+  for (NodeVectorIt nodeIt = piece._nodes.begin(); nodeIt != piece._nodes.end(); ++nodeIt)
+  {
+    Node v = *nodeIt;
+    const NodeSet& nodes = preOrigNodes[v];
+    for (NodeSetIt orgNodeIt = nodes.begin(); orgNodeIt != nodes.end(); ++orgNodeIt)
+    {
+      mapToPre[*orgNodeIt].erase(v);
+    }
+    for (IncEdgeIt e(g, v); e != lemon::INVALID; ++e)
+    {
+      edges.insert(e);
+    }
+  }
+  for (EdgeSetIt edgeIt = edges.begin(); edgeIt != edges.end(); ++edgeIt)
+  {
+    g.erase(*edgeIt);
+  }
+  
+  // nodes that were present from the start keep their identity,
+  // such that root nodes remain valid
+  NodeMap toNew(pieceG);
+  std::vector<bool> kept(piece._nodes.size(), false);
+  for (size_t i = 0; i < pieceNodes.size(); ++i)
+  {
+    Node pieceNode = pieceNodes[i];
+    Node newNode;
+    if (initial[pieceNode] > 0)
+    {
+      newNode = piece._nodes[initial[pieceNode] - 1];
+      kept[initial[pieceNode] - 1] = true;
+    }
+    else
+    {
+      newNode = g.addNode();
+    }
+    
+    toNew[pieceNode] = newNode;
+    (*_pGraph->_pLabel)[newNode] = (*graph._pLabel)[pieceNode];
+    (*_pGraph->_pScore)[newNode] = (*graph._pScore)[pieceNode];
+    preOrigNodes[newNode].swap(orgNodes[i]);
+    
+    const NodeSet& nodes = preOrigNodes[newNode];
+    for (NodeSetIt orgNodeIt = nodes.begin(); orgNodeIt != nodes.end(); ++orgNodeIt)
+    {
+      mapToPre[*orgNodeIt].insert(newNode);
+    }
+  }
+  
+  for (size_t i = 0; i < piece._nodes.size(); ++i)
+  {
+    if (!kept[i])
+    {
+      g.erase(piece._nodes[i]);
+    }
+  }
+  
+  for (EdgeIt e(pieceG); e != lemon::INVALID; ++e)
+  {
+    g.addEdge(toNew[pieceG.u(e)], toNew[pieceG.v(e)]);
   }
 }
 
@@ -645,6 +1113,12 @@ inline bool MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::init(ParserType* pPar
   if (!Parent::init(pParser, pval))
     return false;
 
+  if (Parent::hasEdgeCosts())
+  {
+    std::cerr << "Error: preprocessing does not support edge costs" << std::endl;
+    return false;
+  }
+
   // start by making a copy of the graph
   clear();
 
@@ -667,12 +1141,199 @@ inline bool MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::init(Graph* pG,
 }
 
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
-inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::constructNeighborMap(NodeSetMap& neighbors) const
+inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::writeSnapshot(BinaryWriter& out) const
 {
+  Parent::writeSnapshot(out);
+  
+  if (!_preprocessed)
+  {
+    return;
+  }
+  
+  // original nodes are numbered in iteration order, as by Parent
+  const Graph& orgG = getOrgGraph();
+  IntNodeMap orgIndex(orgG);
+  int32_t i = 0;
+  for (NodeIt v(orgG); v != lemon::INVALID; ++v, ++i)
+  {
+    orgIndex[v] = i;
+  }
+  
   const Graph& g = *_pGraph->_pG;
+  IntNodeMap index(g);
+  std::vector<std::string> labels;
+  std::vector<double> score;
+  std::vector<int32_t> comp;
+  std::vector<int32_t> orgOffsets(1, 0);
+  std::vector<int32_t> orgNodes;
+  int32_t nNodes = 0;
+  for (NodeIt v(g); v != lemon::INVALID; ++v, ++nNodes)
+  {
+    index[v] = nNodes;
+    labels.push_back((*_pGraph->_pLabel)[v]);
+    score.push_back((*_pGraph->_pScore)[v]);
+    comp.push_back((*_pGraph->_pComp)[v]);
+    
+    const NodeSet& orgNodeSet = (*_pGraph->_pPreOrigNodes)[v];
+    for (NodeSetIt nodeIt = orgNodeSet.begin(); nodeIt != orgNodeSet.end(); ++nodeIt)
+    {
+      orgNodes.push_back(orgIndex[*nodeIt]);
+    }
+    orgOffsets.push_back(static_cast<int32_t>(orgNodes.size()));
+  }
+  
+  std::vector<int32_t> edges;
+  for (EdgeIt e(g); e != lemon::INVALID; ++e)
+  {
+    edges.push_back(index[g.u(e)]);
+    edges.push_back(index[g.v(e)]);
+  }
+  
+  std::vector<int32_t> rootNodes;
+  for (NodeSetIt nodeIt = _preprocessedRootNodes.begin(); nodeIt != _preprocessedRootNodes.end(); ++nodeIt)
+  {
+    rootNodes.push_back(orgIndex[*nodeIt]);
+  }
+  
+  out.writeUInt(s_preprocessedSection);
+  out.writeInt(nNodes);
+  out.writeInt(static_cast<int32_t>(edges.size() / 2));
+  out.writeInt(_pGraph->_nComponents);
+  out.writeInt(static_cast<int32_t>(rootNodes.size()));
+  out.writeStrings(labels);
+  out.writeArray(score);
+  out.writeArray(comp);
+  out.writeArray(orgOffsets);
+  out.writeArray(orgNodes);
+  out.writeArray(edges);
+  out.writeArray(rootNodes);
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline bool MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::readSnapshot(BinaryReader& in)
+{
+  if (!Parent::readSnapshot(in))
+    return false;
+  
+  // start by making a copy of the graph
+  clear();
+  
+  if (in.atEnd())
+  {
+    // the snapshot was taken prior to preprocessing
+    return true;
+  }
+  
+  uint32_t section = 0;
+  int32_t nNodes = -1, nEdges = -1, nComponents = -1, nRootNodes = -1;
+  if (!in.readUInt(section) || section != s_preprocessedSection
+      || !in.readInt(nNodes) || !in.readInt(nEdges)
+      || !in.readInt(nComponents) || !in.readInt(nRootNodes)
+      || nNodes < 0 || nEdges < 0 || nComponents < 0 || nRootNodes < 0)
+  {
+    return false;
+  }
+  
+  const uint64_t* pLabelOffsets = NULL;
+  const char* pLabelChars = NULL;
+  in.readStrings(nNodes, pLabelOffsets, pLabelChars);
+  const double* pScore = in.readArray<double>(nNodes);
+  const int32_t* pComp = in.readArray<int32_t>(nNodes);
+  const int32_t* pOrgOffsets = in.readArray<int32_t>(nNodes + 1);
+  const int32_t* pOrgNodes = pOrgOffsets ? in.readArray<int32_t>(pOrgOffsets[nNodes]) : NULL;
+  const int32_t* pEdges = in.readArray<int32_t>(2 * static_cast<size_t>(nEdges));
+  const int32_t* pRootNodes = in.readArray<int32_t>(nRootNodes);
+  if (!in.good() || pOrgOffsets[0] != 0)
+  {
+    return false;
+  }
+  
+  const int32_t nOrgNodes = getOrgNodeCount();
+  for (int32_t i = 0; i < nNodes; ++i)
+  {
+    if (pLabelOffsets[i] > pLabelOffsets[i + 1] || pOrgOffsets[i] > pOrgOffsets[i + 1])
+      return false;
+  }
+  for (int32_t i = 0; i < pOrgOffsets[nNodes]; ++i)
+  {
+    if (!(0 <= pOrgNodes[i] && pOrgNodes[i] < nOrgNodes))
+      return false;
+  }
+  for (int32_t i = 0; i < 2 * nEdges; ++i)
+  {
+    if (!(0 <= pEdges[i] && pEdges[i] < nNodes))
+      return false;
+  }
+  for (int32_t i = 0; i < nRootNodes; ++i)
+  {
+    if (!(0 <= pRootNodes[i] && pRootNodes[i] < nOrgNodes))
+      return false;
+  }
+  
+  // Parent::readSnapshot() restored the iteration order of the original nodes
+  const Graph& orgG = getOrgGraph();
+  NodeVector orgNodes;
+  orgNodes.reserve(nOrgNodes);
+  for (NodeIt v(orgG); v != lemon::INVALID; ++v)
+  {
+    orgNodes.push_back(v);
+    (*_pGraph->_pMapToPre)[v].clear();
+  }
+  
+  Graph& g = *_pGraph->_pG;
+  g.clear();
+  g.reserveNode(nNodes);
+  g.reserveEdge(nEdges);
+  
+  NodeVector nodes(nNodes);
+  for (int32_t i = nNodes - 1; i >= 0; --i)
+  {
+    nodes[i] = g.addNode();
+  }
+  
+  for (int32_t i = 0; i < nNodes; ++i)
+  {
+    Node v = nodes[i];
+    (*_pGraph->_pLabel)[v].assign(pLabelChars + pLabelOffsets[i], pLabelChars + pLabelOffsets[i + 1]);
+    (*_pGraph->_pScore)[v] = pScore[i];
+    (*_pGraph->_pComp)[v] = pComp[i];
+    
+    NodeSet& orgNodeSet = (*_pGraph->_pPreOrigNodes)[v];
+    orgNodeSet.clear();
+    for (int32_t j = pOrgOffsets[i]; j < pOrgOffsets[i + 1]; ++j)
+    {
+      Node orgNode = orgNodes[pOrgNodes[j]];
+      orgNodeSet.insert(orgNode);
+      (*_pGraph->_pMapToPre)[orgNode].insert(v);
+    }
+  }
+  
+  for (int32_t i = nEdges - 1; i >= 0; --i)
+  {
+    g.addEdge(nodes[pEdges[2 * i]], nodes[pEdges[2 * i + 1]]);
+  }
+  
+  _pGraph->_nNodes = nNodes;
+  _pGraph->_nEdges = nEdges;
+  _pGraph->_nArcs = 2 * nEdges;
+  _pGraph->_nComponents = nComponents;
+  
+  _preprocessed = true;
+  for (int32_t i = 0; i < nRootNodes; ++i)
+  {
+    _preprocessedRootNodes.insert(orgNodes[pRootNodes[i]]);
+  }
+  
+  return true;
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::constructNeighborMap(const Graph& g,
+                                                                                NeighborMap& neighbors)
+{
   for (NodeIt n(g); n != lemon::INVALID; ++n)
   {
-    NodeSet& neighborSet = neighbors[n];
+    NeighborSet& neighborSet = neighbors[n];
     neighborSet.clear();
     for (IncEdgeIt e(g, n); e != lemon::INVALID; ++e)
     {
@@ -683,13 +1344,14 @@ inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::constructNeighborMap(
   
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
 inline void MwcsPreprocessedGraph<GR, NWGHT, NLBL, EWGHT>::constructDegreeMap(
+    const Graph& g,
     DegreeNodeMap& degree,
-    DegreeNodeSetVector& degreeVector) const
+    DegreeNodeSetVector& degreeVector)
 {
-  for (NodeIt n(*_pGraph->_pG); n != lemon::INVALID; ++n)
+  for (NodeIt n(g); n != lemon::INVALID; ++n)
   {
     int d = 0;
-    for (IncEdgeIt e(*_pGraph->_pG, n); e != lemon::INVALID; ++e, d++) ;
+    for (IncEdgeIt e(g, n); e != lemon::INVALID; ++e, d++) ;
 
     degree[n] = d;
     if (degreeVector.size() <= static_cast<size_t>(d))
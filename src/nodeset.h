@@ -0,0 +1,247 @@
+/*
+ * nodeset.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef NODESET_H
+#define NODESET_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+namespace nina {
+
+/// \brief Set of nodes stored as a sorted vector
+///
+/// Drop-in replacement for std::set<Node> for sets that are small, queried
+/// and compared far more often than they are modified, such as the
+/// neighborhoods maintained during preprocessing. Elements are stored
+/// contiguously and iterated in increasing order, like std::set.
+template<typename T>
+class FlatNodeSet
+{
+public:
+  typedef T key_type;
+  typedef T value_type;
+  typedef std::vector<T> ValueVector;
+  typedef typename ValueVector::const_iterator const_iterator;
+  typedef const_iterator iterator;
+  typedef typename ValueVector::size_type size_type;
+
+  FlatNodeSet()
+    : _values()
+  {
+  }
+
+  template<typename InputIt>
+  FlatNodeSet(InputIt first, InputIt last)
+    : _values()
+  {
+    insert(first, last);
+  }
+
+  const_iterator begin() const { return _values.begin(); }
+  const_iterator end() const { return _values.end(); }
+  size_type size() const { return _values.size(); }
+  bool empty() const { return _values.empty(); }
+  void clear() { _values.clear(); }
+  void reserve(size_type n) { _values.reserve(n); }
+
+  const_iterator find(const T& value) const
+  {
+    const_iterator it = std::lower_bound(_values.begin(), _values.end(), value);
+    if (it != _values.end() && !(value < *it))
+      return it;
+    else
+      return _values.end();
+  }
+
+  size_type count(const T& value) const
+  {
+    return find(value) != _values.end() ? 1 : 0;
+  }
+
+  std::pair<const_iterator, bool> insert(const T& value)
+  {
+    typename ValueVector::iterator it = std::lower_bound(_values.begin(), _values.end(), value);
+    if (it != _values.end() && !(value < *it))
+    {
+      return std::make_pair(const_iterator(it), false);
+    }
+    it = _values.insert(it, value);
+    return std::make_pair(const_iterator(it), true);
+  }
+
+  /// Inserts a range; linear in size() if the range is sorted
+  template<typename InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    const size_type n = _values.size();
+    _values.insert(_values.end(), first, last);
+
+    typename ValueVector::iterator mid = _values.begin() + n;
+    std::sort(mid, _values.end());
+    std::inplace_merge(_values.begin(), mid, _values.end());
+    _values.erase(std::unique(_values.begin(), _values.end()), _values.end());
+  }
+
+  size_type erase(const T& value)
+  {
+    typename ValueVector::iterator it = std::lower_bound(_values.begin(), _values.end(), value);
+    if (it != _values.end() && !(value < *it))
+    {
+      _values.erase(it);
+      return 1;
+    }
+    return 0;
+  }
+
+  void erase(const_iterator pos)
+  {
+    _values.erase(_values.begin() + (pos - _values.begin()));
+  }
+
+  void swap(FlatNodeSet& other)
+  {
+    _values.swap(other._values);
+  }
+
+  bool operator==(const FlatNodeSet& other) const
+  {
+    return _values == other._values;
+  }
+
+  bool operator!=(const FlatNodeSet& other) const
+  {
+    return _values != other._values;
+  }
+
+  bool operator<(const FlatNodeSet& other) const
+  {
+    return _values < other._values;
+  }
+
+private:
+  ValueVector _values;
+};
+
+/// \brief Set of nodes of a graph with constant time insert, erase and lookup
+///
+/// Sparse set indexed by node id: a position array spanning all node ids of
+/// the graph tells whether (and where) a node is stored in the member vector.
+/// Clearing takes time proportional to the number of members, so a single
+/// instance can be reused across separation rounds without touching the
+/// whole graph. Unlike a NodeMap it is not registered with the graph, so
+/// it can be allocated without synchronization. Members are iterated in
+/// insertion order.
+template<typename GR>
+class DenseNodeSet
+{
+public:
+  typedef GR Graph;
+  typedef typename Graph::Node Node;
+  typedef Node key_type;
+  typedef Node value_type;
+  typedef std::vector<Node> NodeVector;
+  typedef typename NodeVector::const_iterator const_iterator;
+  typedef const_iterator iterator;
+  typedef typename NodeVector::size_type size_type;
+
+  DenseNodeSet(const Graph& g)
+    : _g(g)
+    , _pos(g.maxNodeId() + 1, -1)
+    , _nodes()
+  {
+  }
+
+  DenseNodeSet(const DenseNodeSet& other)
+    : _g(other._g)
+    , _pos(other._pos)
+    , _nodes(other._nodes)
+  {
+  }
+
+  const_iterator begin() const { return _nodes.begin(); }
+  const_iterator end() const { return _nodes.end(); }
+  size_type size() const { return _nodes.size(); }
+  bool empty() const { return _nodes.empty(); }
+  const NodeVector& nodes() const { return _nodes; }
+
+  bool contains(Node v) const
+  {
+    const size_t id = static_cast<size_t>(_g.id(v));
+    return id < _pos.size() && _pos[id] != -1;
+  }
+
+  size_type count(Node v) const
+  {
+    return contains(v) ? 1 : 0;
+  }
+
+  bool insert(Node v)
+  {
+    const size_t id = static_cast<size_t>(_g.id(v));
+    if (id >= _pos.size())
+    {
+      _pos.resize(id + 1, -1);
+    }
+    if (_pos[id] != -1)
+    {
+      return false;
+    }
+    _pos[id] = static_cast<int>(_nodes.size());
+    _nodes.push_back(v);
+    return true;
+  }
+
+  template<typename InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    for (; first != last; ++first)
+    {
+      insert(*first);
+    }
+  }
+
+  bool erase(Node v)
+  {
+    if (!contains(v))
+    {
+      return false;
+    }
+
+    // move the last member into the vacated position
+    const int pos = _pos[_g.id(v)];
+    const Node last = _nodes.back();
+    _nodes[pos] = last;
+    _pos[_g.id(last)] = pos;
+    _pos[_g.id(v)] = -1;
+    _nodes.pop_back();
+    return true;
+  }
+
+  void clear()
+  {
+    for (const_iterator it = _nodes.begin(); it != _nodes.end(); ++it)
+    {
+      _pos[_g.id(*it)] = -1;
+    }
+    _nodes.clear();
+  }
+
+private:
+  typedef std::vector<int> IntVector;
+
+  const Graph& _g;
+  /// Position of every node id in _nodes, -1 if absent
+  IntVector _pos;
+  NodeVector _nodes;
+
+  void operator=(const DenseNodeSet&) {}
+};
+
+} // namespace nina
+
+#endif // NODESET_H
@@ -0,0 +1,209 @@
+/*
+ * binaryfile.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef BINARYFILE_H
+#define BINARYFILE_H
+
+#include <string.h>
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "mappedfile.h"
+
+namespace nina {
+
+/// \brief Writes a binary snapshot file
+///
+/// A snapshot starts with a magic number and a version, followed by
+/// scalars and arrays in native byte order. Arrays are aligned to
+/// 8 bytes, so that BinaryReader can hand them out in place.
+class BinaryWriter
+{
+public:
+  static const uint32_t s_magic = 0x425a4e48; // "HNZB"
+  static const uint32_t s_version = 1;
+
+  BinaryWriter()
+    : _out()
+    , _pos(0)
+  {
+  }
+
+  bool open(const std::string& filename)
+  {
+    _out.open(filename.c_str(), std::ios::out | std::ios::binary);
+    _pos = 0;
+    if (!_out.good())
+      return false;
+
+    writeUInt(s_magic);
+    writeUInt(s_version);
+    return _out.good();
+  }
+
+  bool good() const
+  {
+    return _out.good();
+  }
+
+  void writeUInt(uint32_t value)
+  {
+    write(&value, sizeof(value));
+  }
+
+  void writeInt(int32_t value)
+  {
+    write(&value, sizeof(value));
+  }
+
+  template<typename T>
+  void writeArray(const std::vector<T>& values)
+  {
+    align();
+    if (!values.empty())
+    {
+      write(&values[0], values.size() * sizeof(T));
+    }
+  }
+
+  /// Writes \c strings as an array of offsets followed by the characters
+  void writeStrings(const std::vector<std::string>& strings)
+  {
+    std::vector<uint64_t> offsets(1, 0);
+    offsets.reserve(strings.size() + 1);
+    for (size_t i = 0; i < strings.size(); ++i)
+    {
+      offsets.push_back(offsets.back() + strings[i].size());
+    }
+    writeArray(offsets);
+
+    align();
+    for (size_t i = 0; i < strings.size(); ++i)
+    {
+      write(strings[i].data(), strings[i].size());
+    }
+  }
+
+private:
+  std::ofstream _out;
+  size_t _pos;
+
+  void write(const void* p, size_t n)
+  {
+    _out.write(static_cast<const char*>(p), n);
+    _pos += n;
+  }
+
+  void align()
+  {
+    static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    write(zeros, (8 - _pos % 8) % 8);
+  }
+};
+
+/// \brief Reads a binary snapshot file written by BinaryWriter
+///
+/// The file is mapped into memory and arrays are returned as pointers into
+/// the mapping, which remain valid until the reader is destroyed. Reads
+/// past the end of the file return NULL and put the reader in a failed
+/// state.
+class BinaryReader
+{
+public:
+  BinaryReader()
+    : _file()
+    , _pos(0)
+    , _good(false)
+  {
+  }
+
+  bool open(const std::string& filename)
+  {
+    _pos = 0;
+    _good = _file.open(filename);
+
+    uint32_t magic = 0, version = 0;
+    _good = _good && readUInt(magic) && readUInt(version)
+        && magic == BinaryWriter::s_magic && version == BinaryWriter::s_version;
+    return _good;
+  }
+
+  bool good() const
+  {
+    return _good;
+  }
+
+  bool atEnd() const
+  {
+    return _pos >= _file.size();
+  }
+
+  bool readUInt(uint32_t& value)
+  {
+    return read(&value, sizeof(value));
+  }
+
+  bool readInt(int32_t& value)
+  {
+    return read(&value, sizeof(value));
+  }
+
+  template<typename T>
+  const T* readArray(size_t n)
+  {
+    align();
+    if (!_good || n > (_file.size() - _pos) / sizeof(T))
+    {
+      _good = false;
+      return NULL;
+    }
+
+    const T* res = reinterpret_cast<const T*>(_file.data() + _pos);
+    _pos += n * sizeof(T);
+    return res;
+  }
+
+  /// Reads \c n strings; string i is [pChars + pOffsets[i], pChars + pOffsets[i+1])
+  bool readStrings(size_t n, const uint64_t*& pOffsets, const char*& pChars)
+  {
+    pOffsets = readArray<uint64_t>(n + 1);
+    pChars = pOffsets ? readArray<char>(pOffsets[n]) : NULL;
+    return pChars != NULL || (pOffsets && pOffsets[n] == 0);
+  }
+
+private:
+  MappedFile _file;
+  size_t _pos;
+  bool _good;
+
+  bool read(void* p, size_t n)
+  {
+    if (!_good || n > _file.size() - _pos)
+    {
+      _good = false;
+      return false;
+    }
+
+    memcpy(p, _file.data() + _pos, n);
+    _pos += n;
+    return true;
+  }
+
+  void align()
+  {
+    _pos += (8 - _pos % 8) % 8;
+    if (_pos > _file.size())
+    {
+      _pos = _file.size();
+      _good = false;
+    }
+  }
+};
+
+} // namespace nina
+
+#endif // BINARYFILE_H
@@ -0,0 +1,338 @@
+/*
+ * filetokenizer.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef FILETOKENIZER_H
+#define FILETOKENIZER_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <string>
+#include "mappedfile.h"
+
+namespace nina {
+
+/// \brief Reads a text file line by line and token by token
+///
+/// The file is mapped into memory (or read at once if that is not
+/// possible), lines and tokens are handed out as ranges into the mapping
+/// and numbers are converted in place, so no per-line strings or streams
+/// are constructed. Lines may end in "\n", "\r\n" or "\r"; tokens are
+/// separated by white space.
+class FileTokenizer
+{
+public:
+  FileTokenizer();
+  ~FileTokenizer();
+
+  /// Opens \c filename, returns false if it cannot be read
+  bool open(const std::string& filename);
+  void close();
+
+  /// Size of the file in bytes
+  size_t size() const
+  {
+    return _file.size();
+  }
+
+  /// Advances to the next line, returns false at the end of the file
+  bool nextLine();
+
+  int getLineNumber() const
+  {
+    return _lineNumber;
+  }
+
+  bool isLineEmpty() const
+  {
+    return _lineBegin == _lineEnd;
+  }
+
+  /// First character of the current line, which must not be empty
+  char getLineFront() const
+  {
+    return *_lineBegin;
+  }
+
+  std::string getLine() const
+  {
+    return std::string(_lineBegin, _lineEnd);
+  }
+
+  bool lineEquals(const char* str) const
+  {
+    const size_t len = strlen(str);
+    return static_cast<size_t>(_lineEnd - _lineBegin) == len
+        && memcmp(_lineBegin, str, len) == 0;
+  }
+
+  bool lineStartsWith(const char* prefix) const
+  {
+    const size_t len = strlen(prefix);
+    return static_cast<size_t>(_lineEnd - _lineBegin) >= len
+        && memcmp(_lineBegin, prefix, len) == 0;
+  }
+
+  /// Retrieves the next token of the current line
+  bool nextToken(const char*& begin, const char*& end);
+  bool nextToken(std::string& token);
+  /// Retrieves the next token and returns whether it equals \c str
+  bool nextTokenIs(const char* str);
+  bool nextInt(int& value);
+  bool nextDouble(double& value);
+
+  /// Returns whether there are no tokens left on the current line
+  bool isLineEnd();
+
+  /// Parses [begin, end) as a real number; the result is correctly rounded
+  static bool parseDouble(const char* begin, const char* end, double& value);
+  static bool parseInt(const char* begin, const char* end, int& value);
+
+private:
+  MappedFile _file;
+  /// Start of the next line
+  const char* _pNext;
+  const char* _lineBegin;
+  const char* _lineEnd;
+  /// Position within the current line
+  const char* _pCursor;
+  int _lineNumber;
+
+  FileTokenizer(const FileTokenizer&);
+  void operator=(const FileTokenizer&);
+};
+
+inline FileTokenizer::FileTokenizer()
+  : _file()
+  , _pNext(NULL)
+  , _lineBegin(NULL)
+  , _lineEnd(NULL)
+  , _pCursor(NULL)
+  , _lineNumber(0)
+{
+}
+
+inline FileTokenizer::~FileTokenizer()
+{
+  close();
+}
+
+inline bool FileTokenizer::open(const std::string& filename)
+{
+  close();
+
+  if (!_file.open(filename))
+    return false;
+
+  _pNext = _file.data();
+  _lineBegin = _lineEnd = _pCursor = _file.data();
+  _lineNumber = 0;
+  return true;
+}
+
+inline void FileTokenizer::close()
+{
+  _file.close();
+  _pNext = _lineBegin = _lineEnd = _pCursor = NULL;
+  _lineNumber = 0;
+}
+
+inline bool FileTokenizer::nextLine()
+{
+  const char* end = _file.data() + _file.size();
+  if (_pNext == NULL || _pNext >= end)
+    return false;
+
+  const char* p = _pNext;
+  while (p != end && *p != '\n' && *p != '\r')
+    ++p;
+
+  _lineBegin = _pCursor = _pNext;
+  _lineEnd = p;
+
+  if (p != end && *p == '\r')
+    ++p;
+  if (p != end && *p == '\n' && (p == _lineEnd || *_lineEnd == '\r'))
+    ++p;
+  _pNext = p;
+
+  ++_lineNumber;
+  return true;
+}
+
+inline bool FileTokenizer::nextToken(const char*& begin, const char*& end)
+{
+  while (_pCursor != _lineEnd && isspace(static_cast<unsigned char>(*_pCursor)))
+    ++_pCursor;
+  if (_pCursor == _lineEnd)
+    return false;
+
+  begin = _pCursor;
+  while (_pCursor != _lineEnd && !isspace(static_cast<unsigned char>(*_pCursor)))
+    ++_pCursor;
+  end = _pCursor;
+  return true;
+}
+
+inline bool FileTokenizer::nextToken(std::string& token)
+{
+  const char* begin;
+  const char* end;
+  if (!nextToken(begin, end))
+    return false;
+
+  token.assign(begin, end);
+  return true;
+}
+
+inline bool FileTokenizer::nextTokenIs(const char* str)
+{
+  const char* begin;
+  const char* end;
+  if (!nextToken(begin, end))
+    return false;
+
+  const size_t len = strlen(str);
+  return static_cast<size_t>(end - begin) == len && memcmp(begin, str, len) == 0;
+}
+
+inline bool FileTokenizer::nextInt(int& value)
+{
+  const char* begin;
+  const char* end;
+  return nextToken(begin, end) && parseInt(begin, end, value);
+}
+
+inline bool FileTokenizer::nextDouble(double& value)
+{
+  const char* begin;
+  const char* end;
+  return nextToken(begin, end) && parseDouble(begin, end, value);
+}
+
+inline bool FileTokenizer::isLineEnd()
+{
+  while (_pCursor != _lineEnd && isspace(static_cast<unsigned char>(*_pCursor)))
+    ++_pCursor;
+  return _pCursor == _lineEnd;
+}
+
+inline bool FileTokenizer::parseInt(const char* begin, const char* end, int& value)
+{
+  const char* p = begin;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+  {
+    negative = *p == '-';
+    ++p;
+  }
+  if (p == end)
+    return false;
+
+  long long res = 0;
+  for (; p != end; ++p)
+  {
+    if (*p < '0' || '9' < *p)
+      return false;
+    res = 10 * res + (*p - '0');
+    if (res > 2147483648LL)
+      return false;
+  }
+
+  res = negative ? -res : res;
+  if (res > 2147483647LL)
+    return false;
+
+  value = static_cast<int>(res);
+  return true;
+}
+
+inline bool FileTokenizer::parseDouble(const char* begin, const char* end, double& value)
+{
+  // powers of ten that are exactly representable
+  static const double pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  const char* p = begin;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+  {
+    negative = *p == '-';
+    ++p;
+  }
+
+  uint64_t mantissa = 0;
+  int exp10 = 0;
+  int nDigits = 0;
+  bool exact = true;
+  bool any = false;
+  for (; p != end && '0' <= *p && *p <= '9'; ++p)
+  {
+    any = true;
+    if (nDigits < 19)
+    {
+      mantissa = 10 * mantissa + (*p - '0');
+      nDigits += mantissa != 0;
+    }
+    else
+    {
+      exact &= *p == '0';
+      ++exp10;
+    }
+  }
+  if (p != end && *p == '.')
+  {
+    for (++p; p != end && '0' <= *p && *p <= '9'; ++p)
+    {
+      any = true;
+      if (nDigits < 19)
+      {
+        mantissa = 10 * mantissa + (*p - '0');
+        nDigits += mantissa != 0;
+        --exp10;
+      }
+      else
+      {
+        exact &= *p == '0';
+      }
+    }
+  }
+  if (any && p != end && (*p == 'e' || *p == 'E'))
+  {
+    int exponent;
+    if (!parseInt(p + 1, end, exponent))
+      return false;
+    exp10 += exponent;
+    p = end;
+  }
+
+  // a product or quotient of two exactly representable numbers is
+  // correctly rounded, anything else is left to strtod
+  if (any && p == end && exact
+      && mantissa <= (1ULL << 53) && -22 <= exp10 && exp10 <= 22)
+  {
+    double res = static_cast<double>(mantissa);
+    res = exp10 < 0 ? res / pow10[-exp10] : res * pow10[exp10];
+    value = negative ? -res : res;
+    return true;
+  }
+
+  std::string token(begin, end);
+  char* pEnd = NULL;
+  double res = strtod(token.c_str(), &pEnd);
+  if (pEnd != token.c_str() + token.size() || token.empty())
+    return false;
+
+  value = res;
+  return true;
+}
+
+} // namespace nina
+
+#endif // FILETOKENIZER_H
@@ -0,0 +1,155 @@
+/*
+ * mappedfile.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+namespace nina {
+
+/// \brief Read-only view of the contents of a file
+///
+/// Regular files are mapped into memory. Anything else (e.g. pipes or
+/// process substitutions), or a file that cannot be mapped, is read into a
+/// buffer until EOF.
+class MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile();
+
+  /// Opens \c filename, returns false if it cannot be read
+  bool open(const std::string& filename);
+  void close();
+
+  const char* data() const
+  {
+    return _pData;
+  }
+
+  /// Size of the file in bytes
+  size_t size() const
+  {
+    return _size;
+  }
+
+private:
+  typedef std::vector<char> CharVector;
+
+  const char* _pData;
+  size_t _size;
+  bool _mapped;
+  /// Holds the file if it could not be mapped
+  CharVector _buffer;
+
+  /// Reads from \c fd until EOF into _buffer
+  bool readAll(int fd);
+
+  MappedFile(const MappedFile&);
+  void operator=(const MappedFile&);
+};
+
+inline MappedFile::MappedFile()
+  : _pData(NULL)
+  , _size(0)
+  , _mapped(false)
+  , _buffer()
+{
+}
+
+inline MappedFile::~MappedFile()
+{
+  close();
+}
+
+inline bool MappedFile::open(const std::string& filename)
+{
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) == -1)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  if (S_ISREG(st.st_mode) && st.st_size > 0)
+  {
+    _size = static_cast<size_t>(st.st_size);
+    void* p = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED)
+    {
+      madvise(p, _size, MADV_SEQUENTIAL);
+      _pData = static_cast<const char*>(p);
+      _mapped = true;
+    }
+    _size = _mapped ? _size : 0;
+  }
+
+  if (!_mapped && !readAll(fd))
+  {
+    ::close(fd);
+    close();
+    return false;
+  }
+  ::close(fd);
+
+  return true;
+}
+
+inline bool MappedFile::readAll(int fd)
+{
+  // pipes, FIFOs and the like report no size, so read in chunks
+  const size_t chunk = 1 << 16;
+  size_t n = 0;
+  while (true)
+  {
+    _buffer.resize(n + chunk);
+    ssize_t r = read(fd, &_buffer[n], chunk);
+    if (r == 0)
+      break;
+    if (r < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    n += static_cast<size_t>(r);
+  }
+
+  _buffer.resize(n);
+  _size = n;
+  _pData = _buffer.empty() ? NULL : &_buffer[0];
+  return true;
+}
+
+inline void MappedFile::close()
+{
+  if (_mapped)
+  {
+    munmap(const_cast<char*>(_pData), _size);
+  }
+  _buffer.clear();
+  _pData = NULL;
+  _size = 0;
+  _mapped = false;
+}
+
+} // namespace nina
+
+#endif // MAPPEDFILE_H
@@ -14,6 +14,7 @@
 #include <string>
 #include <lemon/core.h>
 #include "parser.h"
+#include "filetokenizer.h"
 #include "utils.h"
 
 namespace nina {
@@ -37,7 +38,6 @@ public:
   typedef typename Parent::WeightNodeMap WeightNodeMap;
   typedef typename Parent::WeightEdgeMap WeightEdgeMap;
 
-  using Parent::safeGetline;
   using Parent::_filename;
   using Parent::_pG;
   using Parent::_pIdNodeMap;
@@ -81,31 +81,25 @@ inline bool MwcsParser<GR>::parseNodes()
 {
   assert(_pG);
 
-  std::ifstream inFile(_filename.c_str());
-  if (!inFile.good())
+  FileTokenizer in;
+  if (!in.open(_filename))
   {
     std::cerr << "Error: could not open file "
               << _filename << " for reading" << std::endl;
     return false;
   }
 
-  std::string line;
+  std::string label;
+  double score;
 
-  int lineNumber = 0;
-
-  while (safeGetline(inFile, line))
+  while (in.nextLine())
   {
-    ++lineNumber;
-    if ((!line.empty() && line[0] == '#') || line.empty())
+    if (in.isLineEmpty() || in.getLineFront() == '#')
       continue;
 
-    std::stringstream lineStream(line);
-
-    std::string label;
-    double score;
+    const int lineNumber = in.getLineNumber();
 
-    lineStream >> label;
-    if (!lineStream.good())
+    if (!in.nextToken(label) || in.isLineEnd())
     {
       if (g_verbosity >= VERBOSE_ESSENTIAL)
       {
@@ -113,8 +107,7 @@ inline bool MwcsParser<GR>::parseNodes()
       }
       return false;
     }
-    lineStream >> score;
-    if (lineStream.bad() || lineStream.fail())
+    if (!in.nextDouble(score))
     {
       if (g_verbosity >= VERBOSE_ESSENTIAL)
       {
@@ -123,7 +116,7 @@ inline bool MwcsParser<GR>::parseNodes()
       return false;
     }
 
-    if (!lineStream.eof())
+    if (!in.isLineEnd())
     {
       if (g_verbosity >= VERBOSE_DEBUG)
       {
@@ -131,7 +124,9 @@ inline bool MwcsParser<GR>::parseNodes()
       }
     }
 
-    if (_pInvIdNodeMap->find(label) != _pInvIdNodeMap->end())
+    std::pair<typename InvIdNodeMap::iterator, bool> res =
+      _pInvIdNodeMap->insert(std::make_pair(label, Node(lemon::INVALID)));
+    if (!res.second)
     {
       if (g_verbosity >= VERBOSE_DEBUG)
       {
@@ -144,7 +139,7 @@ inline bool MwcsParser<GR>::parseNodes()
 
     if (_pIdNodeMap) _pIdNodeMap->set(x, label);
     if (_pWeightNodeMap) _pWeightNodeMap->set(x, score);
-    (*_pInvIdNodeMap)[label] = x;
+    res.first->second = x;
 
     _nNodes++;
   }
@@ -157,8 +152,8 @@ inline bool MwcsParser<GR>::parseEdges()
 {
   assert(_pG);
 
-  std::ifstream inFile(_filenameEdges.c_str());
-  if (!inFile.good())
+  FileTokenizer in;
+  if (!in.open(_filenameEdges))
   {
     if (g_verbosity >= VERBOSE_ESSENTIAL)
     {
@@ -168,22 +163,16 @@ inline bool MwcsParser<GR>::parseEdges()
     return false;
   }
 
-  std::string line;
+  std::string label1, label2;
 
-  int lineNumber = 0;
-
-  while (safeGetline(inFile, line))
+  while (in.nextLine())
   {
-    ++lineNumber;
-    if ((!line.empty() && line[0] == '#') || line.empty())
+    if (in.isLineEmpty() || in.getLineFront() == '#')
       continue;
 
-    std::stringstream lineStream(line);
-
-    std::string label1, label2, trail;
+    const int lineNumber = in.getLineNumber();
 
-    lineStream >> label1;
-    if (!lineStream.good())
+    if (!in.nextToken(label1) || in.isLineEnd())
     {
       if (g_verbosity >= VERBOSE_ESSENTIAL)
       {
@@ -191,8 +180,7 @@ inline bool MwcsParser<GR>::parseEdges()
       }
       return false;
     }
-    lineStream >> label2;
-    if (lineStream.bad() || lineStream.fail())
+    if (!in.nextToken(label2))
     {
       if (g_verbosity >= VERBOSE_ESSENTIAL)
       {
@@ -201,8 +189,7 @@ inline bool MwcsParser<GR>::parseEdges()
       return false;
     }
 
-    lineStream >> trail;
-    if (!trail.empty())
+    if (!in.isLineEnd())
     {
       if (g_verbosity >= VERBOSE_DEBUG)
       {
@@ -211,7 +198,8 @@ inline bool MwcsParser<GR>::parseEdges()
       }
     }
 
-    if (_pInvIdNodeMap->find(label1) == _pInvIdNodeMap->end())
+    typename InvIdNodeMap::const_iterator it1 = _pInvIdNodeMap->find(label1);
+    if (it1 == _pInvIdNodeMap->end())
     {
       if (g_verbosity >= VERBOSE_DEBUG)
       {
@@ -222,7 +210,8 @@ inline bool MwcsParser<GR>::parseEdges()
       continue;
     }
 
-    if (_pInvIdNodeMap->find(label2) == _pInvIdNodeMap->end())
+    typename InvIdNodeMap::const_iterator it2 = _pInvIdNodeMap->find(label2);
+    if (it2 == _pInvIdNodeMap->end())
     {
       if (g_verbosity >= VERBOSE_DEBUG)
       {
@@ -233,8 +222,8 @@ inline bool MwcsParser<GR>::parseEdges()
       continue;
     }
 
-    Node node1 = (*_pInvIdNodeMap)[label1];
-    Node node2 = (*_pInvIdNodeMap)[label2];
+    Node node1 = it1->second;
+    Node node2 = it2->second;
 
     if (node1 == node2)
     {
@@ -247,7 +236,7 @@ inline bool MwcsParser<GR>::parseEdges()
       continue;
     }
 
-    _pG->addEdge((*_pInvIdNodeMap)[label1], (*_pInvIdNodeMap)[label2]);
+    _pG->addEdge(node1, node2);
     _nEdges++;
   }
 
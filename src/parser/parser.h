@@ -12,9 +12,11 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <lemon/core.h>
 #include <fstream>
+#include "filetokenizer.h"
 
 namespace nina {
 
@@ -31,7 +33,7 @@ protected:
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
 
 public:
-  typedef std::map<std::string, typename Graph::Node> InvIdNodeMap;
+  typedef std::unordered_map<std::string, typename Graph::Node> InvIdNodeMap;
   typedef NLBL IdNodeMap;
   typedef NWGHT WeightNodeMap;
   typedef EWGHT WeightEdgeMap;
@@ -64,6 +66,12 @@ public:
   virtual ~Parser() {}
   virtual bool parse() = 0;
 
+  /// Whether parse() fills in the weight edge map
+  virtual bool hasEdgeWeights() const
+  {
+    return false;
+  }
+
   const std::string& getFilename()
   {
     return _filename;
@@ -15,6 +15,7 @@
 #include <limits>
 #include <lemon/core.h>
 #include "parser.h"
+#include "filetokenizer.h"
 #include "utils.h"
 
 namespace nina {
@@ -38,7 +39,6 @@ public:
   typedef typename Parent::WeightNodeMap WeightNodeMap;
   typedef typename Parent::WeightEdgeMap WeightEdgeMap;
 
-  using Parent::safeGetline;
   using Parent::_filename;
   using Parent::_pG;
   using Parent::_pIdNodeMap;
@@ -49,13 +49,13 @@ public:
   using Parent::_nEdges;
 
 private:
-  bool parseHeader(std::istream& in, int& lineNumber);
-  bool parseGraph(std::istream& in, int& lineNumber);
-  bool parseNrNodes(std::istream& in, int& lineNumber);
-  bool parseNrEdges(std::istream& in, int& lineNumber);
-  bool parseNrTerminals(std::istream& in, int& lineNumber);
-  bool parseEdge(std::istream& in, int& lineNumber);
-  bool parseTerminal(std::istream& in, int& lineNumber);
+  bool parseHeader(FileTokenizer& in);
+  bool parseGraph(FileTokenizer& in);
+  bool parseNrNodes(FileTokenizer& in);
+  bool parseNrEdges(FileTokenizer& in);
+  bool parseNrTerminals(FileTokenizer& in);
+  bool parseEdge(FileTokenizer& in);
+  bool parseTerminal(FileTokenizer& in);
 
 public:
   StpParser(const std::string& filename);
@@ -76,43 +76,26 @@ inline StpParser<GR>::StpParser(const std::string& filename)
 }
 
 template<typename GR>
-inline bool StpParser<GR>::parseHeader(std::istream& in, int& lineNumber)
+inline bool StpParser<GR>::parseHeader(FileTokenizer& in)
 {
-  std::string line;
-  if (safeGetline(in, line))
-  {
-    lineNumber++;
-    return line.substr(0, 8) == "33D32945";
-  }
-  else
-  {
-    return false;
-  }
+  return in.nextLine() && in.lineStartsWith("33D32945");
 }
 
 template<typename GR>
-inline bool StpParser<GR>::parseNrTerminals(std::istream& in, int& lineNumber)
+inline bool StpParser<GR>::parseNrTerminals(FileTokenizer& in)
 {
-  std::string line;
-
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
-
-    if (text != "Terminals")
+    if (!in.nextTokenIs("Terminals"))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'Terminals'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'Terminals'" << std::endl;
       return false;
     }
 
     int nTerminals = -1;
-    ss >> nTerminals;
-    if (nTerminals != _nNodes)
+    if (!in.nextInt(nTerminals) || nTerminals != _nNodes)
     {
-      std::cerr << "Error at line " << lineNumber << ": terminal count must match node count" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": terminal count must match node count" << std::endl;
       return false;
     }
     return true;
@@ -125,25 +108,23 @@ inline bool StpParser<GR>::parseNrTerminals(std::istream& in, int& lineNumber)
 }
 
 template<typename GR>
-inline bool StpParser<GR>::parseNrNodes(std::istream& in, int& lineNumber)
+inline bool StpParser<GR>::parseNrNodes(FileTokenizer& in)
 {
-  std::string line;
-
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
-
-    if (text != "Nodes")
+    if (!in.nextTokenIs("Nodes"))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'Nodes'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'Nodes'" << std::endl;
       return false;
     }
 
-    ss >> _nNodes;
+    if (!in.nextInt(_nNodes) || _nNodes < 0)
+    {
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected node count" << std::endl;
+      return false;
+    }
     _pG->reserveNode(_nNodes);
+    _pInvIdNodeMap->reserve(_nNodes);
     return true;
   }
   else
@@ -154,24 +135,21 @@ inline bool StpParser<GR>::parseNrNodes(std::istream& in, int& lineNumber)
 }
 
 template<typename GR>
-inline bool StpParser<GR>::parseNrEdges(std::istream& in, int& lineNumber)
+inline bool StpParser<GR>::parseNrEdges(FileTokenizer& in)
 {
-  std::string line;
-
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
-
-    if (text != "Edges")
+    if (!in.nextTokenIs("Edges"))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'Edges'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'Edges'" << std::endl;
       return false;
     }
 
-    ss >> _nEdges;
+    if (!in.nextInt(_nEdges) || _nEdges < 0)
+    {
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected edge count" << std::endl;
+      return false;
+    }
     _pG->reserveEdge(_nEdges);
     
     return true;
@@ -184,14 +162,13 @@ inline bool StpParser<GR>::parseNrEdges(std::istream& in, int& lineNumber)
 }
 
 template<typename GR>
-inline bool StpParser<GR>::parseGraph(std::istream& in, int& lineNumber)
+inline bool StpParser<GR>::parseGraph(FileTokenizer& in)
 {
-  std::string line;
-  
   // skip until "Name"
-  while (safeGetline(in, line) && line.substr(0, 4) != "Name")
-    lineNumber++;
+  bool found = false;
+  while (in.nextLine() && !(found = in.lineStartsWith("Name"))) ;
   
+  const std::string line = found ? in.getLine() : std::string();
   if (line.size() < 6)
   {
     std::cerr << "Error: missing 'Name'" << std::endl;
@@ -200,16 +177,16 @@ inline bool StpParser<GR>::parseGraph(std::istream& in, int& lineNumber)
   _name = line.substr(5);
 
   // skip until "SECTION Graph"
-  while (safeGetline(in, line) && line != "SECTION Graph")
-    lineNumber++;
+  found = false;
+  while (in.nextLine() && !(found = in.lineEquals("SECTION Graph"))) ;
 
-  if (line != "SECTION Graph")
+  if (!found)
   {
     std::cerr << "Error: missing 'SECTION Graph'" << std::endl;
     return false;
   }
 
-  if (!parseNrNodes(in, lineNumber) || !parseNrEdges(in, lineNumber))
+  if (!parseNrNodes(in) || !parseNrEdges(in))
   {
     return false;
   }
@@ -223,30 +200,30 @@ inline bool StpParser<GR>::parseGraph(std::istream& in, int& lineNumber)
   // add edges
   for (int i = 0;i < _nEdges; i++)
   {
-    if (!parseEdge(in, lineNumber))
+    if (!parseEdge(in))
     {
       return false;
     }
   }
 
   // skip until "SECTION Terminals"
-  while (safeGetline(in, line) && line != "SECTION Terminals")
-    lineNumber++;
+  found = false;
+  while (in.nextLine() && !(found = in.lineEquals("SECTION Terminals"))) ;
 
-  if (line != "SECTION Terminals")
+  if (!found)
   {
     std::cerr << "Error: missing 'SECTION Terminals'" << std::endl;
     return false;
   }
 
-  if (!parseNrTerminals(in, lineNumber))
+  if (!parseNrTerminals(in))
   {
     return false;
   }
 
   for (int i = 0; i < _nNodes; i++)
   {
-    if (!parseTerminal(in, lineNumber))
+    if (!parseTerminal(in))
     {
       return false;
     }
@@ -256,29 +233,21 @@ inline bool StpParser<GR>::parseGraph(std::istream& in, int& lineNumber)
 }
 
 template<typename GR>
-inline bool StpParser<GR>::parseEdge(std::istream& in, int& lineNumber)
+inline bool StpParser<GR>::parseEdge(FileTokenizer& in)
 {
-  std::string line;
-
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
-
-    if (text != "E")
+    if (!in.nextTokenIs("E"))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'E'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'E'" << std::endl;
       return false;
     }
 
     int idU = -1, idV = -1;
-    ss >> idU >> idV;
-
-    if (!(0 < idU && idU <= _nNodes) || !(0 < idV && idV <= _nNodes))
+    if (!in.nextInt(idU) || !in.nextInt(idV)
+        || !(0 < idU && idU <= _nNodes) || !(0 < idV && idV <= _nNodes))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected node id in [1, "
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected node id in [1, "
                 << _nNodes << "]" << std::endl;
       return false;
     }
@@ -297,39 +266,31 @@ inline bool StpParser<GR>::parseEdge(std::istream& in, int& lineNumber)
 }
 
 template<typename GR>
-inline bool StpParser<GR>::parseTerminal(std::istream& in, int& lineNumber)
+inline bool StpParser<GR>::parseTerminal(FileTokenizer& in)
 {
-  std::string line;
   char buf[1024];
 
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
-
-    if (text != "T")
+    if (!in.nextTokenIs("T"))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'T'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'T'" << std::endl;
       return false;
     }
 
     int idU = -1;
     double weightU = -std::numeric_limits<double>::max();
 
-    ss >> idU >> weightU;
-
-    if (!(0 < idU && idU <= _nNodes))
+    if (!in.nextInt(idU) || !(0 < idU && idU <= _nNodes))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected node id in [1, "
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected node id in [1, "
                 << _nNodes << "]" << std::endl;
       return false;
     }
 
-    if (weightU == -std::numeric_limits<double>::max())
+    if (!in.nextDouble(weightU))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected real-valued node weight"
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected real-valued node weight"
                 << std::endl;
       return false;
     }
@@ -356,8 +317,8 @@ inline bool StpParser<GR>::parse()
   if (!_pG)
     return false;
 
-  std::ifstream in(_filename.c_str());
-  if (!in.good())
+  FileTokenizer in;
+  if (!in.open(_filename))
   {
     std::cerr << "Error: could not open file "
               << _filename << " for reading" << std::endl;
@@ -366,8 +327,7 @@ inline bool StpParser<GR>::parse()
 
   _pG->clear();
 
-  int lineNumber = 0;
-  return parseHeader(in, lineNumber) && parseGraph(in, lineNumber);
+  return parseHeader(in) && parseGraph(in);
 }
 
 } // namespace mwcs
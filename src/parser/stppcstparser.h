@@ -16,6 +16,7 @@
 #include <lemon/core.h>
 #include <set>
 #include "parser.h"
+#include "filetokenizer.h"
 #include "utils.h"
 
 namespace nina {
@@ -43,7 +44,6 @@ public:
   typedef typename Parent::WeightNodeMap WeightNodeMap;
   typedef typename Parent::WeightEdgeMap WeightEdgeMap;
 
-  using Parent::safeGetline;
   using Parent::_filename;
   using Parent::_pG;
   using Parent::_pIdNodeMap;
@@ -54,17 +54,25 @@ public:
   using Parent::_nEdges;
 
 private:
-  bool parseHeader(std::istream& in, int& lineNumber);
-  bool parseGraph(std::istream& in, int& lineNumber);
-  bool parseNrNodes(std::istream& in, int& lineNumber);
-  bool parseNrEdges(std::istream& in, int& lineNumber);
-  bool parseNrTerminals(std::istream& in, int& lineNumber);
-  bool parseEdge(std::istream& in, int& lineNumber);
-  bool parseTerminal(std::istream& in, int& lineNumber);
+  bool parseHeader(FileTokenizer& in);
+  bool parseGraph(FileTokenizer& in);
+  bool parseNrNodes(FileTokenizer& in);
+  bool parseNrEdges(FileTokenizer& in);
+  bool parseNrTerminals(FileTokenizer& in);
+  bool parseEdge(FileTokenizer& in);
+  bool parseTerminal(FileTokenizer& in);
   
 public:
-  StpPcstParser(const std::string& filename);
+  /// If \c edgeCosts is set, edge costs are stored in the weight edge map
+  /// instead of splitting every edge by a node of negative weight
+  StpPcstParser(const std::string& filename, bool edgeCosts = false);
   bool parse();
+
+  virtual bool hasEdgeWeights() const
+  {
+    return _edgeCosts;
+  }
+
   const std::string& getName() const
   {
     return _name;
@@ -81,6 +89,7 @@ public:
   }
   
 protected:
+  bool _edgeCosts;
   std::string _name;
   int _nOrgNodes;
   int _nOrgEdges;
@@ -90,8 +99,10 @@ protected:
 };
 
 template<typename GR>
-inline StpPcstParser<GR>::StpPcstParser(const std::string& filename)
+inline StpPcstParser<GR>::StpPcstParser(const std::string& filename,
+                                         bool edgeCosts)
   : Parent(filename)
+  , _edgeCosts(edgeCosts)
   , _name()
   , _nOrgNodes(0)
   , _nOrgEdges(0)
@@ -101,43 +112,26 @@ inline StpPcstParser<GR>::StpPcstParser(const std::string& filename)
 }
 
 template<typename GR>
-inline bool StpPcstParser<GR>::parseHeader(std::istream& in, int& lineNumber)
+inline bool StpPcstParser<GR>::parseHeader(FileTokenizer& in)
 {
-  std::string line;
-  if (safeGetline(in, line))
-  {
-    lineNumber++;
-    return line.substr(0, 8) == "33D32945";
-  }
-  else
-  {
-    return false;
-  }
+  return in.nextLine() && in.lineStartsWith("33D32945");
 }
 
 template<typename GR>
-inline bool StpPcstParser<GR>::parseNrTerminals(std::istream& in, int& lineNumber)
+inline bool StpPcstParser<GR>::parseNrTerminals(FileTokenizer& in)
 {
-  std::string line;
-
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
-
-    if (text != "Terminals")
+    if (!in.nextTokenIs("Terminals"))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'Terminals'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'Terminals'" << std::endl;
       return false;
     }
 
     _nTerminals = -1;
-    ss >> _nTerminals;
-    if (_nTerminals < 0)
+    if (!in.nextInt(_nTerminals) || _nTerminals < 0)
     {
-      std::cerr << "Error at line " << lineNumber << ": terminal count must be nonnegative" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": terminal count must be nonnegative" << std::endl;
       return false;
     }
     return true;
@@ -150,24 +144,21 @@ inline bool StpPcstParser<GR>::parseNrTerminals(std::istream& in, int& lineNumbe
 }
 
 template<typename GR>
-inline bool StpPcstParser<GR>::parseNrNodes(std::istream& in, int& lineNumber)
+inline bool StpPcstParser<GR>::parseNrNodes(FileTokenizer& in)
 {
-  std::string line;
-
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
-
-    if (text != "Nodes")
+    if (!in.nextTokenIs("Nodes"))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'Nodes'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'Nodes'" << std::endl;
       return false;
     }
 
-    ss >> _nOrgNodes;
+    if (!in.nextInt(_nOrgNodes) || _nOrgNodes < 0)
+    {
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected node count" << std::endl;
+      return false;
+    }
     return true;
   }
   else
@@ -178,32 +169,38 @@ inline bool StpPcstParser<GR>::parseNrNodes(std::istream& in, int& lineNumber)
 }
 
 template<typename GR>
-inline bool StpPcstParser<GR>::parseNrEdges(std::istream& in, int& lineNumber)
+inline bool StpPcstParser<GR>::parseNrEdges(FileTokenizer& in)
 {
-  std::string line;
-
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
-
-    if (text != "Edges")
+    if (!in.nextTokenIs("Edges"))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'Edges'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'Edges'" << std::endl;
       return false;
     }
 
-    ss >> _nOrgEdges;
+    if (!in.nextInt(_nOrgEdges) || _nOrgEdges < 0)
+    {
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected edge count" << std::endl;
+      return false;
+    }
     
-    // because of the transformation every edge becomes a node of itself
-    _nNodes = _nOrgNodes + _nOrgEdges;
-    // duplicate edges because of transformation
-    _nEdges = 2 * _nOrgEdges;
+    if (_edgeCosts)
+    {
+      _nNodes = _nOrgNodes;
+      _nEdges = _nOrgEdges;
+    }
+    else
+    {
+      // because of the transformation every edge becomes a node of itself
+      _nNodes = _nOrgNodes + _nOrgEdges;
+      // duplicate edges because of transformation
+      _nEdges = 2 * _nOrgEdges;
+    }
 
     _pG->reserveNode(_nNodes);
     _pG->reserveEdge(_nEdges);
+    _pInvIdNodeMap->reserve(_nNodes);
     
     return true;
   }
@@ -215,15 +212,15 @@ inline bool StpPcstParser<GR>::parseNrEdges(std::istream& in, int& lineNumber)
 }
 
 template<typename GR>
-inline bool StpPcstParser<GR>::parseGraph(std::istream& in, int& lineNumber)
+inline bool StpPcstParser<GR>::parseGraph(FileTokenizer& in)
 {
-  std::string line;
   char buf[1024];
   
   // skip until "Name"
-  while (safeGetline(in, line) && line.substr(0, 4) != "Name")
-    lineNumber++;
+  bool found = false;
+  while (in.nextLine() && !(found = in.lineStartsWith("Name"))) ;
   
+  const std::string line = found ? in.getLine() : std::string();
   if (line.size() < 6)
   {
     std::cerr << "Error: missing 'Name'" << std::endl;
@@ -232,16 +229,16 @@ inline bool StpPcstParser<GR>::parseGraph(std::istream& in, int& lineNumber)
   _name = line.substr(5);
 
   // skip until "SECTION Graph"
-  while (safeGetline(in, line) && line != "SECTION Graph")
-    lineNumber++;
+  found = false;
+  while (in.nextLine() && !(found = in.lineEquals("SECTION Graph"))) ;
 
-  if (line != "SECTION Graph")
+  if (!found)
   {
     std::cerr << "Error: missing 'SECTION Graph'" << std::endl;
     return false;
   }
 
-  if (!parseNrNodes(in, lineNumber) || !parseNrEdges(in, lineNumber))
+  if (!parseNrNodes(in) || !parseNrEdges(in))
   {
     return false;
   }
@@ -260,23 +257,23 @@ inline bool StpPcstParser<GR>::parseGraph(std::istream& in, int& lineNumber)
   // add edges
   for (int i = 0;i < _nOrgEdges; i++)
   {
-    if (!parseEdge(in, lineNumber))
+    if (!parseEdge(in))
     {
       return false;
     }
   }
 
   // skip until "SECTION Terminals"
-  while (safeGetline(in, line) && line != "SECTION Terminals")
-    lineNumber++;
+  found = false;
+  while (in.nextLine() && !(found = in.lineEquals("SECTION Terminals"))) ;
 
-  if (line != "SECTION Terminals")
+  if (!found)
   {
     std::cerr << "Error: missing 'SECTION Terminals'" << std::endl;
     return false;
   }
 
-  if (!parseNrTerminals(in, lineNumber))
+  if (!parseNrTerminals(in))
   {
     return false;
   }
@@ -284,7 +281,7 @@ inline bool StpPcstParser<GR>::parseGraph(std::istream& in, int& lineNumber)
   _pV = 0;
   for (int i = 0; i < _nTerminals; i++)
   {
-    if (!parseTerminal(in, lineNumber))
+    if (!parseTerminal(in))
     {
       return false;
     }
@@ -294,44 +291,44 @@ inline bool StpPcstParser<GR>::parseGraph(std::istream& in, int& lineNumber)
 }
 
 template<typename GR>
-inline bool StpPcstParser<GR>::parseEdge(std::istream& in, int& lineNumber)
+inline bool StpPcstParser<GR>::parseEdge(FileTokenizer& in)
 {
-  std::string line;
   char buf[1024];
 
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
-
-    if (text != "E")
+    if (!in.nextTokenIs("E"))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'E'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'E'" << std::endl;
       return false;
     }
 
     int idU = -1, idV = -1;
     double costUV = std::numeric_limits<double>::max();
-    ss >> idU >> idV >> costUV;
-
-    if (!(0 < idU && idU <= _nNodes) || !(0 < idV && idV <= _nNodes))
+    if (!in.nextInt(idU) || !in.nextInt(idV)
+        || !(0 < idU && idU <= _nNodes) || !(0 < idV && idV <= _nNodes))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected node id in [1, "
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected node id in [1, "
                 << _nNodes << "]" << std::endl;
       return false;
     }
     
-    if (costUV == std::numeric_limits<double>::max())
+    if (!in.nextDouble(costUV))
     {
-      std::cerr << "Error at line " << lineNumber << ": expected real-valued edge cost"
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected real-valued edge cost"
                 << std::endl;
       return false;
     }
 
     Node u = _pG->nodeFromId(idU - 1);
     Node v = _pG->nodeFromId(idV - 1);
+    if (_edgeCosts)
+    {
+      Edge e = _pG->addEdge(u, v);
+      _pWeightEdgeMap->set(e, costUV);
+      return true;
+    }
+
     Node uv = _pG->addNode();
     _pG->addEdge(u, uv);
     _pG->addEdge(uv, v);
@@ -351,27 +348,27 @@ inline bool StpPcstParser<GR>::parseEdge(std::istream& in, int& lineNumber)
 }
 
 template<typename GR>
-inline bool StpPcstParser<GR>::parseTerminal(std::istream& in, int& lineNumber)
+inline bool StpPcstParser<GR>::parseTerminal(FileTokenizer& in)
 {
-  std::string line;
+  std::string text;
 
-  if (safeGetline(in, line))
+  if (in.nextLine())
   {
-    std::string text;
-    std::stringstream ss(line);
-    lineNumber++;
-    ss >> text;
+    in.nextToken(text);
 
     if (text != "TP" && text != "RootP")
     {
-      std::cerr << "Error at line " << lineNumber << ": expected 'TP' or 'RootP'" << std::endl;
+      std::cerr << "Error at line " << in.getLineNumber() << ": expected 'TP' or 'RootP'" << std::endl;
       return false;
     }
 
     int idU = -1;
     double weightU = -std::numeric_limits<double>::max();
 
-    ss >> idU >> weightU;
+    if (in.nextInt(idU))
+    {
+      in.nextDouble(weightU);
+    }
     
     if (text == "RootP")
     {
@@ -382,14 +379,14 @@ inline bool StpPcstParser<GR>::parseTerminal(std::istream& in, int& lineNumber)
     {
       if (!(0 < idU && idU <= _nNodes))
       {
-        std::cerr << "Error at line " << lineNumber << ": expected node id in [1, "
+        std::cerr << "Error at line " << in.getLineNumber() << ": expected node id in [1, "
                   << _nNodes << "]" << std::endl;
         return false;
       }
 
       if (weightU == -std::numeric_limits<double>::max())
       {
-        std::cerr << "Error at line " << lineNumber << ": expected real-valued node weight"
+        std::cerr << "Error at line " << in.getLineNumber() << ": expected real-valued node weight"
                   << std::endl;
         return false;
       }
@@ -411,11 +408,11 @@ inline bool StpPcstParser<GR>::parseTerminal(std::istream& in, int& lineNumber)
 template<typename GR>
 inline bool StpPcstParser<GR>::parse()
 {
-  if (!_pG)
+  if (!_pG || (_edgeCosts && !_pWeightEdgeMap))
     return false;
 
-  std::ifstream in(_filename.c_str());
-  if (!in.good())
+  FileTokenizer in;
+  if (!in.open(_filename))
   {
     std::cerr << "Error: could not open file "
               << _filename << " for reading" << std::endl;
@@ -424,8 +421,7 @@ inline bool StpPcstParser<GR>::parse()
 
   _pG->clear();
 
-  int lineNumber = 0;
-  return parseHeader(in, lineNumber) && parseGraph(in, lineNumber);
+  return parseHeader(in) && parseGraph(in);
 }
 
 } // namespace mwcs
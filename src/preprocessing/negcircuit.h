@@ -29,6 +29,8 @@ public:
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetMap NodeSetMap;
+  typedef typename Parent::NeighborSet NeighborSet;
+  typedef typename Parent::NeighborMap NeighborMap;
   typedef typename Parent::DegreeNodeMap DegreeNodeMap;
   typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
   typedef typename Parent::LabelNodeMap LabelNodeMap;
@@ -37,6 +39,7 @@ public:
 
   using Parent::remove;
   using Parent::merge;
+  using Parent::nextDirty;
 
   NegCircuit();
   virtual ~NegCircuit() {}
@@ -46,7 +49,7 @@ public:
                     WeightNodeMap& score,
                     NodeSetMap& mapToPre,
                     NodeSetMap& preOrigNodes,
-                    NodeSetMap& neighbors,
+                    NeighborMap& neighbors,
                     int& nNodes,
                     int& nArcs,
                     int& nEdges,
@@ -55,6 +58,8 @@ public:
                     double& LB);
 
   virtual std::string name() const { return "NegCircuit"; }
+
+  virtual Parent* clone() const { return new NegCircuit(); }
 };
 
 template<typename GR, typename WGHT>
@@ -70,7 +75,7 @@ inline int NegCircuit<GR, WGHT>::apply(Graph& g,
                                        WeightNodeMap& score,
                                        NodeSetMap& mapToPre,
                                        NodeSetMap& preOrigNodes,
-                                       NodeSetMap& neighbors,
+                                       NeighborMap& neighbors,
                                        int& nNodes,
                                        int& nArcs,
                                        int& nEdges,
@@ -78,20 +83,13 @@ inline int NegCircuit<GR, WGHT>::apply(Graph& g,
                                        DegreeNodeSetVector& degreeVector,
                                        double& LB)
 {
-  if (degreeVector.size() <= 2)
-  {
-    // nothing to remove, there are no degree 2 nodes
-    return 0;
-  }
-  
-  const NodeSet& nodes = degreeVector[2];
+  int res = 0;
   
-  for (NodeSetIt nodeIt = nodes.begin(); nodeIt != nodes.end(); ++nodeIt)
+  Node v;
+  while (nextDirty(g, v))
   {
-    Node v = *nodeIt;
-    if (score[v] <= 0 && rootNodes.find(v) == rootNodes.end())
+    if (degree[v] == 2 && score[v] <= 0 && rootNodes.find(v) == rootNodes.end())
     {
-      assert(degree[v] == 2);
       Edge e1 = IncEdgeIt(g, v);
       Edge e2 = ++IncEdgeIt(g, v);
 
@@ -103,12 +101,12 @@ inline int NegCircuit<GR, WGHT>::apply(Graph& g,
                mapToPre, preOrigNodes, neighbors,
                nNodes, nArcs, nEdges,
                degree, degreeVector, v);
-        return 1;
+        ++res;
       }
     }
   }
               
-  return 0;
+  return res;
 }
 
 } // namespace mwcs
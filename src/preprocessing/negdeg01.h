@@ -29,6 +29,8 @@ public:
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetMap NodeSetMap;
+  typedef typename Parent::NeighborSet NeighborSet;
+  typedef typename Parent::NeighborMap NeighborMap;
   typedef typename Parent::DegreeNodeMap DegreeNodeMap;
   typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
   typedef typename Parent::LabelNodeMap LabelNodeMap;
@@ -36,6 +38,7 @@ public:
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
 
   using Parent::remove;
+  using Parent::nextDirty;
 
   NegDeg01();
   virtual ~NegDeg01() {}
@@ -45,7 +48,7 @@ public:
                     WeightNodeMap& score,
                     NodeSetMap& mapToPre,
                     NodeSetMap& preOrigNodes,
-                    NodeSetMap& neighbors,
+                    NeighborMap& neighbors,
                     int& nNodes,
                     int& nArcs,
                     int& nEdges,
@@ -55,20 +58,7 @@ public:
 
   virtual std::string name() const { return "NegDeg01"; }
 
-protected:
-  int apply(Graph& g,
-            const NodeSet& rootNodes,
-            LabelNodeMap& label,
-            WeightNodeMap& score,
-            NodeSetMap& mapToPre,
-            NodeSetMap& preOrigNodes,
-            NodeSetMap& neighbors,
-            int& nNodes,
-            int& nArcs,
-            int& nEdges,
-            DegreeNodeMap& degree,
-            DegreeNodeSetVector& degreeVector,
-            int d);
+  virtual Parent* clone() const { return new NegDeg01(); }
 };
 
 template<typename GR, typename WGHT>
@@ -84,7 +74,7 @@ inline int NegDeg01<GR, WGHT>::apply(Graph& g,
                                      WeightNodeMap& score,
                                      NodeSetMap& mapToPre,
                                      NodeSetMap& preOrigNodes,
-                                     NodeSetMap& neighbors,
+                                     NeighborMap& neighbors,
                                      int& nNodes,
                                      int& nArcs,
                                      int& nEdges,
@@ -92,57 +82,24 @@ inline int NegDeg01<GR, WGHT>::apply(Graph& g,
                                      DegreeNodeSetVector& degreeVector,
                                      double& LB)
 {
-  return apply(g, rootNodes,
-               label, score,
-               mapToPre, preOrigNodes, neighbors,
-               nNodes, nArcs, nEdges,
-               degree, degreeVector, 0)
-      + apply(g, rootNodes,
-              label, score,
-              mapToPre, preOrigNodes, neighbors,
-              nNodes, nArcs, nEdges,
-              degree, degreeVector, 1);
-}
+  int res = 0;
 
-template<typename GR, typename WGHT>
-inline int NegDeg01<GR, WGHT>::apply(Graph& g,
-                                     const NodeSet& rootNodes,
-                                     LabelNodeMap& label,
-                                     WeightNodeMap& score,
-                                     NodeSetMap& mapToPre,
-                                     NodeSetMap& preOrigNodes,
-                                     NodeSetMap& neighbors,
-                                     int& nNodes,
-                                     int& nArcs,
-                                     int& nEdges,
-                                     DegreeNodeMap& degree,
-                                     DegreeNodeSetVector& degreeVector,
-                                     int d)
-{
-  if (static_cast<int>(degreeVector.size()) <= d)
-    return 0;
-
-  const NodeSet& nodes = degreeVector[d];
-
-  for (NodeSetIt nodeIt = nodes.begin(); nodeIt != nodes.end();)
+  // removing a node dirties its neighbors,
+  // which may then be of degree 0 or 1 themselves
+  Node v;
+  while (nextDirty(g, v))
   {
-    NodeSetIt nextNodeIt = nodeIt;
-    nextNodeIt++;
-    
-    Node v = *nodeIt;
     // remove if negative and not the root node
-    if (score[v] < 0 && rootNodes.find(v) == rootNodes.end())
+    if (degree[v] <= 1 && score[v] < 0 && rootNodes.find(v) == rootNodes.end())
     {
       remove(g, mapToPre, preOrigNodes, neighbors,
              nNodes, nArcs, nEdges,
              degree, degreeVector, v);
-      return 1;
+      ++res;
     }
-
-    nodeIt = nextNodeIt;
   }
 
-  return 0;
+  return res;
 }
 
 } // namespace mwcs
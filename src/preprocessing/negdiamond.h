@@ -29,6 +29,8 @@ public:
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetMap NodeSetMap;
+  typedef typename Parent::NeighborSet NeighborSet;
+  typedef typename Parent::NeighborMap NeighborMap;
   typedef typename Parent::DegreeNodeMap DegreeNodeMap;
   typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
   typedef typename Parent::LabelNodeMap LabelNodeMap;
@@ -37,6 +39,7 @@ public:
 
   using Parent::remove;
   using Parent::merge;
+  using Parent::consumeDirty;
 
   NegDiamond();
   virtual ~NegDiamond() {}
@@ -46,7 +49,7 @@ public:
                     WeightNodeMap& score,
                     NodeSetMap& mapToPre,
                     NodeSetMap& preOrigNodes,
-                    NodeSetMap& neighbors,
+                    NeighborMap& neighbors,
                     int& nNodes,
                     int& nArcs,
                     int& nEdges,
@@ -55,6 +58,8 @@ public:
                     double& LB);
 
   virtual std::string name() const { return "NegDiamond"; }
+
+  virtual Parent* clone() const { return new NegDiamond(); }
 };
 
 template<typename GR, typename WGHT>
@@ -70,7 +75,7 @@ inline int NegDiamond<GR, WGHT>::apply(Graph& g,
                                        WeightNodeMap& score,
                                        NodeSetMap& mapToPre,
                                        NodeSetMap& preOrigNodes,
-                                       NodeSetMap& neighbors,
+                                       NeighborMap& neighbors,
                                        int& nNodes,
                                        int& nArcs,
                                        int& nEdges,
@@ -86,6 +91,9 @@ inline int NegDiamond<GR, WGHT>::apply(Graph& g,
   typedef std::map<NodePair, WeightNodePairSet> NodePairMap;
   typedef typename NodePairMap::const_iterator NodePairMapIt;
 
+  // diamonds are determined from scratch
+  consumeDirty();
+
   NodePairMap map;
   NodePairMap posMap;
 
@@ -8,6 +8,8 @@
 #ifndef NEGDOMINATEDHUBS_H
 #define NEGDOMINATEDHUBS_H
 
+#include <algorithm>
+#include <vector>
 #include "rule.h"
 
 namespace nina {
@@ -25,14 +27,23 @@ namespace nina {
       typedef typename Parent::NodeSet NodeSet;
       typedef typename Parent::NodeSetIt NodeSetIt;
       typedef typename Parent::NodeSetMap NodeSetMap;
+      typedef typename Parent::NeighborSet NeighborSet;
+      typedef typename Parent::NeighborMap NeighborMap;
       typedef typename Parent::DegreeNodeMap DegreeNodeMap;
       typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
       typedef typename Parent::LabelNodeMap LabelNodeMap;
+      typedef typename Parent::NeighborSetIt NeighborSetIt;
       
       TEMPLATE_GRAPH_TYPEDEFS(Graph);
       
+      typedef typename Graph::template NodeMap<unsigned long long> FingerprintNodeMap;
+      typedef DenseNodeSet<Graph> DenseNodeSetType;
+      typedef typename DenseNodeSetType::const_iterator DenseNodeSetIt;
+      
       using Parent::remove;
       using Parent::merge;
+      using Parent::nextDirty;
+      using Parent::neighborhoodFingerprint;
       
       NegDominatedHubs();
       virtual ~NegDominatedHubs() {}
@@ -42,7 +53,7 @@ namespace nina {
                         WeightNodeMap& score,
                         NodeSetMap& mapToPre,
                         NodeSetMap& preOrigNodes,
-                        NodeSetMap& neighbors,
+                        NeighborMap& neighbors,
                         int& nNodes,
                         int& nArcs,
                         int& nEdges,
@@ -51,6 +62,33 @@ namespace nina {
                         double& LB);
       
       virtual std::string name() const { return "NegDominatedHubs"; }
+
+      virtual Parent* clone() const { return new NegDominatedHubs(); }
+      
+    private:
+      typedef std::vector<Node> NodeVector;
+      typedef typename NodeVector::const_iterator NodeVectorIt;
+      typedef std::vector<NodeVector> NodeVectorVector;
+      
+      /// Orders nodes by decreasing degree, then by decreasing score
+      struct Rank
+      {
+        Rank(const DegreeNodeMap& degree, const WeightNodeMap& score)
+          : _degree(degree)
+          , _score(score)
+        {
+        }
+        
+        bool operator()(Node u, Node v) const
+        {
+          if (_degree[u] != _degree[v])
+            return _degree[u] > _degree[v];
+          return _score[u] > _score[v];
+        }
+        
+        const DegreeNodeMap& _degree;
+        const WeightNodeMap& _score;
+      };
     };
     
     template<typename GR, typename WGHT>
@@ -66,7 +104,7 @@ namespace nina {
                                                   WeightNodeMap& score,
                                                   NodeSetMap& mapToPre,
                                                   NodeSetMap& preOrigNodes,
-                                                  NodeSetMap& neighbors,
+                                                  NeighborMap& neighbors,
                                                   int& nNodes,
                                                   int& nArcs,
                                                   int& nEdges,
@@ -74,22 +112,107 @@ namespace nina {
                                                   DegreeNodeSetVector& degreeVector,
                                                   double& LB)
     {
+      // If v dominates u, v is adjacent to all neighbors of u. A node that
+      // became dominated since the previous application was therefore
+      // modified itself or is two hops away from a modified dominator.
+      DenseNodeSetType candidates(g);
+      DenseNodeSetType isolated(g);
+      Node x;
+      while (nextDirty(g, x))
+      {
+        if (score[x] <= 0)
+        {
+          if (degree[x] == 0)
+            isolated.insert(x);
+          else
+            candidates.insert(x);
+        }
+        
+        const NeighborSet& neighbors_x = neighbors[x];
+        for (NeighborSetIt wIt = neighbors_x.begin(); wIt != neighbors_x.end(); ++wIt)
+        {
+          const NeighborSet& neighbors_w = neighbors[*wIt];
+          for (NeighborSetIt uIt = neighbors_w.begin(); uIt != neighbors_w.end(); ++uIt)
+          {
+            if (*uIt != x && score[*uIt] <= 0)
+              candidates.insert(*uIt);
+          }
+        }
+      }
+      
       NodeSet negHubsToRemove;
-      for (NodeIt u(g); u != lemon::INVALID; ++u)
+      if (!isolated.empty())
       {
-        if (score[u] > 0) continue;
+        Node maxNode = lemon::INVALID;
         for (NodeIt v(g); v != lemon::INVALID; ++v)
         {
+          if (maxNode == lemon::INVALID || score[v] > score[maxNode])
+            maxNode = v;
+        }
+        
+        // dominated by any node of higher score
+        for (DenseNodeSetIt uIt = isolated.begin(); uIt != isolated.end(); ++uIt)
+        {
+          if (score[*uIt] < score[maxNode])
+            negHubsToRemove.insert(*uIt);
+        }
+      }
+      
+      // fingerprints are computed on demand, 0 if not yet known
+      // (the fingerprint of a non-empty neighborhood is non-zero)
+      FingerprintNodeMap fingerprint(g, 0);
+      
+      // neighbors of the hubs ranked by degree and score, built on demand;
+      // degrees do not change until the dominated nodes are removed
+      IntNodeMap rankedIdx(g, -1);
+      NodeVectorVector ranked;
+      const Rank rank(degree, score);
+      
+      for (DenseNodeSetIt uIt = candidates.begin(); uIt != candidates.end(); ++uIt)
+      {
+        const Node u = *uIt;
+        const NeighborSet& neighbors_u = neighbors[u];
+        if (fingerprint[u] == 0)
+          fingerprint[u] = neighborhoodFingerprint(g, neighbors_u);
+        
+        // a dominating node v is adjacent to all neighbors of u,
+        // so it suffices to look at the neighbors of the neighbor of smallest degree
+        Node hub = *neighbors_u.begin();
+        for (NeighborSetIt hubIt = neighbors_u.begin(); hubIt != neighbors_u.end(); ++hubIt)
+        {
+          if (degree[*hubIt] < degree[hub])
+            hub = *hubIt;
+        }
+        
+        if (rankedIdx[hub] == -1)
+        {
+          rankedIdx[hub] = static_cast<int>(ranked.size());
+          ranked.push_back(NodeVector(neighbors[hub].begin(), neighbors[hub].end()));
+          std::sort(ranked.back().begin(), ranked.back().end(), rank);
+        }
+        
+        // v must have at least the degree of u, and a higher score if
+        // its degree is the same; the ranked list ends where neither holds
+        const NodeVector& candidates_u = ranked[rankedIdx[hub]];
+        for (NodeVectorIt nodeIt = candidates_u.begin(); nodeIt != candidates_u.end(); ++nodeIt)
+        {
+          Node v = *nodeIt;
+          if (degree[v] < degree[u]) break;
+          if (degree[v] == degree[u] && score[v] <= score[u]) break;
           if (u == v) continue;
-          //if (score[v] >= 0) continue; // not really needed, but the whole thing was too slow. did not help...
           if (score[u] >= score[v]) continue;
-          if (degree[u] > degree[v]) continue;
+          if (fingerprint[v] == 0)
+            fingerprint[v] = neighborhoodFingerprint(g, neighbors[v]);
+          if ((fingerprint[u] & ~fingerprint[v]) != 0) continue;
           
           // now check subset:
-          const NodeSet& neighbors_u = neighbors[u], neighbors_v = neighbors[v];
+          const NeighborSet& neighbors_v = neighbors[v];
           if (std::includes(neighbors_v.begin(), neighbors_v.end(),
                             neighbors_u.begin(), neighbors_u.end()))
+          {
             negHubsToRemove.insert(u);
+            break;
+          }
         }
       }
       
@@ -29,6 +29,8 @@ public:
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetMap NodeSetMap;
+  typedef typename Parent::NeighborSet NeighborSet;
+  typedef typename Parent::NeighborMap NeighborMap;
   typedef typename Parent::DegreeNodeMap DegreeNodeMap;
   typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
   typedef typename Parent::LabelNodeMap LabelNodeMap;
@@ -37,6 +39,7 @@ public:
 
   using Parent::remove;
   using Parent::merge;
+  using Parent::nextDirty;
 
   NegEdge();
   virtual ~NegEdge() {}
@@ -46,7 +49,7 @@ public:
                     WeightNodeMap& score,
                     NodeSetMap& mapToPre,
                     NodeSetMap& preOrigNodes,
-                    NodeSetMap& neighbors,
+                    NeighborMap& neighbors,
                     int& nNodes,
                     int& nArcs,
                     int& nEdges,
@@ -55,6 +58,8 @@ public:
                     double& LB);
 
   virtual std::string name() const { return "NegEdge"; }
+
+  virtual Parent* clone() const { return new NegEdge(); }
 };
 
 template<typename GR, typename WGHT>
@@ -70,7 +75,7 @@ inline int NegEdge<GR, WGHT>::apply(Graph& g,
                                     WeightNodeMap& score,
                                     NodeSetMap& mapToPre,
                                     NodeSetMap& preOrigNodes,
-                                    NodeSetMap& neighbors,
+                                    NeighborMap& neighbors,
                                     int& nNodes,
                                     int& nArcs,
                                     int& nEdges,
@@ -80,31 +85,28 @@ inline int NegEdge<GR, WGHT>::apply(Graph& g,
 {
   int res = 0;
 
-  for (EdgeIt e(g); e != lemon::INVALID; ++e)
+  Node v;
+  while (nextDirty(g, v))
   {
-    Node u = g.u(e);
-    Node v = g.v(e);
+    if (score[v] > 0 || degree[v] != 2)
+      continue;
+
+    // root nodes are never merged
+    if (rootNodes.find(v) != rootNodes.end())
+      continue;
 
-    if (score[u] <= 0 && score[v] <= 0 && degree[u] == 2 && degree[v] == 2)
+    for (IncEdgeIt e(g, v); e != lemon::INVALID; ++e)
     {
-      // don't merge if both u and v are root nodes
-      // otherwise ensure that root node is kept
-      if (rootNodes.find(u) == rootNodes.end() && rootNodes.find(v) == rootNodes.end())
+      Node u = g.oppositeNode(v, e);
+      if (score[u] <= 0 && degree[u] == 2 && rootNodes.find(u) == rootNodes.end())
       {
         res++;
         merge(g, label, score,
               mapToPre, preOrigNodes, neighbors,
               nNodes, nArcs, nEdges,
               degree, degreeVector, u, v, LB);
+        break;
       }
-//      else if (rootNodes.find(u) != rootNodes.end() && rootNodes.find(v) == rootNodes.end())
-//      {
-//        res++;
-//        merge(g, arcLookUp, label, score,
-//              mapToPre, preOrigNodes, neighbors,
-//              nNodes, nArcs, nEdges,
-//              degree, degreeVector, v, u, LB);
-//      }
     }
   }
 
@@ -8,6 +8,9 @@
 #ifndef NEGMIRROREDHUBS_H
 #define NEGMIRROREDHUBS_H
 
+#include <vector>
+#include <utility>
+#include <algorithm>
 #include "rule.h"
 
 namespace nina {
@@ -25,14 +28,23 @@ namespace nina {
       typedef typename Parent::NodeSet NodeSet;
       typedef typename Parent::NodeSetIt NodeSetIt;
       typedef typename Parent::NodeSetMap NodeSetMap;
+      typedef typename Parent::NeighborSet NeighborSet;
+      typedef typename Parent::NeighborMap NeighborMap;
       typedef typename Parent::DegreeNodeMap DegreeNodeMap;
       typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
       typedef typename Parent::LabelNodeMap LabelNodeMap;
+      typedef typename Parent::NeighborSetIt NeighborSetIt;
       
       TEMPLATE_GRAPH_TYPEDEFS(Graph);
       
+      typedef std::vector<Node> NodeVector;
+      typedef typename NodeVector::const_iterator NodeVectorIt;
+      typedef std::vector<std::pair<size_t, Node> > HashNodeVector;
+      
       using Parent::remove;
       using Parent::merge;
+      using Parent::consumeDirty;
+      using Parent::neighborhoodHash;
       
       NegMirroredHubs();
       virtual ~NegMirroredHubs() {}
@@ -42,7 +54,7 @@ namespace nina {
                         WeightNodeMap& score,
                         NodeSetMap& mapToPre,
                         NodeSetMap& preOrigNodes,
-                        NodeSetMap& neighbors,
+                        NeighborMap& neighbors,
                         int& nNodes,
                         int& nArcs,
                         int& nEdges,
@@ -51,6 +63,8 @@ namespace nina {
                         double& LB);
       
       virtual std::string name() const { return "NegMirroredHubs"; }
+
+      virtual Parent* clone() const { return new NegMirroredHubs(); }
     };
     
     template<typename GR, typename WGHT>
@@ -66,7 +80,7 @@ namespace nina {
                                                 WeightNodeMap& score,
                                                 NodeSetMap& mapToPre,
                                                 NodeSetMap& preOrigNodes,
-                                                NodeSetMap& neighbors,
+                                                NeighborMap& neighbors,
                                                 int& nNodes,
                                                 int& nArcs,
                                                 int& nEdges,
@@ -74,51 +88,64 @@ namespace nina {
                                                 DegreeNodeSetVector& degreeVector,
                                                 double& LB)
     {
-      typedef std::pair<double, Node> WeightNodePair;
-      typedef std::set<WeightNodePair> WeightNodePairSet;
-      typedef typename WeightNodePairSet::const_iterator WeightNodePairSetIt;
+      // mirrors are found from scratch by bucketing on neighborhood hashes
+      consumeDirty();
       
-      typedef std::pair<Node, Node> NodePair;
-      typedef std::map<NodePair, WeightNodePairSet> NodePairMap;
-      typedef typename NodePairMap::const_iterator NodePairMapIt;
+      HashNodeVector hubs;
+      for (NodeIt u(g); u != lemon::INVALID; ++u)
+      {
+        if (degree[u] < 3) continue;
+        if (score[u] > 0) continue;
+        hubs.push_back(std::make_pair(neighborhoodHash(g, neighbors[u]), u));
+      }
+      std::sort(hubs.begin(), hubs.end());
       
-      NodeSet negHubsToRemove;
-      for (size_t d = 3; d < degreeVector.size(); ++d)
+      NodeVector negHubsToRemove;
+      for (size_t i = 0; i < hubs.size();)
       {
-        const NodeSet& nodes = degreeVector[d];
-        if (nodes.size() > 1000) continue;
-        for (NodeSetIt nodeIt1 = nodes.begin(); nodeIt1 != nodes.end(); ++nodeIt1)
+        size_t j = i + 1;
+        while (j < hubs.size() && hubs[j].first == hubs[i].first)
+          ++j;
+        
+        // split the bucket [i, j) into classes of equal neighborhoods,
+        // processed nodes are invalidated
+        for (size_t k = i; k < j; ++k)
         {
-          Node u = *nodeIt1;
-          if (score[u] > 0) continue;
-          
-          const NodeSet& neighbors_u = neighbors[u];
+          Node u = hubs[k].second;
+          if (u == lemon::INVALID) continue;
           
-          for (NodeSetIt nodeIt2 = nodeIt1; nodeIt2 != nodes.end(); ++nodeIt2)
+          const NeighborSet& neighbors_u = neighbors[u];
+          NodeVector mirrors(1, u);
+          for (size_t l = k + 1; l < j; ++l)
           {
-            Node v = *nodeIt2;
-            if (u == v) continue;
-            if (score[v] > 0) continue; // we could also comment this out
-            
-            if (neighbors_u == neighbors[v])
+            Node v = hubs[l].second;
+            if (v != lemon::INVALID && neighbors_u == neighbors[v])
             {
-              // either u or v needs to go
-              if (score[u] < score[v])
-                negHubsToRemove.insert(u);
-              else
-                negHubsToRemove.insert(v);
+              mirrors.push_back(v);
+              hubs[l].second = lemon::INVALID;
             }
           }
+          if (mirrors.size() == 1) continue;
+          
+          // keep the mirror of highest score (the first one in case of ties)
+          Node best = u;
+          for (NodeVectorIt nodeIt = mirrors.begin(); nodeIt != mirrors.end(); ++nodeIt)
+          {
+            if (score[*nodeIt] > score[best])
+              best = *nodeIt;
+          }
+          for (NodeVectorIt nodeIt = mirrors.begin(); nodeIt != mirrors.end(); ++nodeIt)
+          {
+            // only remove if not a root node
+            if (*nodeIt != best && rootNodes.find(*nodeIt) == rootNodes.end())
+              negHubsToRemove.push_back(*nodeIt);
+          }
         }
+        
+        i = j;
       }
       
-      for (NodeSetIt nodeIt = rootNodes.begin(); nodeIt != rootNodes.end(); ++nodeIt)
-      {
-        // only remove if v is not a root node
-        negHubsToRemove.erase(*nodeIt);
-      }
-      
-      for (NodeSetIt nodeIt = negHubsToRemove.begin();
+      for (NodeVectorIt nodeIt = negHubsToRemove.begin();
            nodeIt != negHubsToRemove.end(); ++nodeIt)
       {
         Node v = *nodeIt;
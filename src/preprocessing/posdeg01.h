@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <limits>
 #include "rule.h"
 
 namespace nina {
@@ -29,6 +30,8 @@ public:
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetMap NodeSetMap;
+  typedef typename Parent::NeighborSet NeighborSet;
+  typedef typename Parent::NeighborMap NeighborMap;
   typedef typename Parent::DegreeNodeMap DegreeNodeMap;
   typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
   typedef typename Parent::LabelNodeMap LabelNodeMap;
@@ -38,6 +41,8 @@ public:
   using Parent::remove;
   using Parent::merge;
   using Parent::extract;
+  using Parent::markDirty;
+  using Parent::nextDirty;
 
   PosDeg01();
   virtual ~PosDeg01() {}
@@ -47,7 +52,7 @@ public:
                     WeightNodeMap& score,
                     NodeSetMap& mapToPre,
                     NodeSetMap& preOrigNodes,
-                    NodeSetMap& neighbors,
+                    NeighborMap& neighbors,
                     int& nNodes,
                     int& nArcs,
                     int& nEdges,
@@ -56,11 +61,18 @@ public:
                     double& LB);
 
   virtual std::string name() const { return "PosDeg01"; }
+
+  virtual Parent* clone() const { return new PosDeg01(); }
+
+private:
+  /// LB at the time positive degree 0 nodes were last marked dirty
+  double _LB;
 };
 
 template<typename GR, typename WGHT>
 inline PosDeg01<GR, WGHT>::PosDeg01()
   : Parent()
+  , _LB(-std::numeric_limits<double>::max())
 {
 }
 
@@ -71,7 +83,7 @@ inline int PosDeg01<GR, WGHT>::apply(Graph& g,
                                      WeightNodeMap& score,
                                      NodeSetMap& mapToPre,
                                      NodeSetMap& preOrigNodes,
-                                     NodeSetMap& neighbors,
+                                     NeighborMap& neighbors,
                                      int& nNodes,
                                      int& nArcs,
                                      int& nEdges,
@@ -79,39 +91,44 @@ inline int PosDeg01<GR, WGHT>::apply(Graph& g,
                                      DegreeNodeSetVector& degreeVector,
                                      double& LB)
 {
-  if (degreeVector.size() == 0)
-  {
-    // nothing to remove, there are no degree 0 nodes
-    return 0;
-  }
-  
-  // positive deg 0 nodes smaller than LB are to be removed
-  const NodeSet& nodes0 = degreeVector[0];
-  for (NodeSetIt nodeIt = nodes0.begin(); nodeIt != nodes0.end(); ++nodeIt)
+  int res = 0;
+
+  Node v;
+  while (true)
   {
-    Node v = *nodeIt;
-    if (0 <= score[v] && score[v] < LB && rootNodes.find(v) == rootNodes.end())
+    if (_LB != LB)
     {
-      assert(IncEdgeIt(g, v) == lemon::INVALID);
-      remove(g, mapToPre, preOrigNodes, neighbors,
-             nNodes, nArcs, nEdges,
-             degree, degreeVector, v);
-      return 1;
+      // positive deg 0 nodes that were kept may now be smaller than LB
+      _LB = LB;
+      if (!degreeVector.empty())
+      {
+        const NodeSet& nodes0 = degreeVector[0];
+        for (NodeSetIt nodeIt = nodes0.begin(); nodeIt != nodes0.end(); ++nodeIt)
+        {
+          markDirty(*nodeIt);
+        }
+      }
     }
-  }
-  
-  if (degreeVector.size() <= 1)
-  {
-    // nothing to remove, there are no degree 1 nodes
-    return 0;
-  }
-  
-  const NodeSet& nodes1 = degreeVector[1];
-  for (NodeSetIt nodeIt = nodes1.begin(); nodeIt != nodes1.end(); ++nodeIt)
-  {
-    Node v = *nodeIt;
-    
-    if (score[v] >= 0 && rootNodes.find(v) == rootNodes.end())
+
+    if (!nextDirty(g, v))
+      break;
+
+    if (score[v] < 0 || rootNodes.find(v) != rootNodes.end())
+      continue;
+
+    if (degree[v] == 0)
+    {
+      // positive deg 0 nodes smaller than LB are to be removed
+      if (score[v] < LB)
+      {
+        assert(IncEdgeIt(g, v) == lemon::INVALID);
+        remove(g, mapToPre, preOrigNodes, neighbors,
+               nNodes, nArcs, nEdges,
+               degree, degreeVector, v);
+        ++res;
+      }
+    }
+    else if (degree[v] == 1)
     {
       if (score[v] >= LB && rootNodes.empty())
       {
@@ -120,20 +137,19 @@ inline int PosDeg01<GR, WGHT>::apply(Graph& g,
                 nNodes, nArcs, nEdges,
                 degree, degreeVector, v);
       }
-        
+
       Node u = g.oppositeNode(v, IncEdgeIt(g, v));
-      
+
       // u may be a root node, that's why we should keep it!
       merge(g, label, score,
             mapToPre, preOrigNodes, neighbors,
             nNodes, nArcs, nEdges,
             degree, degreeVector, v, u, LB);
-
-      return 1;
+      ++res;
     }
   }
 
-  return 0;
+  return res;
 }
 
 } // namespace mwcs
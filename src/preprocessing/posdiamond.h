@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <algorithm>
 #include "rule.h"
 
 namespace nina {
@@ -29,6 +30,8 @@ public:
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetMap NodeSetMap;
+  typedef typename Parent::NeighborSet NeighborSet;
+  typedef typename Parent::NeighborMap NeighborMap;
   typedef typename Parent::DegreeNodeMap DegreeNodeMap;
   typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
   typedef typename Parent::LabelNodeMap LabelNodeMap;
@@ -37,6 +40,7 @@ public:
 
   using Parent::remove;
   using Parent::merge;
+  using Parent::nextDirty;
 
   PosDiamond();
   virtual ~PosDiamond() {}
@@ -46,7 +50,7 @@ public:
                     WeightNodeMap& score,
                     NodeSetMap& mapToPre,
                     NodeSetMap& preOrigNodes,
-                    NodeSetMap& neighbors,
+                    NeighborMap& neighbors,
                     int& nNodes,
                     int& nArcs,
                     int& nEdges,
@@ -55,6 +59,22 @@ public:
                     double& LB);
 
   virtual std::string name() const { return "PosDiamond"; }
+
+  virtual Parent* clone() const { return new PosDiamond(); }
+
+private:
+  typedef std::pair<Node, Node> NodePair;
+  typedef std::set<NodePair> NodePairSet;
+  typedef typename NodePairSet::const_iterator NodePairSetIt;
+
+  /// Returns whether v is a nonnegative degree 2 node with nonpositive
+  /// neighbors, if so u and w are its neighbors with u < w
+  bool isCenter(const Graph& g,
+                const WeightNodeMap& score,
+                const DegreeNodeMap& degree,
+                Node v,
+                Node& u,
+                Node& w) const;
 };
 
 template<typename GR, typename WGHT>
@@ -63,6 +83,28 @@ inline PosDiamond<GR, WGHT>::PosDiamond()
 {
 }
 
+template<typename GR, typename WGHT>
+inline bool PosDiamond<GR, WGHT>::isCenter(const Graph& g,
+                                           const WeightNodeMap& score,
+                                           const DegreeNodeMap& degree,
+                                           Node v,
+                                           Node& u,
+                                           Node& w) const
+{
+  if (degree[v] != 2 || score[v] < 0)
+    return false;
+
+  Edge e1 = IncEdgeIt(g, v);
+  Edge e2 = ++IncEdgeIt(g, v);
+
+  u = g.oppositeNode(v, e1);
+  w = g.oppositeNode(v, e2);
+  if (w < u)
+    std::swap(u, w);
+
+  return score[u] <= 0 && score[w] <= 0;
+}
+
 template<typename GR, typename WGHT>
 inline int PosDiamond<GR, WGHT>::apply(Graph& g,
                                        const NodeSet& rootNodes,
@@ -70,7 +112,7 @@ inline int PosDiamond<GR, WGHT>::apply(Graph& g,
                                        WeightNodeMap& score,
                                        NodeSetMap& mapToPre,
                                        NodeSetMap& preOrigNodes,
-                                       NodeSetMap& neighbors,
+                                       NeighborMap& neighbors,
                                        int& nNodes,
                                        int& nArcs,
                                        int& nEdges,
@@ -78,71 +120,53 @@ inline int PosDiamond<GR, WGHT>::apply(Graph& g,
                                        DegreeNodeSetVector& degreeVector,
                                        double& LB)
 {
-  typedef std::pair<double, Node> WeightNodePair;
-  typedef std::set<WeightNodePair> WeightNodePairSet;
-  typedef typename WeightNodePairSet::const_iterator WeightNodePairSetIt;
-  
-  typedef std::pair<Node, Node> NodePair;
-  typedef std::map<NodePair, WeightNodePairSet> NodePairMap;
-  typedef typename NodePairMap::const_iterator NodePairMapIt;
-
-  if (degreeVector.size() <= 2)
+  NodeSet dirtyNodes;
+  Node x;
+  while (nextDirty(g, x))
   {
-    // nothing to remove, there are no degree 2 nodes
-    return 0;
+    dirtyNodes.insert(x);
   }
-  
-  NodePairMap posMap;
-  const NodeSet& nodes = degreeVector[2];
-  for (NodeSetIt nodeIt = nodes.begin(); nodeIt != nodes.end(); ++nodeIt)
+
+  // a diamond (u, w) is affected by changes to its centers or to u and w
+  NodePairSet pairs;
+  for (NodeSetIt nodeIt = dirtyNodes.begin(); nodeIt != dirtyNodes.end(); ++nodeIt)
   {
-    Node v = *nodeIt;
-    
-    assert(degree[v] == 2);
-    Edge e1 = IncEdgeIt(g, v);
-    Edge e2 = ++IncEdgeIt(g, v);
-    
-    Node u = g.oppositeNode(v, e1);
-    Node w = g.oppositeNode(v, e2);
-    if (score[v] >= 0 && score[u] <= 0 && score[w] <= 0)
+    Node v = *nodeIt, u, w;
+    if (isCenter(g, score, degree, v, u, w))
     {
-      if (u < w)
-      {
-        posMap[std::make_pair(u, w)].insert(std::make_pair(score[v], v));
-      }
-      else
+      pairs.insert(std::make_pair(u, w));
+    }
+    else if (score[v] <= 0)
+    {
+      for (IncEdgeIt e(g, v); e != lemon::INVALID; ++e)
       {
-        posMap[std::make_pair(w, u)].insert(std::make_pair(score[v], v));
+        if (isCenter(g, score, degree, g.oppositeNode(v, e), u, w))
+        {
+          pairs.insert(std::make_pair(u, w));
+        }
       }
     }
   }
-  
+
   int res = 0;
-  for (NodePairMapIt it = posMap.begin(); it != posMap.end(); ++it)
+  for (NodePairSetIt it = pairs.begin(); it != pairs.end(); ++it)
   {
-    const WeightNodePairSet& set = it->second;
-    Node u = it->first.first;
-    Node w = it->first.second;
-    
-    int set_size = static_cast<int>(set.size());
-//    if (degree[u] == set_size && degree[w] != set_size
-//        && rootNodes.find(u) == rootNodes.end())
-//    {
-//      remove(g, comp, mapToPre, preOrigNodes, neighbors,
-//             nNodes, nArcs, nEdges, nComponents,
-//             degree, degreeVector, u);
-//      ++res;
-//    }
-//    else if (degree[u] != set_size && degree[w] == set_size
-//             && rootNodes.find(w) == rootNodes.end())
-//    {
-//      remove(g, comp, mapToPre, preOrigNodes, neighbors,
-//             nNodes, nArcs, nEdges, nComponents,
-//             degree, degreeVector, w);
-//      ++res;
-//    }
-//    else
-    if (degree[u] == set_size && degree[w] == set_size)
+    Node u = it->first;
+    Node w = it->second;
+
+    // u or w may have been removed while processing a previous pair
+    if (!g.valid(u) || !g.valid(w) || degree[u] != degree[w])
+      continue;
+
+    // all neighbors of u must be centers of the diamond, then so are those of w
+    bool diamond = true;
+    for (IncEdgeIt e(g, u); diamond && e != lemon::INVALID; ++e)
+    {
+      Node v = g.oppositeNode(u, e), uu, ww;
+      diamond = isCenter(g, score, degree, v, uu, ww) && uu == u && ww == w;
+    }
+
+    if (diamond)
     {
       if (score[u] < score[w] && rootNodes.find(u) == rootNodes.end())
       {
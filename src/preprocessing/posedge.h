@@ -29,6 +29,8 @@ public:
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetMap NodeSetMap;
+  typedef typename Parent::NeighborSet NeighborSet;
+  typedef typename Parent::NeighborMap NeighborMap;
   typedef typename Parent::DegreeNodeMap DegreeNodeMap;
   typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
   typedef typename Parent::LabelNodeMap LabelNodeMap;
@@ -37,6 +39,7 @@ public:
 
   using Parent::remove;
   using Parent::merge;
+  using Parent::nextDirty;
 
   PosEdge();
   virtual ~PosEdge() {}
@@ -46,7 +49,7 @@ public:
                     WeightNodeMap& score,
                     NodeSetMap& mapToPre,
                     NodeSetMap& preOrigNodes,
-                    NodeSetMap& neighbors,
+                    NeighborMap& neighbors,
                     int& nNodes,
                     int& nArcs,
                     int& nEdges,
@@ -55,6 +58,8 @@ public:
                     double& LB);
 
   virtual std::string name() const { return "PosEdge"; }
+
+  virtual Parent* clone() const { return new PosEdge(); }
 };
 
 template<typename GR, typename WGHT>
@@ -70,7 +75,7 @@ inline int PosEdge<GR, WGHT>::apply(Graph& g,
                                     WeightNodeMap& score,
                                     NodeSetMap& mapToPre,
                                     NodeSetMap& preOrigNodes,
-                                    NodeSetMap& neighbors,
+                                    NeighborMap& neighbors,
                                     int& nNodes,
                                     int& nArcs,
                                     int& nEdges,
@@ -78,23 +83,31 @@ inline int PosEdge<GR, WGHT>::apply(Graph& g,
                                     DegreeNodeSetVector& degreeVector,
                                     double& LB)
 {
-  for (EdgeIt e(g); e != lemon::INVALID; ++e)
+  int res = 0;
+
+  // merging keeps v and dirties it, so v is revisited
+  // until it has no more nonnegative neighbors
+  Node v;
+  while (nextDirty(g, v))
   {
-    Node u = g.u(e);
-    Node v = g.v(e);
+    if (score[v] < 0 || rootNodes.find(v) != rootNodes.end())
+      continue;
 
-    if (score[u] >= 0 && score[v] >= 0
-        && rootNodes.find(u) == rootNodes.end()
-        && rootNodes.find(v) == rootNodes.end())
+    for (IncEdgeIt e(g, v); e != lemon::INVALID; ++e)
     {
-      merge(g, label, score,
-            mapToPre, preOrigNodes, neighbors,
-            nNodes, nArcs, nEdges,
-            degree, degreeVector, u, v, LB);
-      return 1;
+      Node u = g.oppositeNode(v, e);
+      if (score[u] >= 0 && rootNodes.find(u) == rootNodes.end())
+      {
+        merge(g, label, score,
+              mapToPre, preOrigNodes, neighbors,
+              nNodes, nArcs, nEdges,
+              degree, degreeVector, u, v, LB);
+        ++res;
+        break;
+      }
     }
   }
-  return 0;
+  return res;
 }
 
 } // namespace mwcs
@@ -12,10 +12,51 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <assert.h>
+#include "nodeset.h"
 
 namespace nina {
 namespace mwcs {
 
+/// Nodes whose degree, neighborhood or score changed during preprocessing,
+/// in order of modification. A node may occur multiple times and may have
+/// been erased from the graph since it was logged.
+template<typename GR>
+class DirtyNodeLog
+{
+public:
+  typedef GR Graph;
+  typedef typename Graph::Node Node;
+
+  DirtyNodeLog()
+    : _nodes()
+  {
+  }
+
+  void mark(Node v)
+  {
+    _nodes.push_back(v);
+  }
+
+  size_t size() const
+  {
+    return _nodes.size();
+  }
+
+  Node operator[](size_t i) const
+  {
+    return _nodes[i];
+  }
+
+  void clear()
+  {
+    _nodes.clear();
+  }
+
+private:
+  std::vector<Node> _nodes;
+};
+
 template<typename GR,
          typename WGHT = typename GR::template NodeMap<double> >
 class Rule
@@ -33,9 +74,18 @@ public:
   typedef typename NodeSet::iterator NodeSetIt;
   typedef typename Graph::template NodeMap<NodeSet> NodeSetMap;
   typedef typename std::vector<NodeSet> DegreeNodeSetVector;
+  typedef FlatNodeSet<Node> NeighborSet;
+  typedef typename NeighborSet::const_iterator NeighborSetIt;
+  typedef typename Graph::template NodeMap<NeighborSet> NeighborMap;
+  typedef DirtyNodeLog<Graph> DirtyNodeLogType;
 
 public:
   Rule()
+    : _pDirty(NULL)
+    , _cursor(0)
+    , _nApplied(0)
+    , _nRemovedNodes(0)
+    , _time(0)
   {
   }
   
@@ -49,7 +99,7 @@ public:
                     WeightNodeMap& score,
                     NodeSetMap& mapToPre,
                     NodeSetMap& preOrigNodes,
-                    NodeSetMap& neighbors,
+                    NeighborMap& neighbors,
                     int& nNodes,
                     int& nArcs,
                     int& nEdges,
@@ -59,11 +109,116 @@ public:
   
   virtual std::string name() const = 0;
   
+  /// Returns a new instance of the rule, such that
+  /// several graphs can be preprocessed concurrently
+  virtual Rule* clone() const = 0;
+  
+  /// Attaches the log of modified nodes, all nodes logged so far
+  /// are considered dirty by this rule
+  void setDirtyNodeLog(DirtyNodeLogType* pDirty)
+  {
+    _pDirty = pDirty;
+    _cursor = 0;
+  }
+  
+  /// Returns whether nodes were modified since the rule last consumed the log,
+  /// if not applying the rule has no effect
+  bool isDirty() const
+  {
+    return _pDirty == NULL || _cursor < _pDirty->size();
+  }
+  
+  void resetStatistics()
+  {
+    _nApplied = _nRemovedNodes = 0;
+    _time = 0;
+  }
+  
+  void addStatistics(int removedNodes, double time)
+  {
+    ++_nApplied;
+    _nRemovedNodes += removedNodes;
+    _time += time;
+  }
+  
+  void addStatistics(const Rule& other)
+  {
+    _nApplied += other._nApplied;
+    _nRemovedNodes += other._nRemovedNodes;
+    _time += other._time;
+  }
+  
+  int getApplied() const { return _nApplied; }
+  int getRemovedNodes() const { return _nRemovedNodes; }
+  double getTime() const { return _time; }
+  
 protected:
+  void markDirty(Node node)
+  {
+    if (_pDirty)
+      _pDirty->mark(node);
+  }
+  
+  void markNeighborhoodDirty(const NeighborMap& neighbors, Node node)
+  {
+    markDirty(node);
+    const NeighborSet& neighborSet = neighbors[node];
+    for (NeighborSetIt nodeIt = neighborSet.begin(); nodeIt != neighborSet.end(); ++nodeIt)
+    {
+      markDirty(*nodeIt);
+    }
+  }
+  
+  /// Retrieves the next dirty node that is still in \c g.
+  /// Nodes logged while iterating are visited as well.
+  bool nextDirty(const Graph& g, Node& node)
+  {
+    assert(_pDirty);
+    while (_cursor < _pDirty->size())
+    {
+      node = (*_pDirty)[_cursor++];
+      if (g.valid(node))
+        return true;
+    }
+    return false;
+  }
+  
+  /// Marks all logged nodes as processed, for rules that rescan the graph
+  void consumeDirty()
+  {
+    if (_pDirty)
+      _cursor = _pDirty->size();
+  }
+
+  /// Hash of a neighborhood; equal neighborhoods have equal hashes
+  static size_t neighborhoodHash(const Graph& g, const NeighborSet& neighborSet)
+  {
+    size_t h = neighborSet.size();
+    for (NeighborSetIt nodeIt = neighborSet.begin(); nodeIt != neighborSet.end(); ++nodeIt)
+    {
+      h ^= static_cast<size_t>(g.id(*nodeIt)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    return h;
+  }
+
+  /// 64-bit fingerprint of a neighborhood, with one bit set per neighbor.
+  /// If N(u) is a subset of N(v), then the bits of u are a subset of those of v.
+  static unsigned long long neighborhoodFingerprint(const Graph& g,
+                                                    const NeighborSet& neighborSet)
+  {
+    unsigned long long fingerprint = 0;
+    for (NeighborSetIt nodeIt = neighborSet.begin(); nodeIt != neighborSet.end(); ++nodeIt)
+    {
+      unsigned long long id = static_cast<unsigned long long>(g.id(*nodeIt));
+      fingerprint |= 1ULL << ((id * 0x9e3779b97f4a7c15ULL) >> 58);
+    }
+    return fingerprint;
+  }
+
   void remove(Graph& g,
               NodeSetMap& mapToPre,
               NodeSetMap& preOrigNodes,
-              NodeSetMap& neighbors,
+              NeighborMap& neighbors,
               int& nNodes,
               int& nArcs,
               int& nEdges,
@@ -79,6 +234,7 @@ protected:
       degreeVector[d].erase(adjNode);
       degreeVector[d-1].insert(adjNode);
       neighbors[adjNode].erase(node);
+      markDirty(adjNode);
       
       nEdges--;
       nArcs -= 2;
@@ -107,7 +263,7 @@ protected:
                WeightNodeMap& score,
                NodeSetMap& mapToPre,
                NodeSetMap& preOrigNodes,
-               NodeSetMap& neighbors,
+               NeighborMap& neighbors,
                int& nNodes,
                int& nArcs,
                int& nEdges,
@@ -133,6 +289,7 @@ protected:
     }
 
     degreeVector[0].insert(newNode);
+    markDirty(newNode);
     
 //    assert(isValid(g, mapToPre, preOrigNodes, neighbors, nNodes, nArcs, nEdges, degree, degreeVector));
     return newNode;
@@ -143,7 +300,7 @@ protected:
              WeightNodeMap& score,
              NodeSetMap& mapToPre,
              NodeSetMap& preOrigNodes,
-             NodeSetMap& neighbors,
+             NeighborMap& neighbors,
              int& nNodes,
              int& nArcs,
              int& nEdges,
@@ -164,8 +321,8 @@ protected:
     degreeVector[degree[maxNode]].erase(maxNode);
     
     // now rewire the edges incident to minNode to maxNode
-    NodeSet& maxNodeNeighbors = neighbors[maxNode];
-    NodeSet& minNodeNeighbors = neighbors[minNode];
+    NeighborSet& maxNodeNeighbors = neighbors[maxNode];
+    NeighborSet& minNodeNeighbors = neighbors[minNode];
     
     minNodeNeighbors.erase(maxNode);
     maxNodeNeighbors.erase(minNode);
@@ -256,6 +413,9 @@ protected:
       LB = score[maxNode];
     }
     
+    // maxNode and its (new) neighbors need to be revisited
+    markNeighborhoodDirty(neighbors, maxNode);
+    
 #ifdef DEBUG
     int d2 = 0;
     for (IncEdgeIt e(g, maxNode); e != lemon::INVALID; ++e)
@@ -276,7 +436,7 @@ protected:
   bool isValid(Graph& g,
                NodeSetMap& mapToPre,
                NodeSetMap& preOrigNodes,
-               NodeSetMap& neighbors,
+               NeighborMap& neighbors,
                int& nNodes,
                int& nArcs,
                int& nEdges,
@@ -287,7 +447,7 @@ protected:
       return false;
     
     IntNodeMap newDeg(g, 0);
-    NodeSetMap newNeighbors(g);
+    NeighborMap newNeighbors(g);
     for (NodeIt v(g); v != lemon::INVALID; ++v)
     {
       for (IncEdgeIt e(g, v); e != lemon::INVALID; ++e)
@@ -314,6 +474,14 @@ protected:
     
     return true;
   }
+  
+private:
+  DirtyNodeLogType* _pDirty;
+  /// Position in the log up to which this rule has processed dirty nodes
+  size_t _cursor;
+  int _nApplied;
+  int _nRemovedNodes;
+  double _time;
 };
 
 } // namespace mwcs
@@ -9,12 +9,12 @@
 #define SHORTESTPATH_H
 
 #include <lemon/core.h>
-#include <lemon/adaptors.h>
-#include <lemon/dijkstra.h>
 #include <string>
 #include <vector>
 #include <set>
-#include <list>
+#include <algorithm>
+#include <utility>
+#include <limits>
 #include "rule.h"
 
 namespace nina {
@@ -32,6 +32,9 @@ public:
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetMap NodeSetMap;
+  typedef typename Parent::NeighborSet NeighborSet;
+  typedef typename Parent::NeighborMap NeighborMap;
+  typedef typename Parent::NeighborSetIt NeighborSetIt;
   typedef typename Parent::DegreeNodeMap DegreeNodeMap;
   typedef typename Parent::DegreeNodeSetVector DegreeNodeSetVector;
   typedef typename Parent::LabelNodeMap LabelNodeMap;
@@ -40,6 +43,7 @@ public:
 
   using Parent::remove;
   using Parent::merge;
+  using Parent::consumeDirty;
 
   ShortestPath();
   virtual ~ShortestPath() {}
@@ -49,7 +53,7 @@ public:
                     WeightNodeMap& score,
                     NodeSetMap& mapToPre,
                     NodeSetMap& preOrigNodes,
-                    NodeSetMap& neighbors,
+                    NeighborMap& neighbors,
                     int& nNodes,
                     int& nArcs,
                     int& nEdges,
@@ -58,67 +62,196 @@ public:
                     double& LB);
 
   virtual std::string name() const { return "ShortestPath"; }
+
+  virtual Parent* clone() const { return new ShortestPath(); }
   
 private:
-  typedef lemon::FilterNodes<const Graph, BoolNodeMap> SubGraph;
-  typedef typename SubGraph::Node SubNode;
-  typedef std::list<Node> NodeList;
-  typedef typename NodeList::const_iterator NodeListIt;
-  
-  double shortCircuit(SubGraph& g,
-                      const DoubleArcMap& arcCost,
-                      const WeightNodeMap& score,
-                      Node u,
-                      Node v,
-                      Node w,
-                      NodeList& path);
+  typedef std::vector<int> IntVector;
+  typedef IntVector::const_iterator IntVectorIt;
+  /// Node id of the source of the search and the degree 2 node to test
+  typedef std::pair<int, Node> Query;
+  typedef std::vector<Query> QueryVector;
+  typedef typename QueryVector::const_iterator QueryVectorIt;
+  
+  /// Tentative path from the source, identified by the first node on it
+  struct Label
+  {
+    double _dist;
+    int _hop;
+    /// Node id and label index of the predecessor, -1 for neighbors of the source
+    int _predNode;
+    int _predLabel;
+  };
+  typedef std::vector<Label> LabelVector;
+  
+  struct HeapEntry
+  {
+    int _node;
+    Label _label;
+    
+    // std::push_heap builds a max-heap
+    bool operator<(const HeapEntry& other) const
+    {
+      return _label._dist > other._label._dist;
+    }
+  };
+  typedef std::vector<HeapEntry> HeapEntryVector;
+  
+  /// Number of labels of every node id (at most two, with distinct hops)
+  IntVector _nLabels;
+  LabelVector _labels;
+  /// Node ids with labels, to be reset before the next search
+  IntVector _touched;
+  HeapEntryVector _heap;
+  
+  static double cost(const WeightNodeMap& score, Node v)
+  {
+    return score[v] > 0 ? 0 : -score[v];
+  }
+  
+  void push(int node, double dist, int hop, int predNode, int predLabel);
+  
+  void search(const Graph& g,
+              const WeightNodeMap& score,
+              const NeighborMap& neighbors,
+              Node source,
+              double bound);
+  
+  bool shortCircuit(const Graph& g,
+                    const WeightNodeMap& score,
+                    Node v,
+                    Node w) const;
 };
 
 template<typename GR, typename WGHT>
 inline ShortestPath<GR, WGHT>::ShortestPath()
   : Parent()
+  , _nLabels()
+  , _labels()
+  , _touched()
+  , _heap()
 {
 }
   
 template<typename GR, typename WGHT>
-inline double ShortestPath<GR, WGHT>::shortCircuit(SubGraph& g,
-                                                   const DoubleArcMap& arcCost,
-                                                   const WeightNodeMap& score,
-                                                   Node u,
-                                                   Node v,
-                                                   Node w,
-                                                   NodeList& path)
+inline void ShortestPath<GR, WGHT>::push(int node,
+                                         double dist,
+                                         int hop,
+                                         int predNode,
+                                         int predLabel)
 {
-  g.disable(v);
+  HeapEntry entry;
+  entry._node = node;
+  entry._label._dist = dist;
+  entry._label._hop = hop;
+  entry._label._predNode = predNode;
+  entry._label._predLabel = predLabel;
+  _heap.push_back(entry);
+  std::push_heap(_heap.begin(), _heap.end());
+}
+
+template<typename GR, typename WGHT>
+inline void ShortestPath<GR, WGHT>::search(const Graph& g,
+                                           const WeightNodeMap& score,
+                                           const NeighborMap& neighbors,
+                                           Node source,
+                                           double bound)
+{
+  // Dijkstra that keeps for every node the two shortest paths from source
+  // that leave source via distinct neighbors. A path through a degree 2
+  // neighbor v of source can only use v as its first node, so the shortest
+  // path avoiding v is given by a label whose hop differs from v.
+  for (IntVectorIt it = _touched.begin(); it != _touched.end(); ++it)
+  {
+    _nLabels[*it] = 0;
+  }
+  _touched.clear();
+  _heap.clear();
   
-  double pathLength = 0;
+  const size_t n = static_cast<size_t>(g.maxNodeId() + 1);
+  if (_nLabels.size() < n)
+  {
+    _nLabels.resize(n, 0);
+    _labels.resize(2 * n);
+  }
   
-  // and now let's do a Dijkstra
-  lemon::Dijkstra<SubGraph, DoubleArcMap> dijkstra(g, arcCost);
-  dijkstra.run(u);
+  const NeighborSet& sourceNeighbors = neighbors[source];
+  for (NeighborSetIt nodeIt = sourceNeighbors.begin(); nodeIt != sourceNeighbors.end(); ++nodeIt)
+  {
+    const int id = g.id(*nodeIt);
+    push(id, cost(score, *nodeIt), id, -1, -1);
+  }
   
-  if (!dijkstra.reached(w))
+  while (!_heap.empty())
   {
-    pathLength = -std::numeric_limits<double>::max();
+    std::pop_heap(_heap.begin(), _heap.end());
+    HeapEntry entry = _heap.back();
+    _heap.pop_back();
+    
+    // no query of this search can be satisfied by a longer path
+    if (entry._label._dist > bound)
+      break;
+    
+    int& nLabels = _nLabels[entry._node];
+    if (nLabels == 2)
+      continue;
+    if (nLabels == 1 && _labels[2 * entry._node]._hop == entry._label._hop)
+      continue;
+    if (nLabels == 0)
+      _touched.push_back(entry._node);
+    
+    const int labelIdx = nLabels++;
+    _labels[2 * entry._node + labelIdx] = entry._label;
+    
+    const NeighborSet& neighborSet = neighbors[g.nodeFromId(entry._node)];
+    for (NeighborSetIt nodeIt = neighborSet.begin(); nodeIt != neighborSet.end(); ++nodeIt)
+    {
+      Node x = *nodeIt;
+      if (x == source) continue;
+      
+      const int id = g.id(x);
+      if (_nLabels[id] == 2) continue;
+      push(id, entry._label._dist + cost(score, x),
+           entry._label._hop, entry._node, labelIdx);
+    }
   }
-  else
+}
+
+template<typename GR, typename WGHT>
+inline bool ShortestPath<GR, WGHT>::shortCircuit(const Graph& g,
+                                                 const WeightNodeMap& score,
+                                                 Node v,
+                                                 Node w) const
+{
+  // shortest path from the source of the last search to w avoiding v
+  const int idW = g.id(w);
+  const int idV = g.id(v);
+  int label = -1;
+  for (int i = 0; i < _nLabels[idW]; ++i)
   {
-    SubNode subNode = w;
-    while (dijkstra.predArc(subNode) != lemon::INVALID)
+    if (_labels[2 * idW + i]._hop != idV)
     {
-      subNode = dijkstra.predNode(subNode);
-      if (subNode != u)
-      {
-        path.push_front(subNode);
-        if (score[subNode] < 0)
-          pathLength += score[subNode];
-      }
+      label = i;
+      break;
     }
   }
+  if (label == -1)
+    return false;
   
-  g.enable(v);
+  // the path must still exist, as nodes may have been removed since the search
+  double pathLength = 0;
+  const Label* pLabel = &_labels[2 * idW + label];
+  while (pLabel->_predNode != -1)
+  {
+    Node x = g.nodeFromId(pLabel->_predNode);
+    if (!g.valid(x))
+      return false;
+    if (score[x] < 0)
+      pathLength += score[x];
+    pLabel = &_labels[2 * pLabel->_predNode + pLabel->_predLabel];
+  }
   
-  return pathLength;
+  return pathLength >= score[v];
 }
   
 template<typename GR, typename WGHT>
@@ -128,7 +261,7 @@ inline int ShortestPath<GR, WGHT>::apply(Graph& g,
                                          WeightNodeMap& score,
                                          NodeSetMap& mapToPre,
                                          NodeSetMap& preOrigNodes,
-                                         NodeSetMap& neighbors,
+                                         NeighborMap& neighbors,
                                          int& nNodes,
                                          int& nArcs,
                                          int& nEdges,
@@ -138,66 +271,89 @@ inline int ShortestPath<GR, WGHT>::apply(Graph& g,
 {
   int res = 0;
   
+  // a change anywhere in the graph may shorten a path,
+  // so all candidates are reconsidered
+  consumeDirty();
+  
   if (degreeVector.size() <= 2)
   {
     // nothing to remove, there are no degree 2 nodes
     return 0;
   }
-  else if (degreeVector[2].size() > 1000)
+  
+  // a non-positive degree 2 node v with neighbors u and w can be removed
+  // if there is a path from u to w avoiding v whose interior is at least as
+  // good as v. Queries are grouped by the neighbor that is shared by most
+  // degree 2 nodes, such that a single search answers all of them.
+  const NodeSet& deg2Nodes = degreeVector[2];
+  IntNodeMap nQueries(g, 0);
+  for (NodeSetIt nodeIt = deg2Nodes.begin(); nodeIt != deg2Nodes.end(); ++nodeIt)
   {
-    // too many nodes
-    return 0;
+    Node v = *nodeIt;
+    if (score[v] > 0 || rootNodes.find(v) != rootNodes.end()) continue;
+    
+    const NeighborSet& neighbors_v = neighbors[v];
+    ++nQueries[*neighbors_v.begin()];
+    ++nQueries[*(neighbors_v.begin() + 1)];
   }
   
-  // let's construct the arc costs
-  DoubleArcMap arcCost(g);
-  for (ArcIt a(g); a != lemon::INVALID; ++a)
+  QueryVector queries;
+  for (NodeSetIt nodeIt = deg2Nodes.begin(); nodeIt != deg2Nodes.end(); ++nodeIt)
   {
-    arcCost[a] = score[g.target(a)] > 0 ? 0 : -score[g.target(a)];
-    assert(arcCost[a] >= 0);
+    Node v = *nodeIt;
+    if (score[v] > 0 || rootNodes.find(v) != rootNodes.end()) continue;
+    
+    const NeighborSet& neighbors_v = neighbors[v];
+    Node u = *neighbors_v.begin();
+    Node w = *(neighbors_v.begin() + 1);
+    queries.push_back(std::make_pair(nQueries[w] > nQueries[u] ? g.id(w) : g.id(u), v));
   }
-
-  BoolNodeMap filter(g, true);
-  SubGraph subG(g, filter);
+  std::sort(queries.begin(), queries.end());
   
-  for (NodeIt v(g); v != lemon::INVALID;)
+  for (QueryVectorIt queryIt = queries.begin(); queryIt != queries.end();)
   {
-    if (degree[v] == 2 && score[v] <= 0 && rootNodes.find(v) == rootNodes.end())
+    const int sourceId = queryIt->first;
+    Node u = g.nodeFromId(sourceId);
+    
+    QueryVectorIt groupEnd = queryIt;
+    while (groupEnd != queries.end() && groupEnd->first == sourceId)
+      ++groupEnd;
+    
+    // u, v or w may have been removed by an earlier query
+    if (!g.valid(u))
     {
-      Edge e1 = IncEdgeIt(g, v);
-      Edge e2 = ++IncEdgeIt(g, v);
-      
-      Node u = g.oppositeNode(v, e1);
-      Node w = g.oppositeNode(v, e2);
-      
-      NodeList path;
-      double pathLength = shortCircuit(subG, arcCost, score, u, v, w, path);
+      queryIt = groupEnd;
+      continue;
+    }
+    
+    // the search can stop once no query of this source can be satisfied
+    double bound = -std::numeric_limits<double>::max();
+    for (QueryVectorIt it = queryIt; it != groupEnd; ++it)
+    {
+      Node v = it->second;
+      if (!g.valid(v) || degree[v] != 2) continue;
+      const NeighborSet& neighbors_v = neighbors[v];
+      Node w = *neighbors_v.begin() == u ? *(neighbors_v.begin() + 1) : *neighbors_v.begin();
+      bound = std::max(bound, cost(score, w) - score[v]);
+    }
+    
+    search(g, score, neighbors, u, bound);
+    
+    for (; queryIt != groupEnd; ++queryIt)
+    {
+      Node v = queryIt->second;
+      if (!g.valid(v) || degree[v] != 2 || !g.valid(u)) continue;
+      const NeighborSet& neighbors_v = neighbors[v];
+      if (neighbors_v.find(u) == neighbors_v.end()) continue;
+      Node w = *neighbors_v.begin() == u ? *(neighbors_v.begin() + 1) : *neighbors_v.begin();
       
-      if (pathLength >= score[v])
+      if (shortCircuit(g, score, v, w))
       {
-//          std::cout << label[v] << " ( " << score[v] << " ) : "
-//                    << label[u] << " (" << score[u] << ")";
-//          for (NodeListIt nodeIt = path.begin(); nodeIt != path.end(); ++nodeIt)
-//          {
-//            std::cout << " -- " << label[*nodeIt] << " (" << score[*nodeIt] << ")";
-//          }
-//          std::cout << " -- " << label[w] << " (" << score[w] << ")" << std::endl;
-        
-        Node curV = v;
-        ++v;
         remove(g, mapToPre, preOrigNodes, neighbors,
                nNodes, nArcs, nEdges,
-               degree, degreeVector, curV);
+               degree, degreeVector, v);
         ++res;
       }
-      else
-      {
-        ++v;
-      }
-    }
-    else
-    {
-      ++v;
     }
   }
   
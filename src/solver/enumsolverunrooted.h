@@ -58,6 +58,7 @@ public:
   using Parent::_scoreUB;
   using Parent::_pSolutionMap;
   using Parent::_solutionSet;
+  using Parent::_startLabels;
   using Parent::_pImpl;
 
 public:
@@ -227,6 +228,26 @@ private:
     mwcsSubGraph.init(&subG, &labelSubG, &weightSubG, NULL);
   }
 
+  /// Adds the labels of the start nodes of mwcsGraph selected by filter,
+  /// these become the original labels of the local graph induced by filter
+  void extendStartLabels(const MwcsGraphType& mwcsGraph,
+                         const BoolNodeMap& filter)
+  {
+    if (_startLabels.empty())
+    {
+      return;
+    }
+    
+    const Graph& g = mwcsGraph.getGraph();
+    for (NodeIt v(g); v != lemon::INVALID; ++v)
+    {
+      if (filter[v] && SolverUnrootedImplType::isStartNode(mwcsGraph, v, _startLabels))
+      {
+        _startLabels.insert(mwcsGraph.getLabel(v));
+      }
+    }
+  }
+
   void printNodeSet(const MwcsGraphType& mwcsGraph,
                     const NodeSet& nodeSet) const
   {
@@ -278,6 +299,9 @@ inline bool EnumSolverUnrooted<GR, WGHT, NLBL, EWGHT>::solve(const MwcsGraphType
   const Graph& g = mwcsGraph.getGraph();
   BoolNodeMap allowedNodesSameComp(g);
 
+  _pImpl->setStartLabels(_startLabels.empty() ? NULL : &_startLabels);
+  _pRootedImpl->setStartLabels(_startLabels.empty() ? NULL : &_startLabels);
+
   // 1. iterate over the components
   int nComponents = mwcsGraph.getComponentCount();
   const IntNodeMap& comp = mwcsGraph.getComponentMap();
@@ -297,6 +321,7 @@ inline bool EnumSolverUnrooted<GR, WGHT, NLBL, EWGHT>::solve(const MwcsGraphType
     MwcsPreGraphType mwcsSubGraph;
 
     // 2b. create subgraph
+    extendStartLabels(mwcsGraph, allowedNodesSameComp);
     initLocalGraph(g,
                    mwcsGraph.getScores(),
                    mwcsGraph.getLabels(),
@@ -417,6 +442,7 @@ inline bool EnumSolverUnrooted<GR, WGHT, NLBL, EWGHT>::solveComponent(MwcsPreGra
             sameBlock[*nodeIt] = true;
           }
 
+          extendStartLabels(mwcsGraph, sameBlock);
           initLocalGraph(g,
                          mwcsGraph.getScores(),
                          mwcsGraph.getLabels(),
@@ -753,6 +779,7 @@ inline bool EnumSolverUnrooted<GR, WGHT, NLBL, EWGHT>::solveTriComp(MwcsPreGraph
 
   assert(orgC == lemon::INVALID || !sameTriComp[orgC]);
 
+  extendStartLabels(mwcsGraph, sameTriComp);
   initLocalGraph(g,
                  mwcsGraph.getScores(),
                  mwcsGraph.getLabels(),
@@ -0,0 +1,174 @@
+/*
+ * callbackstats.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef CALLBACKSTATS_H
+#define CALLBACKSTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+namespace nina {
+namespace mwcs {
+
+/// \brief Statistics of the CPLEX callbacks, aggregated per callback type
+///
+/// Counters are atomic, so all threads update the same instance without
+/// locking. Nothing is recorded unless the statistics are enabled.
+class CallbackStats
+{
+public:
+  typedef enum {
+                 LAZY_CONSTRAINT = 0,
+                 USER_CUT,
+                 HEURISTIC,
+                 INCUMBENT,
+                 N_CALLBACK_TYPES
+               } CallbackType;
+
+  /// Measures the wall time of a callback invocation
+  class Scope
+  {
+  public:
+    Scope(CallbackStats& stats, CallbackType type)
+      : _stats(stats)
+      , _type(type)
+      , _start()
+    {
+      if (_stats.enabled())
+        _start = Clock::now();
+    }
+
+    ~Scope()
+    {
+      if (_stats.enabled())
+        _stats.addCall(_type, Clock::now() - _start);
+    }
+
+  private:
+    CallbackStats& _stats;
+    const CallbackType _type;
+    std::chrono::steady_clock::time_point _start;
+
+    Scope(const Scope&);
+    void operator=(const Scope&);
+  };
+
+  CallbackStats()
+    : _enabled(false)
+  {
+    reset();
+  }
+
+  bool enabled() const
+  {
+    return _enabled;
+  }
+
+  /// Enables the statistics, must not be called during a solve
+  void enable(bool enabled)
+  {
+    _enabled = enabled;
+  }
+
+  void reset()
+  {
+    for (int t = 0; t < N_CALLBACK_TYPES; ++t)
+    {
+      _counters[t]._calls = 0;
+      _counters[t]._nanoseconds = 0;
+      _counters[t]._cuts = 0;
+      _counters[t]._maxFlows = 0;
+      _counters[t]._improvements = 0;
+    }
+  }
+
+  void addCuts(CallbackType type, int nCuts)
+  {
+    if (_enabled)
+      _counters[type]._cuts.fetch_add(nCuts, std::memory_order_relaxed);
+  }
+
+  void addMaxFlows(CallbackType type, int nMaxFlows)
+  {
+    if (_enabled)
+      _counters[type]._maxFlows.fetch_add(nMaxFlows, std::memory_order_relaxed);
+  }
+
+  void addImprovement(CallbackType type)
+  {
+    if (_enabled)
+      _counters[type]._improvements.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Writes the statistics as a JSON object, times are in seconds
+  void writeJson(std::ostream& out) const
+  {
+    static const char* names[N_CALLBACK_TYPES] = {
+      "lazy_constraint", "user_cut", "heuristic", "incumbent"
+    };
+
+    out << "{" << std::endl;
+    for (int t = 0; t < N_CALLBACK_TYPES; ++t)
+    {
+      const Counters& c = _counters[t];
+      out << "  \"" << names[t] << "\": {"
+          << "\"calls\": " << c._calls.load()
+          << ", \"time\": " << c._nanoseconds.load() * 1e-9
+          << ", \"cuts\": " << c._cuts.load()
+          << ", \"max_flows\": " << c._maxFlows.load()
+          << ", \"improvements\": " << c._improvements.load()
+          << "}" << (t + 1 < N_CALLBACK_TYPES ? "," : "") << std::endl;
+    }
+    out << "}" << std::endl;
+  }
+
+  /// Writes the statistics to \c filename, returns false if that fails
+  bool writeJson(const std::string& filename) const
+  {
+    std::ofstream out(filename.c_str());
+    if (!out.good())
+      return false;
+
+    writeJson(out);
+    return out.good();
+  }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Counters
+  {
+    std::atomic<long long> _calls;
+    std::atomic<long long> _nanoseconds;
+    std::atomic<long long> _cuts;
+    std::atomic<long long> _maxFlows;
+    std::atomic<long long> _improvements;
+  };
+
+  bool _enabled;
+  Counters _counters[N_CALLBACK_TYPES];
+
+  void addCall(CallbackType type, Clock::duration duration)
+  {
+    _counters[type]._calls.fetch_add(1, std::memory_order_relaxed);
+    _counters[type]._nanoseconds.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+      std::memory_order_relaxed);
+  }
+
+  CallbackStats(const CallbackStats&);
+  void operator=(const CallbackStats&);
+};
+
+extern CallbackStats g_callbackStats;
+
+} // namespace mwcs
+} // namespace nina
+
+#endif // CALLBACKSTATS_H
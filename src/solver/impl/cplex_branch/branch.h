@@ -11,11 +11,22 @@
 #include <ilcplex/ilocplex.h>
 #include <ilcplex/ilocplexi.h>
 #include <lemon/core.h>
-#include <set>
+#include <lemon/tolerance.h>
+#include <algorithm>
+#include <vector>
 
 namespace nina {
 namespace mwcs {
 
+/// \brief Branching on the root selection variables
+///
+/// As long as a y-variable is fractional, CPLEX's choice of branching
+/// variable is replaced by a fractional y-variable. Candidates are ranked
+/// by node weight and degree; among the first _lookahead fractional
+/// candidates the one with the best pseudo-cost product score is chosen,
+/// where ties (in particular pseudo-costs that are not yet initialized)
+/// are broken by rank. Once all y-variables are integral, the root is
+/// fixed and CPLEX branches as usual.
 template<typename GR,
          typename NWGHT = typename GR::template NodeMap<double>,
          typename NLBL = typename GR::template NodeMap<std::string>,
@@ -27,157 +38,135 @@ public:
   typedef NWGHT WeightNodeMap;
   typedef NLBL LabelNodeMap;
   typedef EWGHT WeightEdgeMap;
-  typedef NodeCut<GR, NWGHT, NLBL, EWGHT> Parent;
-  
+
 protected:
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
-  
+  typedef std::vector<int> IntVector;
+  typedef std::vector<double> DoubleVector;
+
 protected:
-  IloBoolVarArray _x;
-  const Graph& _g;
-  const WeightNodeMap& _weight;
-  const Node _root;
-  const IntNodeMap& _nodeMap;
+  IloBoolVarArray _y;
   const int _n;
-  const IntNodeMap& _deg;
-  const IntNodeMap& _posDeg;
+  /// Variable indices in order of decreasing weight, ties by decreasing degree
+  IntVector _order;
   const lemon::Tolerance<double> _tol;
 
+  /// Number of fractional candidates whose pseudo-costs are compared
+  static const int _lookahead = 4;
+
   // 1e-5 is the epsilon that CPLEX uses (for deciding integrality),
   // i.e. if |x| < 1e-5 it's considered to be 0 by CPLEX.
   // if 1 - |x| < 1e-5 it's considered to be 1 by CPLEX.
-  // we use the same epsilon to separate violated cuts.
-  static const double _epsilon = 1e-5;
-  
+  static constexpr double _epsilon = 1e-5;
+
 public:
   Branch(IloEnv env,
-         IloBoolVarArray x,
+         IloBoolVarArray y,
          const Graph& g,
          const WeightNodeMap& weight,
          const IntNodeMap& nodeMap,
-         int n,
-         const IntNodeMap& deg,
-         const IntNodeMap& posDeg)
+         int n)
     : IloCplex::BranchCallbackI(env)
-    , _x(x)
-    , _g(g)
-    , _weight(weight)
-    , _nodeMap(nodeMap)
+    , _y(y)
     , _n(n)
-    , _deg(deg)
-    , _posDeg(posDeg)
+    , _order(n)
     , _tol(_epsilon)
   {
+    DoubleVector score(n, 0);
+    IntVector deg(n, 0);
+    for (NodeIt i(g); i != lemon::INVALID; ++i)
+    {
+      const int idx_i = nodeMap[i];
+      _order[idx_i] = idx_i;
+      score[idx_i] = weight[i];
+      for (IncEdgeIt e(g, i); e != lemon::INVALID; ++e)
+      {
+        ++deg[idx_i];
+      }
+    }
+
+    std::stable_sort(_order.begin(), _order.end(), Rank(score, deg));
   }
-  
+
   Branch(const Branch& other)
     : IloCplex::BranchCallbackI(other)
-    , _x(other._x)
-    , _g(other._g)
-    , _weight(other._weight)
-    , _nodeMap(other._nodeMap)
+    , _y(other._y)
     , _n(other._n)
-    , _deg(other._deg)
-    , _posDeg(other._deg)
+    , _order(other._order)
     , _tol(other._tol)
   {
   }
-  
+
   virtual ~Branch()
   {
   }
-  
+
 protected:
+  struct Rank
+  {
+    Rank(const DoubleVector& score, const IntVector& deg)
+      : _score(score)
+      , _deg(deg)
+    {
+    }
+
+    bool operator()(int i, int j) const
+    {
+      if (_score[i] != _score[j])
+        return _score[i] > _score[j];
+      return _deg[i] > _deg[j];
+    }
+
+    const DoubleVector& _score;
+    const IntVector& _deg;
+  };
+
   void main()
   {
     if (getBranchType() != BranchOnVariable)
       return;
-    
-    // do some stuff here
-//    std::cout << "Hello, this is node " //  << this->getNodeId()
-//              << " and I'm about to create " << this->getNbranches()
-//              << " branches" << std::endl;
-
-    IloNumArray x_values(getEnv(), _n);
-    getValues(x_values, _x);
-    
-    // find a fractional node with heighest pos deg
-    Node branchOnMe = lemon::INVALID;
-    
-    std::set<Node> fracNodes;
-    for (NodeIt i(_g); i != lemon::INVALID; ++i) {
-      double x_i_value = x_values[_nodeMap[i]];
-      if (_tol.nonZero(x_i_value) && _tol.different(x_i_value, 1))
+
+    IloNumArray y_values(getEnv(), _n);
+    getValues(y_values, _y);
+
+    int branchOnMe = -1;
+    double bestScore = -1;
+    int nCandidates = 0;
+    for (int k = 0; k < _n && nCandidates < _lookahead; ++k)
+    {
+      const int idx = _order[k];
+      const double f = y_values[idx];
+      if (!_tol.nonZero(f) || !_tol.different(f, 1))
+        continue;
+
+      ++nCandidates;
+
+      // product rule on the pseudo-cost estimates of the two children
+      const double down = std::max(_tol.epsilon(), f * getDownPseudoCost(_y[idx]));
+      const double up = std::max(_tol.epsilon(), (1 - f) * getUpPseudoCost(_y[idx]));
+      if (down * up > bestScore)
       {
-        fracNodes.insert(i);
-//        std::cout << _x[_nodeMap[i]].getName() << " = " << x_i_value << ", deg: " << _deg[i] << ", posDeg: " << _posDeg[i] <<std::endl;
-        
-        if (branchOnMe == lemon::INVALID || _posDeg[i] > _posDeg[branchOnMe])
-        {
-          branchOnMe = i;
-        }
+        bestScore = down * up;
+        branchOnMe = idx;
       }
     }
-    
-    if (branchOnMe != lemon::INVALID)
-    {
-//      branch(branchOnMe);
-      std::cout << "Suggestion: " << _x[_nodeMap[branchOnMe]].getName() << ", posDeg: " << _posDeg[branchOnMe] << std::endl;
-    }
-    else
+
+    y_values.end();
+
+    if (branchOnMe != -1)
     {
-      std::cout << "Nothing found" << std::endl;
+      const double objValue = getObjValue();
+      makeBranch(_y[branchOnMe], 1, IloCplex::BranchUp, objValue);
+      makeBranch(_y[branchOnMe], 0, IloCplex::BranchDown, objValue);
     }
-    
-//    IloNumVarArray vars(this->getEnv());
-//    IloNumArray bounds(this->getEnv());
-//    IloCplex::BranchDirectionArray dirs(this->getEnv());
-//    
-//    for (int i = 0; i < this->getNbranches(); ++i)
-//    {
-//      vars.clear();
-//      bounds.clear();
-//      std::cout << "Branch " << i << std::endl;
-//      
-//      this->getBranch(vars, bounds, dirs, i);
-//      for (int j = 0; j < vars.getSize(); ++j)
-//      {
-//        std::cout << vars[j].getName() << " = " << bounds[j] << ", frac value: " << getValue(vars[j]) << std::endl;
-//      }
-//    }
-//    
-//    vars.end();
-//    bounds.end();
-//    dirs.end();
-//    x_values.end();
   }
-  
+
   IloCplex::CallbackI* duplicateCallback() const
   {
     return (new (getEnv()) Branch(*this));
   }
-  
-  void branch(Node i)
-  {
-    double obj_value = getObjValue();
-    // up
-    IloConstraintArray cons(getEnv());
-    cons.add(_x[_nodeMap[i]] == 1);
-    for (IncEdgeIt e(_g, i); e != lemon::INVALID; ++e)
-    {
-      Node j = _g.oppositeNode(i, e);
-      if (_weight[j] >= 0)
-      {
-        cons.add(_x[_nodeMap[j]] == 1);
-      }
-    }
-    makeBranch(cons, obj_value);
-    
-    // down
-    makeBranch(_x[_nodeMap[i]] == 0, obj_value);
-  }
 };
-  
+
 } // namespace mwcs
 } // namespace nina
 
@@ -8,6 +8,10 @@
 #ifndef BACKOFF_H
 #define BACKOFF_H
 
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
 namespace nina {
 namespace mwcs {
 
@@ -20,7 +24,8 @@ public:
     LinearWaiting,
     QuadraticWaiting,
     ExponentialWaiting,
-    InfiniteWaiting
+    InfiniteWaiting,
+    AdaptiveWaiting
   } Function;
   
   // constant waiting
@@ -29,6 +34,8 @@ public:
     , _period(0)
     , _attemptsSinceEvent(0)
     , _attemptsUntilNextEvent(period)
+    , _productive(true)
+    , _bounds()
   {
   }
   
@@ -37,6 +44,8 @@ public:
     , _period(0)
     , _attemptsSinceEvent(0)
     , _attemptsUntilNextEvent(1)
+    , _productive(true)
+    , _bounds()
   {
     assert(function != ConstantWaiting);
     updateWaitingPeriod();
@@ -48,6 +57,7 @@ public:
     {
       updateWaitingPeriod();
       _attemptsSinceEvent = 0;
+      _productive = false;
       return true;
     }
     
@@ -74,14 +84,85 @@ public:
       case InfiniteWaiting:
         _attemptsUntilNextEvent = -1;
         break;
+      case AdaptiveWaiting:
+        // separate at every node as long as separation pays off,
+        // otherwise double the waiting period
+        if (_productive)
+          _attemptsUntilNextEvent = 1;
+        else if (_attemptsUntilNextEvent < s_maxWaitingPeriod)
+          _attemptsUntilNextEvent *= 2;
+        break;
     }
   }
   
+  /// Whether the number of cut rounds per node is determined by
+  /// continueCutLoop() rather than by a fixed maximum
+  bool adaptive() const
+  {
+    return _function == AdaptiveWaiting;
+  }
+  
+  /// Starts the cut loop of a new node
+  void startNode()
+  {
+    _bounds.clear();
+  }
+  
+  /// Tailing-off detection: returns whether to do another cut round at the
+  /// current node, given the bound of the current LP and the number of cuts
+  /// added in the previous round. Only AdaptiveWaiting ever stops the loop.
+  bool continueCutLoop(double bound, int nCuts)
+  {
+    if (_function != AdaptiveWaiting)
+      return true;
+    
+    _bounds.push_back(bound);
+    
+    const int round = static_cast<int>(_bounds.size()) - 1;
+    if (round == 0)
+      return true;
+    
+    if (relImprovement(_bounds[round - 1], bound) > s_minImprovement)
+      _productive = true;
+    
+    // too few cuts in the previous round
+    if (nCuts < s_minCuts || round >= s_maxRounds)
+      return false;
+    
+    // too little progress over the last s_tailingOffRounds rounds
+    if (round >= s_tailingOffRounds
+        && relImprovement(_bounds[round - s_tailingOffRounds], bound)
+             < s_tailingOffRounds * s_minImprovement)
+      return false;
+    
+    return true;
+  }
+  
 private:
+  /// Minimum number of cuts of a round to keep separating
+  static const int s_minCuts = 2;
+  /// Number of rounds over which the bound improvement is measured
+  static const int s_tailingOffRounds = 3;
+  /// Maximum number of cut rounds per node
+  static const int s_maxRounds = 100;
+  /// Maximum number of nodes between two separation attempts
+  static const int s_maxWaitingPeriod = 64;
+  /// Minimum relative bound improvement per round
+  static constexpr double s_minImprovement = 1e-3;
+  
   Function _function;
   int _period;
   int _attemptsSinceEvent;
   int _attemptsUntilNextEvent;
+  /// Whether the bound improved at a node since the last attempt
+  bool _productive;
+  /// LP bounds of the cut rounds at the current node
+  std::vector<double> _bounds;
+  
+  static double relImprovement(double oldBound, double newBound)
+  {
+    return fabs(oldBound - newBound) / std::max(1.0, fabs(oldBound));
+  }
 
 };
   
@@ -11,8 +11,10 @@
 #define BK_ALG_H
 
 #include <lemon/core.h>
+#include <algorithm>
 #include <limits>
 #include <ostream>
+#include <vector>
 #include <maxflow-v3.01/graph.h>
 
 namespace nina {
@@ -25,6 +27,7 @@ public:
 
   TEMPLATE_DIGRAPH_TYPEDEFS(Digraph);
   typedef DoubleArcMap CapacityMap;
+  typedef std::vector<Node> NodeVector;
 
   BkFlowAlg(const Digraph& g,
             const CapacityMap& cap)
@@ -36,6 +39,9 @@ public:
     , _bkArc(_g, NULL)
     , _pBK(NULL)
     , _flow()
+    , _bkFlow(0)
+    , _flowOffset(0)
+    , _supplyNodes()
   {
     lemon::mapCopy(_g, cap, _cap);
     init();
@@ -51,6 +57,9 @@ public:
   double resCap(Arc a) const;
   double revResCap(Arc a) const;
   double cap(Arc a) const;
+  /// Computes a maximum flow from the source to the target. If \c reuse,
+  /// the flow and the search trees of the previous run are kept; this is
+  /// valid after setTarget(target, true) and incCap().
   double run(bool reuse = false);
   double flow(Arc a) const;
   bool cut(Arc a) const;
@@ -59,7 +68,14 @@ public:
   Node getSource() const { return _source; }
   Node getTarget() const { return _target; }
   void setSource(Node source, bool mark = false);
-  void setTarget(Node target, bool mark = false);
+  /// Sets the target. If \c reuse, the flow into the previous target is
+  /// left in place and the previous target becomes a supply node, so the
+  /// next run(true) continues from the current flow.
+  void setTarget(Node target, bool reuse = false);
+  /// Previous targets of reused runs, those with a remaining supply
+  /// are on the source side of the minimum cut
+  const NodeVector& getSupplyNodes() const { return _supplyNodes; }
+  double supply(Node v) const;
 
   void printFlow(std::ostream& out, bool cutOnly = false) const;
   void printCut(std::ostream& out) const;
@@ -80,6 +96,11 @@ private:
 
   BkGraphType* _pBK;
   double _flow;
+  /// Total flow as counted by _pBK, which includes the flow into previous
+  /// targets when runs are reused
+  double _bkFlow;
+  double _flowOffset;
+  NodeVector _supplyNodes;
 
   void init();
 };
@@ -130,7 +151,13 @@ void BkFlowAlg<DGR>::init()
 template<typename DGR>
 double BkFlowAlg<DGR>::run(bool reuse)
 {
-  _flow = _pBK->maxflow(reuse);
+  // without reuse _pBK starts counting from zero
+  // and supply nodes act as sources right away
+  if (!reuse)
+    _flowOffset = 0;
+
+  _bkFlow = _pBK->maxflow(reuse);
+  _flow = _bkFlow - _flowOffset;
   return _flow;
 }
 
@@ -169,6 +196,7 @@ void BkFlowAlg<DGR>::incCap(Arc a, double c)
   _cap[a] += c;
 
   _pBK->mark_node(_bkNode[_g.source(a)]);
+  _pBK->mark_node(_bkNode[_g.target(a)]);
 }
 
 template<typename DGR>
@@ -196,6 +224,8 @@ void BkFlowAlg<DGR>::setCap(const CapacityMap& cap)
     //assert(_pBK->get_trcap(_bkNode[v]) == 0);
     _pBK->set_trcap(_bkNode[v], 0);
   }
+  _supplyNodes.clear();
+  _flowOffset = 0;
 
   const double max = std::numeric_limits<double>::max();
   if (_source != lemon::INVALID)
@@ -218,6 +248,12 @@ double BkFlowAlg<DGR>::revResCap(Arc a) const
   return pBkArc->sister->r_cap;
 }
 
+template<typename DGR>
+double BkFlowAlg<DGR>::supply(Node v) const
+{
+  return std::max(_pBK->get_trcap(_bkNode[v]), 0.0);
+}
+
 template<typename DGR>
 double BkFlowAlg<DGR>::cap(Arc a) const
 {
@@ -243,23 +279,58 @@ void BkFlowAlg<DGR>::setSource(Node source, bool mark)
 }
 
 template<typename DGR>
-void BkFlowAlg<DGR>::setTarget(Node target, bool mark)
+void BkFlowAlg<DGR>::setTarget(Node target, bool reuse)
 {
   if (_target != lemon::INVALID)
   {
-    _pBK->set_trcap(_bkNode[_target], 0);
+    if (reuse)
+    {
+      // The flow that reached the previous target stays there as a supply,
+      // so the current flow remains feasible. A cut in the residual network
+      // has the same capacity as in the original one, hence the maximum
+      // flow to the new target is what the next run adds to the total.
+      // The sink link cannot be used to determine the flow, it is too
+      // large compared to the flow. The arcs carry all flow that ended
+      // at the target, including a supply it had before it became the
+      // target.
+      double excess = 0;
+      for (InArcIt a(_g, _target); a != lemon::INVALID; ++a)
+      {
+        excess += revResCap(a);
+      }
+      for (OutArcIt a(_g, _target); a != lemon::INVALID; ++a)
+      {
+        excess -= revResCap(a);
+      }
+      excess = std::max(excess, 0.0);
+
+      _pBK->set_trcap(_bkNode[_target], excess);
+      _pBK->mark_node(_bkNode[_target]);
+      if (excess > 0)
+        _supplyNodes.push_back(_target);
+
+      _flowOffset = _bkFlow;
+    }
+    else
+    {
+      _pBK->set_trcap(_bkNode[_target], 0);
+    }
   }
-  
-  if (mark)
+
+  _target = target;
+
+  // a supply at the new target goes to the sink at once,
+  // add_tweights() accounts for it in the flow
+  typename NodeVector::iterator it = std::find(_supplyNodes.begin(), _supplyNodes.end(), target);
+  if (it != _supplyNodes.end())
   {
-    assert(_target != lemon::INVALID);
-    _pBK->mark_node(_bkNode[_target]);
-    _pBK->mark_node(_bkNode[target]);
+    _supplyNodes.erase(it);
   }
 
   const double max = std::numeric_limits<double>::max();
-  _target = target;
   _pBK->add_tweights(_bkNode[_target], 0, max);
+  if (reuse)
+    _pBK->mark_node(_bkNode[_target]);
 }
 
 template<typename DGR>
@@ -0,0 +1,387 @@
+/*
+ * gsecpcst.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef GSECPCST_H
+#define GSECPCST_H
+
+#include <ilcplex/ilocplex.h>
+#include <ilcplex/ilocplexi.h>
+#include <ilconcert/ilothread.h>
+#include <lemon/tolerance.h>
+#include <vector>
+#include "backoff.h"
+#include "solver/impl/callbackstats.h"
+
+namespace nina {
+namespace mwcs {
+
+/// \brief Separation of generalized subtour elimination constraints
+///
+/// For a node set S and a node k in S, the edge variables satisfy
+/// z(E(S)) <= x(S \ {k}). Candidate sets are the connected components of
+/// the support of z, which for integral values are violated exactly if they
+/// contain a cycle. The graph is stored by variable indices, so separation
+/// does not touch (non thread-safe) graph maps.
+template<typename GR,
+         typename NWGHT = typename GR::template NodeMap<double>,
+         typename NLBL = typename GR::template NodeMap<std::string>,
+         typename EWGHT = typename GR::template EdgeMap<double> >
+class GsecPcst
+{
+public:
+  typedef GR Graph;
+  typedef NWGHT WeightNodeMap;
+  typedef NLBL LabelNodeMap;
+  typedef EWGHT WeightEdgeMap;
+
+protected:
+  TEMPLATE_GRAPH_TYPEDEFS(Graph);
+  typedef std::vector<int> IntVector;
+  typedef std::vector<double> DoubleVector;
+
+protected:
+  IloBoolVarArray _x;
+  IloBoolVarArray _z;
+  const int _n;
+  const int _m;
+  const lemon::Tolerance<double> _tol;
+  /// End points of edge j are nodes _edgeU[j] and _edgeV[j]
+  IntVector _edgeU;
+  IntVector _edgeV;
+  /// Union-find forest of the support of z
+  IntVector _parent;
+  IntVector _size;
+  IntVector _k;
+  IntVector _cutIdx;
+  DoubleVector _lhs;
+  DoubleVector _xSum;
+
+  static constexpr double _epsilon = 1e-5;
+
+public:
+  GsecPcst(IloBoolVarArray x,
+           IloBoolVarArray z,
+           const Graph& g,
+           const IntNodeMap& nodeMap,
+           const IntEdgeMap& edgeMap,
+           int n,
+           int m)
+    : _x(x)
+    , _z(z)
+    , _n(n)
+    , _m(m)
+    , _tol(_epsilon)
+    , _edgeU(m)
+    , _edgeV(m)
+    , _parent(n)
+    , _size(n)
+    , _k(n)
+    , _cutIdx(n)
+    , _lhs(n)
+    , _xSum(n)
+  {
+    for (EdgeIt e(g); e != lemon::INVALID; ++e)
+    {
+      _edgeU[edgeMap[e]] = nodeMap[g.u(e)];
+      _edgeV[edgeMap[e]] = nodeMap[g.v(e)];
+    }
+  }
+
+  virtual ~GsecPcst()
+  {
+  }
+
+protected:
+  int find(int i)
+  {
+    while (_parent[i] != i)
+    {
+      _parent[i] = _parent[_parent[i]];
+      i = _parent[i];
+    }
+    return i;
+  }
+
+  template<typename CBK>
+  void separate(const IloNumArray& x_values,
+                const IloNumArray& z_values,
+                CBK& cbk,
+                int& nCuts)
+  {
+    // determine connected components of the support of z
+    for (int i = 0; i < _n; ++i)
+    {
+      _parent[i] = i;
+      _size[i] = 0;
+      _k[i] = -1;
+      _cutIdx[i] = -1;
+      _lhs[i] = 0;
+      _xSum[i] = 0;
+    }
+
+    for (int j = 0; j < _m; ++j)
+    {
+      if (_tol.nonZero(z_values[j]))
+      {
+        int u = find(_edgeU[j]);
+        int v = find(_edgeV[j]);
+        if (u != v)
+        {
+          _parent[u] = v;
+        }
+      }
+    }
+
+    // k is the node of S with the largest x-value
+    for (int i = 0; i < _n; ++i)
+    {
+      int r = find(i);
+      ++_size[r];
+      _xSum[r] += x_values[i];
+      if (_k[r] == -1 || x_values[i] > x_values[_k[r]])
+      {
+        _k[r] = i;
+      }
+    }
+
+    for (int j = 0; j < _m; ++j)
+    {
+      int r = find(_edgeU[j]);
+      if (r == find(_edgeV[j]))
+      {
+        _lhs[r] += z_values[j];
+      }
+    }
+
+    std::vector<IloExpr> cuts;
+    for (int r = 0; r < _n; ++r)
+    {
+      if (_parent[r] == r && _size[r] > 1
+          && _tol.less(_xSum[r] - x_values[_k[r]], _lhs[r]))
+      {
+        _cutIdx[r] = static_cast<int>(cuts.size());
+        cuts.push_back(IloExpr(cbk.getEnv()));
+      }
+    }
+
+    if (cuts.empty())
+      return;
+
+    // z(E(S)) - x(S \ {k}) <= 0
+    for (int j = 0; j < _m; ++j)
+    {
+      int r = find(_edgeU[j]);
+      if (_cutIdx[r] != -1 && r == find(_edgeV[j]))
+      {
+        cuts[_cutIdx[r]] += _z[j];
+      }
+    }
+    for (int i = 0; i < _n; ++i)
+    {
+      int r = find(i);
+      if (_cutIdx[r] != -1 && i != _k[r])
+      {
+        cuts[_cutIdx[r]] -= _x[i];
+      }
+    }
+
+    for (size_t c = 0; c < cuts.size(); ++c)
+    {
+      cbk.add(cuts[c] <= 0, IloCplex::UseCutPurge).end();
+      cuts[c].end();
+      ++nCuts;
+    }
+  }
+};
+
+template<typename GR,
+         typename NWGHT = typename GR::template NodeMap<double>,
+         typename NLBL = typename GR::template NodeMap<std::string>,
+         typename EWGHT = typename GR::template EdgeMap<double> >
+class GsecPcstLazyConstraint : public IloCplex::LazyConstraintCallbackI,
+                               public GsecPcst<GR, NWGHT, NLBL, EWGHT>
+{
+public:
+  typedef GR Graph;
+  typedef NWGHT WeightNodeMap;
+  typedef NLBL LabelNodeMap;
+  typedef EWGHT WeightEdgeMap;
+  typedef GsecPcst<GR, NWGHT, NLBL, EWGHT> Parent;
+
+protected:
+  TEMPLATE_GRAPH_TYPEDEFS(Graph);
+
+  using Parent::_x;
+  using Parent::_z;
+  using Parent::_n;
+  using Parent::_m;
+  using Parent::separate;
+
+public:
+  GsecPcstLazyConstraint(IloEnv env,
+                         IloBoolVarArray x,
+                         IloBoolVarArray z,
+                         const Graph& g,
+                         const IntNodeMap& nodeMap,
+                         const IntEdgeMap& edgeMap,
+                         int n,
+                         int m)
+    : IloCplex::LazyConstraintCallbackI(env)
+    , Parent(x, z, g, nodeMap, edgeMap, n, m)
+  {
+  }
+
+  GsecPcstLazyConstraint(const GsecPcstLazyConstraint& other)
+    : IloCplex::LazyConstraintCallbackI(other)
+    , Parent(other)
+  {
+  }
+
+  virtual ~GsecPcstLazyConstraint()
+  {
+  }
+
+protected:
+  virtual void main()
+  {
+    CallbackStats::Scope scope(g_callbackStats, CallbackStats::LAZY_CONSTRAINT);
+
+    IloNumArray x_values(getEnv(), _n);
+    getValues(x_values, _x);
+
+    IloNumArray z_values(getEnv(), _m);
+    getValues(z_values, _z);
+
+    int nCuts = 0;
+    separate(x_values, z_values, *this, nCuts);
+    g_callbackStats.addCuts(CallbackStats::LAZY_CONSTRAINT, nCuts);
+
+    x_values.end();
+    z_values.end();
+  }
+
+  virtual IloCplex::CallbackI* duplicateCallback() const
+  {
+    return (new (getEnv()) GsecPcstLazyConstraint(*this));
+  }
+};
+
+template<typename GR,
+         typename NWGHT = typename GR::template NodeMap<double>,
+         typename NLBL = typename GR::template NodeMap<std::string>,
+         typename EWGHT = typename GR::template EdgeMap<double> >
+class GsecPcstUserCut : public IloCplex::UserCutCallbackI,
+                        public GsecPcst<GR, NWGHT, NLBL, EWGHT>
+{
+public:
+  typedef GR Graph;
+  typedef NWGHT WeightNodeMap;
+  typedef NLBL LabelNodeMap;
+  typedef EWGHT WeightEdgeMap;
+  typedef GsecPcst<GR, NWGHT, NLBL, EWGHT> Parent;
+
+protected:
+  TEMPLATE_GRAPH_TYPEDEFS(Graph);
+
+  using Parent::_x;
+  using Parent::_z;
+  using Parent::_n;
+  using Parent::_m;
+  using Parent::separate;
+
+  const int _maxNumberOfCuts;
+  int _cutCount;
+  int _nodeNumber;
+  int _lastCutCount;
+  BackOff _backOff;
+  bool _makeAttempt;
+
+public:
+  GsecPcstUserCut(IloEnv env,
+                  IloBoolVarArray x,
+                  IloBoolVarArray z,
+                  const Graph& g,
+                  const IntNodeMap& nodeMap,
+                  const IntEdgeMap& edgeMap,
+                  int n,
+                  int m,
+                  int maxNumberOfCuts,
+                  const BackOff& backOff)
+    : IloCplex::UserCutCallbackI(env)
+    , Parent(x, z, g, nodeMap, edgeMap, n, m)
+    , _maxNumberOfCuts(maxNumberOfCuts)
+    , _cutCount(0)
+    , _nodeNumber(0)
+    , _lastCutCount(0)
+    , _backOff(backOff)
+    , _makeAttempt(true)
+  {
+  }
+
+  GsecPcstUserCut(const GsecPcstUserCut& other)
+    : IloCplex::UserCutCallbackI(other)
+    , Parent(other)
+    , _maxNumberOfCuts(other._maxNumberOfCuts)
+    , _cutCount(0)
+    , _nodeNumber(0)
+    , _lastCutCount(0)
+    , _backOff(other._backOff)
+    , _makeAttempt(other._makeAttempt)
+  {
+  }
+
+  virtual ~GsecPcstUserCut()
+  {
+  }
+
+protected:
+  virtual void main()
+  {
+    // same schedule as NodeCutUser
+    if (_nodeNumber != getNnodes())
+    {
+      _nodeNumber = getNnodes();
+      _cutCount = 0;
+      _lastCutCount = 0;
+      _makeAttempt = _backOff.makeAttempt();
+      _backOff.startNode();
+    }
+
+    if (!_makeAttempt)
+      return;
+    if (_backOff.adaptive()
+          ? !_backOff.continueCutLoop(getObjValue(), _lastCutCount)
+          : !(_cutCount < _maxNumberOfCuts || _cutCount == -1))
+      return;
+    ++_cutCount;
+
+    CallbackStats::Scope scope(g_callbackStats, CallbackStats::USER_CUT);
+
+    IloNumArray x_values(getEnv(), _n);
+    getValues(x_values, _x);
+
+    IloNumArray z_values(getEnv(), _m);
+    getValues(z_values, _z);
+
+    int nCuts = 0;
+    separate(x_values, z_values, *this, nCuts);
+    g_callbackStats.addCuts(CallbackStats::USER_CUT, nCuts);
+    _lastCutCount = nCuts;
+
+    x_values.end();
+    z_values.end();
+  }
+
+  virtual IloCplex::CallbackI* duplicateCallback() const
+  {
+    return (new (getEnv()) GsecPcstUserCut(*this));
+  }
+};
+
+} // namespace mwcs
+} // namespace nina
+
+#endif // GSECPCST_H
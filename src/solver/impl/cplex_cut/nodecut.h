@@ -11,10 +11,12 @@
 #include <ilcplex/ilocplex.h>
 #include <ilcplex/ilocplexi.h>
 #include <ilconcert/ilothread.h>
-#include <lemon/adaptors.h>
 #include <lemon/tolerance.h>
 #include <set>
 #include <queue>
+#include <vector>
+#include "nodeset.h"
+#include "solver/impl/callbackstats.h"
 
 namespace nina {
 namespace mwcs {
@@ -37,10 +39,14 @@ protected:
   typedef typename NodeSet::const_iterator NodeSetIt;
   typedef std::vector<NodeSet> NodeSetVector;
   typedef typename NodeSetVector::const_iterator NodeSetVectorIt;
-  typedef lemon::FilterNodes<const Graph, const BoolNodeMap> SubGraph;
-  typedef typename SubGraph::NodeIt SubNodeIt;
-  typedef typename SubGraph::EdgeIt SubEdgeIt;
+  typedef std::vector<Node> NodeVector;
+  typedef typename NodeVector::const_iterator NodeVectorIt;
+  typedef std::vector<NodeVector> NodeVectorVector;
+  typedef typename NodeVectorVector::const_iterator NodeVectorVectorIt;
+  typedef DenseNodeSet<Graph> DenseNodeSetType;
   typedef std::queue<Node> NodeQueue;
+  typedef std::vector<bool> BoolVector;
+  typedef std::vector<int> IntVector;
 
 protected:
   IloBoolVarArray _x;
@@ -51,10 +57,20 @@ protected:
   const int _n;
   const int _maxNumberOfCuts;
   const lemon::Tolerance<double> _tol;
-  BoolNodeMap* _pNodeBoolMap;
-  const SubGraph* _pSubG;
-  IntNodeMap* _pComp;
-  IloFastMutex* _pMutex;
+  /// Nodes (by variable index) that remain to be separated
+  BoolVector _candidate;
+  /// Component of every node (by variable index), -1 if its x-value is zero
+  IntVector _comp;
+  /// Connected components of the support of the current x-values
+  NodeVectorVector _components;
+  /// Scratch sets used for computing the neighborhood of a component
+  DenseNodeSetType _S;
+  DenseNodeSetType _dS;
+  /// Component of G - N containing a separated component, N a minimal separator
+  NodeVector _sepComponent;
+  /// Stamps of the nodes (by variable index) used for determining _sepComponent
+  IntVector _sepMark;
+  int _sepStamp;
 
   // 1e-5 is the epsilon that CPLEX uses (for deciding integrality),
   // i.e. if |x| < 1e-5 it's considered to be 0 by CPLEX.
@@ -69,8 +85,7 @@ public:
           const WeightNodeMap& weight,
           const IntNodeMap& nodeMap,
           int n,
-          int maxNumberOfCuts,
-          IloFastMutex* pMutex)
+          int maxNumberOfCuts)
     : _x(x)
     , _y(y)
     , _g(g)
@@ -79,16 +94,15 @@ public:
     , _n(n)
     , _maxNumberOfCuts(maxNumberOfCuts)
     , _tol(_epsilon)
-    , _pNodeBoolMap(NULL)
-    , _pSubG(NULL)
-    , _pComp(NULL)
-    , _pMutex(pMutex)
+    , _candidate(n, false)
+    , _comp(n, -1)
+    , _components()
+    , _S(g)
+    , _dS(g)
+    , _sepComponent()
+    , _sepMark(n, 0)
+    , _sepStamp(0)
   {
-    lock();
-    _pNodeBoolMap = new BoolNodeMap(_g);
-    _pSubG = new SubGraph(_g, *_pNodeBoolMap);
-    _pComp = new IntNodeMap(_g);
-    unlock();
   }
 
   NodeCut(const NodeCut& other)
@@ -100,98 +114,235 @@ public:
     , _n(other._n)
     , _maxNumberOfCuts(other._maxNumberOfCuts)
     , _tol(other._tol)
-    , _pNodeBoolMap(NULL)
-    , _pSubG(NULL)
-    , _pComp(NULL)
-    , _pMutex(other._pMutex)
+    , _candidate(other._n, false)
+    , _comp(other._n, -1)
+    , _components()
+    , _S(other._g)
+    , _dS(other._g)
+    , _sepComponent()
+    , _sepMark(other._n, 0)
+    , _sepStamp(0)
   {
-    lock();
-    _pNodeBoolMap = new BoolNodeMap(_g);
-    _pSubG = new SubGraph(_g, *_pNodeBoolMap);
-    _pComp = new IntNodeMap(_g);
-    unlock();
   }
 
   virtual ~NodeCut()
   {
-    lock();
-    delete _pNodeBoolMap;
-    delete _pSubG;
-    delete _pComp;
-    unlock();
   }
 
 protected:
-  void lock()
+  /// Determines the connected components of the support of \c x_values.
+  /// The returned vector is reused by subsequent calls.
+  const NodeVectorVector& determineConnectedComponents(const IloNumArray& x_values)
   {
-    if (_pMutex)
-      _pMutex->lock();
+    // nodes outside of the support are not in any component
+    for (NodeIt v(_g); v != lemon::INVALID; ++v)
+    {
+      const int idx_v = _nodeMap[v];
+      _candidate[idx_v] = _tol.nonZero(x_values[idx_v]);
+      _comp[idx_v] = -1;
+    }
+    
+    // keep the capacity of the component vectors of the previous round
+    int nComp = 0;
+    for (NodeIt v(_g); v != lemon::INVALID; ++v)
+    {
+      const int idx_v = _nodeMap[v];
+      if (!_candidate[idx_v] || _comp[idx_v] != -1) continue;
+      
+      if (nComp == static_cast<int>(_components.size()))
+      {
+        _components.push_back(NodeVector());
+      }
+      NodeVector& component = _components[nComp];
+      component.clear();
+      
+      // bfs within the support, component doubles as the queue
+      _comp[idx_v] = nComp;
+      component.push_back(v);
+      for (size_t k = 0; k < component.size(); ++k)
+      {
+        for (IncEdgeIt e(_g, component[k]); e != lemon::INVALID; ++e)
+        {
+          const Node u = _g.oppositeNode(component[k], e);
+          const int idx_u = _nodeMap[u];
+          if (_candidate[idx_u] && _comp[idx_u] == -1)
+          {
+            _comp[idx_u] = nComp;
+            component.push_back(u);
+          }
+        }
+      }
+      ++nComp;
+    }
+    _components.resize(nComp);
+    
+    return _components;
   }
-
-  void unlock()
+  
+  /// Returns whether \c v is in component \c compIdx
+  /// as determined by the last call to determineConnectedComponents()
+  bool inComponent(int compIdx, Node v) const
   {
-    if (_pMutex)
-      _pMutex->unlock();
+    return _comp[_nodeMap[v]] == compIdx;
   }
   
-  NodeSetVector determineConnectedComponents(const IloNumArray& x_values)
+  /// Returns whether component \c compIdx contains a node of \c nodes
+  bool intersects(int compIdx, const NodeSet& nodes) const
   {
-    // update _pSubG
-    for (NodeIt v(_g); v != lemon::INVALID; ++v)
+    for (NodeSetIt it = nodes.begin(); it != nodes.end(); ++it)
+    {
+      if (inComponent(compIdx, *it))
+        return true;
+    }
+    return false;
+  }
+  
+  /// Determines the nodes adjacent to but not in \c S, stored in _dS
+  void determineNeighborhood(const NodeVector& S)
+  {
+    _S.clear();
+    _S.insert(S.begin(), S.end());
+    
+    _dS.clear();
+    for (NodeVectorIt it = S.begin(); it != S.end(); ++it)
+    {
+      const Node i = *it;
+      for (OutArcIt a(_g, i); a != lemon::INVALID; ++a)
+      {
+        const Node j = _g.target(a);
+        if (!_S.contains(j))
+        {
+          _dS.insert(j);
+        }
+      }
+    }
+  }
+  
+  /// Determines in _sepComponent the component of G - N that contains \c C,
+  /// where N is the subset of the neighborhood of \c C adjacent to the
+  /// nodes reachable from \c root without passing through that neighborhood.
+  /// N is a minimal separator of \c C and \c root, and the neighborhood
+  /// of _sepComponent is a subset of N.
+  void determineSeparatedComponent(const NodeVector& C, Node root)
+  {
+    determineNeighborhood(C);
+    assert(!_S.contains(root) && !_dS.contains(root));
+    
+    const int reached = ++_sepStamp;
+    const int separator = ++_sepStamp;
+    const int separated = ++_sepStamp;
+    
+    // nodes reachable from the root in G - N(C), _sepComponent doubles as the queue
+    _sepComponent.clear();
+    _sepComponent.push_back(root);
+    _sepMark[_nodeMap[root]] = reached;
+    for (size_t k = 0; k < _sepComponent.size(); ++k)
+    {
+      for (IncEdgeIt e(_g, _sepComponent[k]); e != lemon::INVALID; ++e)
+      {
+        const Node u = _g.oppositeNode(_sepComponent[k], e);
+        if (!_dS.contains(u) && _sepMark[_nodeMap[u]] != reached)
+        {
+          _sepMark[_nodeMap[u]] = reached;
+          _sepComponent.push_back(u);
+        }
+      }
+    }
+    
+    // the minimal separator
+    for (NodeVectorIt it = _dS.begin(); it != _dS.end(); ++it)
+    {
+      for (IncEdgeIt e(_g, *it); e != lemon::INVALID; ++e)
+      {
+        if (_sepMark[_nodeMap[_g.oppositeNode(*it, e)]] == reached)
+        {
+          _sepMark[_nodeMap[*it]] = separator;
+          break;
+        }
+      }
+    }
+    
+    // component of G - N containing C
+    _sepComponent.assign(C.begin(), C.end());
+    for (NodeVectorIt it = C.begin(); it != C.end(); ++it)
+    {
+      _sepMark[_nodeMap[*it]] = separated;
+    }
+    for (size_t k = 0; k < _sepComponent.size(); ++k)
     {
-      double val = x_values[_nodeMap[v]];
-      _pNodeBoolMap->set(v, _tol.nonZero(val));
+      for (IncEdgeIt e(_g, _sepComponent[k]); e != lemon::INVALID; ++e)
+      {
+        const Node u = _g.oppositeNode(_sepComponent[k], e);
+        const int mark_u = _sepMark[_nodeMap[u]];
+        assert(mark_u != reached);
+        if (mark_u != separator && mark_u != separated)
+        {
+          _sepMark[_nodeMap[u]] = separated;
+          _sepComponent.push_back(u);
+        }
+      }
     }
+  }
+  
+  /// Strengthened separateConnectedComponent() (when \c rooted is false)
+  /// or separateRootedConnectedComponent() (when \c rooted is true)
+  /// for integral x-values: the cuts of the nodes of \c C use
+  /// the neighborhood of determineSeparatedComponent(C, root) rather than
+  /// the neighborhood of \c C, which can only be smaller.
+  template<typename CBK>
+  void separateMinimalSeparator(const NodeVector& C,
+                                const Node root,
+                                bool rooted,
+                                CBK& cbk,
+                                int& nCuts)
+  {
+    determineSeparatedComponent(C, root);
+    determineNeighborhood(_sepComponent);
     
-    int nComp = lemon::connectedComponents(*_pSubG, *_pComp);
+    IloExpr rhs(cbk.getEnv());
+    if (rooted)
+    {
+      constructRHS(rhs, _dS);
+    }
+    else
+    {
+      constructRHS(rhs, _dS, _sepComponent);
+    }
     
-    NodeSetVector nonZeroComponents(nComp, NodeSet());
-    for (SubNodeIt i(*_pSubG); i != lemon::INVALID; ++i)
+    for (NodeVectorIt it = C.begin(); it != C.end(); ++it)
     {
-      int compIdx = (*_pComp)[i];
-      nonZeroComponents[compIdx].insert(i);
+      assert(isValid(*it, _dS, _sepComponent));
+      cbk.add(_x[_nodeMap[*it]] <= rhs, IloCplex::UseCutPurge).end();
+      ++nCuts;
     }
     
-    return nonZeroComponents;
+    rhs.end();
   }
   
   template<typename CBK>
-  void separateConnectedComponent(const NodeSet& S,
-                                  const NodeSet rootNodes,
+  void separateConnectedComponent(const NodeVector& S,
+                                  const NodeSet& rootNodes,
                                   const IloNumArray& x_values,
                                   const IloNumArray& y_values,
                                   CBK& cbk,
                                   int& nCuts)
   {
 #ifdef DEBUG
-    NodeSet intersection;
-    std::set_intersection(rootNodes.begin(), rootNodes.end(),
-                          S.begin(), S.end(),
-                          std::inserter(intersection, intersection.begin()));
-    assert(intersection.size() == 0);
+    for (NodeVectorIt it = S.begin(); it != S.end(); ++it)
+    {
+      assert(rootNodes.find(*it) == rootNodes.end());
+    }
 #endif
 
     IloExpr rhs(cbk.getEnv());
     
     // determine dS
-    NodeSet dS;
-    for (NodeSetIt it = S.begin(); it != S.end(); ++it)
-    {
-      const Node i = *it;
-      for (OutArcIt a(_g, i); a != lemon::INVALID; ++a)
-      {
-        const Node j = _g.target(a);
-        if (S.find(j) == S.end())
-        {
-          dS.insert(j);
-        }
-      }
-    }
+    determineNeighborhood(S);
     
-    constructRHS(rhs, dS, S);
-    for (NodeSetIt it = S.begin(); it != S.end(); ++it)
+    constructRHS(rhs, _dS, S);
+    for (NodeVectorIt it = S.begin(); it != S.end(); ++it)
     {
-      assert(isValid(*it, dS, S));
+      assert(isValid(*it, _dS, S));
       cbk.add(_x[_nodeMap[*it]] <= rhs, IloCplex::UseCutPurge).end();
       ++nCuts;
     }
@@ -200,35 +351,23 @@ protected:
   }
   
   template<typename CBK>
-  void separateRootedConnectedComponent(const NodeSet& S,
+  void separateRootedConnectedComponent(const NodeVector& S,
                                         const Node root,
                                         const IloNumArray& x_values,
                                         CBK& cbk,
                                         int& nCuts)
   {
-    assert(S.find(root) == S.end());
+    assert(std::find(S.begin(), S.end(), root) == S.end());
 
     IloExpr rhs(cbk.getEnv());
     
     // determine dS
-    NodeSet dS;
-    for (NodeSetIt it = S.begin(); it != S.end(); ++it)
-    {
-      const Node i = *it;
-      for (OutArcIt a(_g, i); a != lemon::INVALID; ++a)
-      {
-        const Node j = _g.target(a);
-        if (S.find(j) == S.end())
-        {
-          dS.insert(j);
-        }
-      }
-    }
+    determineNeighborhood(S);
     
-    constructRHS(rhs, dS);
-    for (NodeSetIt it = S.begin(); it != S.end(); ++it)
+    constructRHS(rhs, _dS);
+    for (NodeVectorIt it = S.begin(); it != S.end(); ++it)
     {
-      assert(isValid(*it, dS, S));
+      assert(isValid(*it, _dS, S));
       cbk.add(_x[_nodeMap[*it]] <= rhs, IloCplex::UseCutPurge).end();
       ++nCuts;
     }
@@ -376,32 +515,42 @@ protected:
     }
   }
 
+  template<typename DNODES>
   void constructRHS(IloExpr& rhs,
-                    const NodeSet& dS)
+                    const DNODES& dS)
   {
     rhs.clear();
-    for (NodeSetIt nodeIt = dS.begin(); nodeIt != dS.end(); nodeIt++)
+    for (typename DNODES::const_iterator nodeIt = dS.begin(); nodeIt != dS.end(); nodeIt++)
     {
       rhs += _x[_nodeMap[*nodeIt]];
     }
   }
   
+  template<typename DNODES, typename NODES>
   void constructRHS(IloExpr& rhs,
-                    const NodeSet& dS,
-                    const NodeSet& S)
+                    const DNODES& dS,
+                    const NODES& S)
   {
     rhs.clear();
-    for (NodeSetIt nodeIt = dS.begin(); nodeIt != dS.end(); nodeIt++)
+    for (typename DNODES::const_iterator nodeIt = dS.begin(); nodeIt != dS.end(); nodeIt++)
     {
       rhs += _x[_nodeMap[*nodeIt]];
     }
     
-    for (NodeSetIt nodeIt = S.begin(); nodeIt != S.end(); nodeIt++)
+    for (typename NODES::const_iterator nodeIt = S.begin(); nodeIt != S.end(); nodeIt++)
     {
       rhs += _y[_nodeMap[*nodeIt]];
     }
   }
 
+  template<typename DNODES, typename NODES>
+  bool isValid(Node target,
+               const DNODES& dS,
+               const NODES& S) const
+  {
+    return isValid(target, NodeSet(dS.begin(), dS.end()), NodeSet(S.begin(), S.end()));
+  }
+  
   bool isValid(Node target,
                const NodeSet& dS,
                const NodeSet& S) const
@@ -422,7 +571,7 @@ protected:
     
     // let's do a bfs from target
     NodeSet SS;
-    BoolNodeMap visited(_g, false);
+    BoolVector visited(_n, false);
 
     NodeQueue Q;
     Q.push(target);
@@ -430,13 +579,13 @@ protected:
     {
       Node v = Q.front();
       Q.pop();
-      visited[v] = true;
+      visited[_nodeMap[v]] = true;
       SS.insert(v);
       
       for (IncEdgeIt e(_g, v); e != lemon::INVALID; ++e)
       {
         Node u = _g.oppositeNode(v, e);
-        if (!visited[u] && dS.find(u) == dS.end())
+        if (!visited[_nodeMap[u]] && dS.find(u) == dS.end())
         {
           Q.push(u);
         }
@@ -44,14 +44,10 @@ public:
   using Parent::_n;
   using Parent::_maxNumberOfCuts;
   using Parent::_tol;
-  using Parent::_pNodeBoolMap;
-  using Parent::_pSubG;
-  using Parent::_pComp;
-  using Parent::_pMutex;
+  using Parent::_candidate;
+  using Parent::_comp;
   using Parent::_epsilon;
   
-  using Parent::lock;
-  using Parent::unlock;
   using Parent::determineConnectedComponents;
   using Parent::separateConnectedComponent;
   
@@ -66,10 +62,9 @@ public:
               const WeightNodeMap& weight,
               const IntNodeMap& nodeMap,
               int n,
-              int maxNumberOfCuts,
-              IloFastMutex* pMutex)
+              int maxNumberOfCuts)
     : IloCplex::LazyConstraintCallbackI(env)
-    , Parent(x, y, g, weight, nodeMap, n, maxNumberOfCuts, pMutex)
+    , Parent(x, y, g, weight, nodeMap, n, maxNumberOfCuts)
   {
   }
   
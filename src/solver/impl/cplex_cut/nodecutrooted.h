@@ -34,8 +34,9 @@ protected:
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetVector NodeSetVector;
   typedef typename Parent::NodeSetVectorIt NodeSetVectorIt;
-  typedef typename Parent::SubGraph SubGraph;
-  typedef typename Parent::SubNodeIt SubNodeIt;
+  typedef typename Parent::NodeVector NodeVector;
+  typedef typename Parent::NodeVectorIt NodeVectorIt;
+  typedef typename Parent::NodeVectorVector NodeVectorVector;
   
   using Parent::_x;
   using Parent::_g;
@@ -44,14 +45,10 @@ protected:
   using Parent::_n;
   using Parent::_maxNumberOfCuts;
   using Parent::_tol;
-  using Parent::_pNodeBoolMap;
-  using Parent::_pMutex;
+  using Parent::_candidate;
   using Parent::_y;
-  using Parent::_pSubG;
-  using Parent::_pComp;
+  using Parent::_comp;
   
-  using Parent::lock;
-  using Parent::unlock;
   using Parent::addViolatedConstraint;
   using Parent::getEnv;
   using Parent::getValues;
@@ -60,6 +57,8 @@ protected:
   using Parent::add;
   using Parent::determineConnectedComponents;
   using Parent::separateRootedConnectedComponent;
+  using Parent::separateMinimalSeparator;
+  using Parent::inComponent;
   
   friend class NodeCut<GR, NWGHT, NLBL, EWGHT>;
 
@@ -72,15 +71,17 @@ public:
                               const IntNodeMap& nodeMap,
                               int n,
                               int maxNumberOfCuts,
-                              IloFastMutex* pMutex)
-    : Parent(env, x, IloBoolVarArray(), g, weight, nodeMap, n, maxNumberOfCuts, pMutex)
+                              bool minimalSeparators = false)
+    : Parent(env, x, IloBoolVarArray(), g, weight, nodeMap, n, maxNumberOfCuts)
     , _rootNodes(rootNodes)
+    , _minimalSeparators(minimalSeparators)
   {
   }
 
   NodeCutRootedLazyConstraint(const NodeCutRootedLazyConstraint& other)
     : Parent(other)
     , _rootNodes(other._rootNodes)
+    , _minimalSeparators(other._minimalSeparators)
   {
   }
 
@@ -90,10 +91,13 @@ public:
   
 protected:
   NodeSet _rootNodes;
+  /// Whether to strengthen the cuts using minimal separators
+  const bool _minimalSeparators;
 
 protected:
   virtual void main()
   {
+    CallbackStats::Scope scope(g_callbackStats, CallbackStats::LAZY_CONSTRAINT);
     separate();
   }
 
@@ -108,24 +112,33 @@ protected:
     getValues(x_values, _x);
     
     // determine connected components
-    NodeSetVector nonZeroComponents = determineConnectedComponents(x_values);
+    const NodeVectorVector& nonZeroComponents = determineConnectedComponents(x_values);
     
     int nCuts = 0;
-    for (NodeSetVectorIt it = nonZeroComponents.begin(); it != nonZeroComponents.end(); ++it)
+    const int nComp = static_cast<int>(nonZeroComponents.size());
+    for (int compIdx = 0; compIdx < nComp; ++compIdx)
     {
-      const NodeSet& nonZeroComponent = *it;
       for (NodeSetIt rootIt = _rootNodes.begin(); rootIt != _rootNodes.end(); ++rootIt)
       {
         Node root = *rootIt;
-        if (nonZeroComponent.find(root) == nonZeroComponent.end())
+        if (inComponent(compIdx, root))
+          continue;
+        
+        // a root outside of the support may be adjacent to the component
+        if (_minimalSeparators && _tol.nonZero(x_values[_nodeMap[root]]))
         {
-          separateRootedConnectedComponent(*it, *rootIt, x_values, *this, nCuts);
+          separateMinimalSeparator(nonZeroComponents[compIdx], root, true, *this, nCuts);
+        }
+        else
+        {
+          separateRootedConnectedComponent(nonZeroComponents[compIdx], root, x_values, *this, nCuts);
         }
       }
     }
     
     x_values.end();
     
+    g_callbackStats.addCuts(CallbackStats::LAZY_CONSTRAINT, nCuts);
 //    std::cerr << "#comps: " << nonZeroComponents.size() << ", generated " << nCuts << " lazy cuts" << std::endl;
   }
 };
@@ -153,15 +166,16 @@ protected:
   typedef typename Parent::DiInArcIt DiInArcIt;
   typedef typename Parent::DiOutArcIt DiOutArcIt;
   typedef typename Parent::DiNodeNodeMap DiNodeNodeMap;
-  typedef typename Parent::NodeDiNodeMap NodeDiNodeMap;
-  typedef typename Parent::NodeDiArcMap NodeDiArcMap;
+  typedef typename Parent::DiNodeVector DiNodeVector;
+  typedef typename Parent::DiArcVector DiArcVector;
   typedef typename Parent::CapacityMap CapacityMap;
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetVector NodeSetVector;
   typedef typename Parent::NodeSetVectorIt NodeSetVectorIt;
-  typedef typename Parent::SubGraph SubGraph;
-  typedef typename Parent::SubNodeIt SubNodeIt;
+  typedef typename Parent::NodeVector NodeVector;
+  typedef typename Parent::NodeVectorIt NodeVectorIt;
+  typedef typename Parent::NodeVectorVector NodeVectorVector;
   typedef typename Parent::NodeQueue NodeQueue;
   typedef typename Parent::DiNodeQueue DiNodeQueue;
   typedef typename Parent::DiNodeSet DiNodeSet;
@@ -179,26 +193,24 @@ protected:
   using Parent::_n;
   using Parent::_maxNumberOfCuts;
   using Parent::_tol;
-  using Parent::_pNodeBoolMap;
-  using Parent::_pMutex;
+  using Parent::_candidate;
   using Parent::_epsilon;
   using Parent::_cutEpsilon;
   using Parent::_h;
   using Parent::_cap;
-  using Parent::_pG2h1;
-  using Parent::_pG2h2;
-  using Parent::_pG2hRootArc;
+  using Parent::_g2h1;
+  using Parent::_g2h2;
+  using Parent::_g2hRootArc;
   using Parent::_h2g;
   using Parent::_diRootSet;
   using Parent::_pBK;
   using Parent::_marked;
   using Parent::_cutCount;
   using Parent::_nodeNumber;
-  using Parent::_pSubG;
-  using Parent::_pComp;
+  using Parent::_nestedCuts;
+  using Parent::_backCuts;
+  using Parent::_comp;
   
-  using Parent::lock;
-  using Parent::unlock;
   using Parent::determineFwdCutSet;
   using Parent::determineBwdCutSet;
   using Parent::addViolatedConstraint;
@@ -209,6 +221,7 @@ protected:
   using Parent::add;
   using Parent::determineConnectedComponents;
   using Parent::separateRootedConnectedComponent;
+  using Parent::inComponent;
   
   friend class NodeCut<GR, NWGHT, NLBL, EWGHT>;
 
@@ -221,9 +234,11 @@ public:
                        const IntNodeMap& nodeMap,
                        int n,
                        int maxNumberOfCuts,
-                       IloFastMutex* pMutex,
-                       BackOff backOff)
-    : Parent(env, x, IloBoolVarArray(), g, weight, nodeMap, n, maxNumberOfCuts, pMutex, backOff)
+                       BackOff backOff,
+                       bool nestedCuts,
+                       bool backCuts)
+    : Parent(env, x, IloBoolVarArray(), g, weight, nodeMap, n, maxNumberOfCuts, backOff,
+             nestedCuts, backCuts)
     , _rootNodes(rootNodes)
   {
     init();
@@ -244,19 +259,15 @@ public:
     .arcMap(other._cap, _cap)
     .run();
     
-    lock();
-    _pG2h1 = new NodeDiNodeMap(_g);
-    _pG2h2 = new NodeDiNodeMap(_g);
-    unlock();
-    
-    for (NodeIt v(_g); v != lemon::INVALID; ++v)
+    for (int i = 0; i < _n; ++i)
     {
-      DiNode v1 = (*other._pG2h1)[v];
-      DiNode v2 = (*other._pG2h2)[v];
+      DiNode v1 = other._g2h1[i];
+      DiNode v2 = other._g2h2[i];
       
-      _pG2h1->set(v, nodeMap[v1]);
+      if (v1 != lemon::INVALID)
+        _g2h1[i] = nodeMap[v1];
       if (v2 != lemon::INVALID)
-        _pG2h2->set(v, nodeMap[v2]);
+        _g2h2[i] = nodeMap[v2];
     }
     
     for (DiNodeSetIt diRootIt = other._diRootSet.begin();
@@ -280,89 +291,92 @@ protected:
     return (new (getEnv()) NodeCutRootedUserCut(*this));
   }
   
-  void separateMinCut(const NodeSet& nonZeroComponent,
+  void separateMinCut(const NodeVector& nonZeroComponent,
                       const Node root,
                       const IloNumArray& x_values,
                       int& nCuts, int& nBackCuts, int& nNestedCuts)
   {
     IloExpr rhs(getEnv());
     
-    DiNode diRoot = (*_pG2h1)[root];
+    DiNode diRoot = _g2h1[_nodeMap[root]];
     
     _pBK->setSource(diRoot);
-    _pNodeBoolMap->set(root, false);
-    for (NodeSetIt it = nonZeroComponent.begin(); it != nonZeroComponent.end(); ++it)
+    _candidate[_nodeMap[root]] = false;
+    // the flow of the previous target is reused unless nested cuts
+    // have changed the capacities
+    bool reuse = false;
+    for (NodeVectorIt it = nonZeroComponent.begin(); it != nonZeroComponent.end(); ++it)
     {
       Node i = *it;
       // skip if node was already considered or its x-value is 0
-      if (!(*_pNodeBoolMap)[i]) continue;
+      if (!_candidate[_nodeMap[i]]) continue;
       
       const double x_i_value = x_values[_nodeMap[i]];
       
-      _pBK->setTarget((*_pG2h2)[i]);
-      _pBK->setCap(_cap);
+      _pBK->setTarget(_g2h2[_nodeMap[i]], reuse);
+      if (!reuse)
+      {
+        _pBK->setCap(_cap);
+      }
       
       bool nestedCut = false;
-      bool first = true;
-//      while (true)
+      while (true)
       {
-        if (first)
-        {
-          _pBK->run();
-          first = false;
-        }
-        else
-        {
-          _pBK->run(true);
-        }
+        _pBK->run(reuse);
+        g_callbackStats.addMaxFlows(CallbackStats::USER_CUT, 1);
+        reuse = true;
         
         // let's see if there's a violated constraint
         double minCutValue = _pBK->maxFlow();
-        if (_tol.less(minCutValue, x_i_value))
+        if (!_tol.less(minCutValue, x_i_value))
+          break;
+        
+        // determine N (forward)
+        NodeSet fwdDS;
+        determineFwdCutSet(_h, *_pBK, diRoot, _h2g, _marked, fwdDS);
+        
+        // numerical instability may cause minCutValue < x_i_value
+        // even though there is nothing to cut
+        if (fwdDS.empty()) break;
+        
+        // determine N (backward)
+        NodeSet bwdDS;
+        determineBwdCutSet(_h, *_pBK, diRoot, _h2g, _marked, bwdDS);
+        
+        bool backCuts = _backCuts && (fwdDS.size() != bwdDS.size() || fwdDS != bwdDS);
+        
+        // add violated constraints
+        _candidate[_nodeMap[i]] = false;
+        addViolatedConstraint(*this, i, fwdDS);
+        ++nCuts;
+        if (nestedCut) ++nNestedCuts;
+        
+        if (backCuts)
         {
-          // determine N (forward)
-          NodeSet fwdDS;
-          determineFwdCutSet(_h, *_pBK, diRoot, _h2g, _marked, fwdDS);
-          
-          // numerical instability may cause minCutValue < x_i_value
-          // even though there is nothing to cut
-          if (fwdDS.empty()) break;
-          
-          // determine N (backward)
-          NodeSet bwdDS;
-          determineBwdCutSet(_h, *_pBK, diRoot, _h2g, _marked, bwdDS);
-          
-          bool backCuts = fwdDS.size() != bwdDS.size() || fwdDS != bwdDS;
-          
-          // add violated constraints
-          _pNodeBoolMap->set(i, false);
-          addViolatedConstraint(*this, i, fwdDS);
+          addViolatedConstraint(*this, i, bwdDS);
           ++nCuts;
-          if (nestedCut) ++nNestedCuts;
-          
-          if (backCuts)
-          {
-            addViolatedConstraint(*this, i, bwdDS);
-            ++nCuts;
-            ++nBackCuts;
-          }
-          
-//          // generate nested-cuts
-//          for (NodeSetIt nodeIt = fwdDS.begin(); nodeIt != fwdDS.end(); nodeIt++)
-//          {
-//            nestedCut = true;
-//            // update the capactity to generate nested-cuts
-//            _pBK->incCap(DiOutArcIt(_h, (*_pG2h1)[*nodeIt]), 1);
-//          }
+          ++nBackCuts;
         }
-//        else
-//        {
-//          break;
-//        }
+        
+        if (!_nestedCuts)
+          break;
+        
+        // generate nested-cuts, see NodeCutUnrootedUserCut
+        nestedCut = true;
+        for (NodeSetIt nodeIt = fwdDS.begin(); nodeIt != fwdDS.end(); nodeIt++)
+        {
+          _pBK->incCap(DiOutArcIt(_h, _g2h1[_nodeMap[*nodeIt]]), 1);
+        }
+      }
+      
+      // the next target needs the original capacities
+      if (nestedCut)
+      {
+        reuse = false;
       }
     }
     
-    _pNodeBoolMap->set(root, true);
+    _candidate[_nodeMap[root]] = true;
     
     rhs.end();
   }
@@ -377,7 +391,7 @@ protected:
 //    NodeSetVector compMatrix(nComp, NodeSet());
 //    for (SubNodeIt i(*_pSubG); i != lemon::INVALID; ++i)
 //    {
-//      int compIdx = (*_pComp)[i];
+//      int compIdx = _comp[_nodeMap[i]];
 //      compMatrix[compIdx].insert(i);
 //    }
 //    
@@ -418,26 +432,27 @@ protected:
 //    rhs.end();
 //  }
 
-  void separate()
+  int separate()
   {
     IloNumArray x_values(getEnv(), _n);
     getValues(x_values, _x);
     
     // determine connected components
     computeCapacities(_cap, x_values);
-    NodeSetVector nonZeroComponents = determineConnectedComponents(x_values);
+    const NodeVectorVector& nonZeroComponents = determineConnectedComponents(x_values);
     
     int nCuts = 0;
     int nBackCuts = 0;
     int nNestedCuts = 0;
     
+    const int nComp = static_cast<int>(nonZeroComponents.size());
     for (NodeSetIt rootIt = _rootNodes.begin(); rootIt != _rootNodes.end(); ++rootIt)
     {
       Node root = *rootIt;
-      for (NodeSetVectorIt it = nonZeroComponents.begin(); it != nonZeroComponents.end(); ++it)
+      for (int compIdx = 0; compIdx < nComp; ++compIdx)
       {
-        const NodeSet& nonZeroComponent = *it;
-        if (_nodeNumber == 0 || nonZeroComponent.find(root) != nonZeroComponent.end())
+        const NodeVector& nonZeroComponent = nonZeroComponents[compIdx];
+        if (_nodeNumber == 0 || inComponent(compIdx, root))
         {
           // todo give separateMinCut nonZeroComponent
           separateMinCut(nonZeroComponent, root, x_values, nCuts, nBackCuts, nNestedCuts);
@@ -463,6 +478,10 @@ protected:
 //              << nNestedCuts << " are nested cuts" << std::endl;
     
     x_values.end();
+    
+    g_callbackStats.addCuts(CallbackStats::USER_CUT, nCuts);
+    
+    return nCuts;
   }
   
   void computeCapacities(CapacityMap& capacity,
@@ -474,15 +493,15 @@ protected:
       double val = x_values[_nodeMap[v]];
       if (!_tol.nonZero(val))
       {
-        _pNodeBoolMap->set(v, false);
+        _candidate[_nodeMap[v]] = false;
         val = 10 * _cutEpsilon;
       }
       else
       {
-        _pNodeBoolMap->set(v, true);
+        _candidate[_nodeMap[v]] = true;
       }
       
-      DiNode v1 = (*_pG2h1)[v];
+      DiNode v1 = _g2h1[_nodeMap[v]];
       DiOutArcIt a(_h, v1);
       
       if (a != lemon::INVALID)
@@ -573,8 +592,8 @@ protected:
       DiNode diRoot = _h.addNode();
       _diRootSet.insert(diRoot);
       
-      _pG2h1->set(root, diRoot);
-      _pG2h2->set(root, diRoot);
+      _g2h1[_nodeMap[root]] = diRoot;
+      _g2h2[_nodeMap[root]] = diRoot;
       _h2g[diRoot] = root;
     }
     
@@ -584,8 +603,8 @@ protected:
       {
         DiNode i1 = _h.addNode();
         DiNode i2 = _h.addNode();
-        _pG2h1->set(i, i1);
-        _pG2h2->set(i, i2);
+        _g2h1[_nodeMap[i]] = i1;
+        _g2h2[_nodeMap[i]] = i2;
         _h2g[i1] = i;
         _h2g[i2] = i;
         
@@ -598,10 +617,10 @@ protected:
     {
       Node i = _g.u(e);
       Node j = _g.v(e);
-      DiNode i1 = (*_pG2h1)[i];
-      DiNode i2 = (*_pG2h2)[i];
-      DiNode j1 = (*_pG2h1)[j];
-      DiNode j2 = (*_pG2h2)[j];
+      DiNode i1 = _g2h1[_nodeMap[i]];
+      DiNode i2 = _g2h2[_nodeMap[i]];
+      DiNode j1 = _g2h1[_nodeMap[j]];
+      DiNode j2 = _g2h2[_nodeMap[j]];
       
       bool root_i = _rootNodes.find(i) != _rootNodes.end();
       bool root_j = _rootNodes.find(j) != _rootNodes.end();
@@ -614,12 +633,12 @@ protected:
       }
       else if (root_i)
       {
-        DiArc ij1 = _h.addArc((*_pG2h1)[i], j1);
+        DiArc ij1 = _h.addArc(_g2h1[_nodeMap[i]], j1);
         _cap[ij1] = 1;
       }
       else if (root_j)
       {
-        DiArc ji1 = _h.addArc((*_pG2h1)[j], i1);
+        DiArc ji1 = _h.addArc(_g2h1[_nodeMap[j]], i1);
         _cap[ji1] = 1;
       }
     }
@@ -35,8 +35,9 @@ protected:
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetVector NodeSetVector;
   typedef typename Parent::NodeSetVectorIt NodeSetVectorIt;
-  typedef typename Parent::SubGraph SubGraph;
-  typedef typename Parent::SubNodeIt SubNodeIt;
+  typedef typename Parent::NodeVector NodeVector;
+  typedef typename Parent::NodeVectorIt NodeVectorIt;
+  typedef typename Parent::NodeVectorVector NodeVectorVector;
 
   using Parent::_x;
   using Parent::_y;
@@ -46,14 +47,10 @@ protected:
   using Parent::_n;
   using Parent::_maxNumberOfCuts;
   using Parent::_tol;
-  using Parent::_pNodeBoolMap;
-  using Parent::_pMutex;
+  using Parent::_candidate;
   using Parent::_epsilon;
-  using Parent::_pSubG;
-  using Parent::_pComp;
+  using Parent::_comp;
   
-  using Parent::lock;
-  using Parent::unlock;
   using Parent::getEnv;
   using Parent::getValues;
   using Parent::constructRHS;
@@ -61,9 +58,15 @@ protected:
   using Parent::isValid;
   using Parent::determineConnectedComponents;
   using Parent::separateConnectedComponent;
+  using Parent::separateMinimalSeparator;
+  using Parent::inComponent;
+  using Parent::intersects;
   
   friend class NodeCut<GR, NWGHT, NLBL, EWGHT>;
 
+  /// Whether to strengthen the cuts using minimal separators
+  const bool _minimalSeparators;
+
 public:
   NodeCutUnrootedLazyConstraint(IloEnv env,
                                 IloBoolVarArray x,
@@ -73,13 +76,15 @@ public:
                                 const IntNodeMap& nodeMap,
                                 int n,
                                 int maxNumberOfCuts,
-                                IloFastMutex* pMutex)
-    : Parent(env, x, y, g, weight, nodeMap, n, maxNumberOfCuts, pMutex)
+                                bool minimalSeparators = false)
+    : Parent(env, x, y, g, weight, nodeMap, n, maxNumberOfCuts)
+    , _minimalSeparators(minimalSeparators)
   {
   }
 
   NodeCutUnrootedLazyConstraint(const NodeCutUnrootedLazyConstraint& other)
     : Parent(other)
+    , _minimalSeparators(other._minimalSeparators)
   {
   }
 
@@ -90,6 +95,7 @@ public:
 protected:
   virtual void main()
   {
+    CallbackStats::Scope scope(g_callbackStats, CallbackStats::LAZY_CONSTRAINT);
     separate();
   }
 
@@ -120,27 +126,30 @@ protected:
     assert(rootNodes.size() == 1);
     
     // determine connected components
-    NodeSetVector nonZeroComponents = determineConnectedComponents(x_values);
+    const NodeVectorVector& nonZeroComponents = determineConnectedComponents(x_values);
 
+    // all components not containing the root are separated in one round
     int nCuts = 0;
-    for (NodeSetVectorIt it = nonZeroComponents.begin(); it != nonZeroComponents.end(); ++it)
+    const int nComp = static_cast<int>(nonZeroComponents.size());
+    for (int compIdx = 0; compIdx < nComp; ++compIdx)
     {
-      const NodeSet& nonZeroComponent = *it;
-      
-      NodeSet intersection;
-      std::set_intersection(rootNodes.begin(), rootNodes.end(),
-                            nonZeroComponent.begin(), nonZeroComponent.end(),
-                            std::inserter(intersection, intersection.begin()));
+      if (intersects(compIdx, rootNodes))
+        continue;
       
-      if (intersection.size() == 0)
+      if (_minimalSeparators)
+      {
+        separateMinimalSeparator(nonZeroComponents[compIdx], *rootNodes.begin(), false, *this, nCuts);
+      }
+      else
       {
-        separateConnectedComponent(*it, rootNodes, x_values, y_values, *this, nCuts);
+        separateConnectedComponent(nonZeroComponents[compIdx], rootNodes, x_values, y_values, *this, nCuts);
       }
     }
     
     x_values.end();
     y_values.end();
     
+    g_callbackStats.addCuts(CallbackStats::LAZY_CONSTRAINT, nCuts);
 //    std::cerr << "#comps: " << nonZeroComponents.size() << ", generated " << nCuts << " lazy cuts" << std::endl;
   }
 };
@@ -168,16 +177,16 @@ protected:
   typedef typename Parent::DiInArcIt DiInArcIt;
   typedef typename Parent::DiOutArcIt DiOutArcIt;
   typedef typename Parent::DiNodeNodeMap DiNodeNodeMap;
-  typedef typename Parent::NodeDiNodeMap NodeDiNodeMap;
-  typedef typename Parent::NodeDiArcMap NodeDiArcMap;
+  typedef typename Parent::DiNodeVector DiNodeVector;
+  typedef typename Parent::DiArcVector DiArcVector;
   typedef typename Parent::CapacityMap CapacityMap;
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetVector NodeSetVector;
   typedef typename Parent::NodeSetVectorIt NodeSetVectorIt;
-  typedef typename Parent::SubGraph SubGraph;
-  typedef typename Parent::SubNodeIt SubNodeIt;
-  typedef typename Parent::SubEdgeIt SubEdgeIt;
+  typedef typename Parent::NodeVector NodeVector;
+  typedef typename Parent::NodeVectorIt NodeVectorIt;
+  typedef typename Parent::NodeVectorVector NodeVectorVector;
   typedef typename Parent::NodeQueue NodeQueue;
   typedef typename Parent::DiNodeQueue DiNodeQueue;
   typedef typename Parent::DiNodeSet DiNodeSet;
@@ -195,26 +204,24 @@ protected:
   using Parent::_n;
   using Parent::_maxNumberOfCuts;
   using Parent::_tol;
-  using Parent::_pNodeBoolMap;
-  using Parent::_pMutex;
+  using Parent::_candidate;
   using Parent::_epsilon;
   using Parent::_cutEpsilon;
   using Parent::_h;
   using Parent::_cap;
-  using Parent::_pG2h1;
-  using Parent::_pG2h2;
-  using Parent::_pG2hRootArc;
+  using Parent::_g2h1;
+  using Parent::_g2h2;
+  using Parent::_g2hRootArc;
   using Parent::_h2g;
   using Parent::_diRootSet;
   using Parent::_pBK;
   using Parent::_marked;
   using Parent::_cutCount;
   using Parent::_nodeNumber;
-  using Parent::_pSubG;
-  using Parent::_pComp;
+  using Parent::_nestedCuts;
+  using Parent::_backCuts;
+  using Parent::_comp;
 
-  using Parent::lock;
-  using Parent::unlock;
   using Parent::determineFwdCutSet;
   using Parent::determineBwdCutSet;
   using Parent::add;
@@ -225,6 +232,8 @@ protected:
   using Parent::isValid;
   using Parent::determineConnectedComponents;
   using Parent::separateConnectedComponent;
+  using Parent::inComponent;
+  using Parent::intersects;
   
   friend class NodeCut<GR, NWGHT, NLBL, EWGHT>;
 
@@ -237,14 +246,12 @@ public:
                          const IntNodeMap& nodeMap,
                          int n,
                          int maxNumberOfCuts,
-                         IloFastMutex* pMutex,
-                         BackOff backOff)
-    : Parent(env, x, y, g, weight, nodeMap, n, maxNumberOfCuts, pMutex, backOff)
+                         BackOff backOff,
+                         bool nestedCuts,
+                         bool backCuts)
+    : Parent(env, x, y, g, weight, nodeMap, n, maxNumberOfCuts, backOff,
+             nestedCuts, backCuts)
   {
-    lock();
-    _pG2hRootArc = new NodeDiArcMap(_g);
-    unlock();
-    
     init();
     _pBK = new BkAlg(_h, _cap);
   }
@@ -262,21 +269,11 @@ public:
     .arcMap(other._cap, _cap)
     .run();
     
-    lock();
-    _pG2h1 = new NodeDiNodeMap(_g);
-    _pG2h2 = new NodeDiNodeMap(_g);
-    _pG2hRootArc = new NodeDiArcMap(_g);
-    unlock();
-    
-    for (NodeIt v(_g); v != lemon::INVALID; ++v)
+    for (int i = 0; i < _n; ++i)
     {
-      DiNode v1 = (*other._pG2h1)[v];
-      DiNode v2 = (*other._pG2h2)[v];
-      DiArc root_arc_v = (*other._pG2hRootArc)[v];
-      
-      _pG2h1->set(v, nodeMap[v1]);
-      _pG2h2->set(v, nodeMap[v2]);
-      _pG2hRootArc->set(v, arcMap[root_arc_v]);
+      _g2h1[i] = nodeMap[other._g2h1[i]];
+      _g2h2[i] = nodeMap[other._g2h2[i]];
+      _g2hRootArc[i] = arcMap[other._g2hRootArc[i]];
     }
     
     for (DiNodeSetIt diRootIt = other._diRootSet.begin();
@@ -298,7 +295,7 @@ protected:
     return (new (getEnv()) NodeCutUnrootedUserCut(*this));
   }
   
-  void separateMinCut(const NodeSet& nonZeroComponent,
+  void separateMinCut(const NodeVector& nonZeroComponent,
                       const IloNumArray& x_values,
                       const IloNumArray& y_values,
                       int& nCuts, int& nBackCuts, int& nNestedCuts)
@@ -309,115 +306,115 @@ protected:
     DiNode diRoot = *_diRootSet.begin();
 
     _pBK->setSource(diRoot);
-    for (NodeSetIt it = nonZeroComponent.begin(); it != nonZeroComponent.end(); ++it)
+    // the flow of the previous target is reused unless nested cuts
+    // have changed the capacities
+    bool reuse = false;
+    for (NodeVectorIt it = nonZeroComponent.begin(); it != nonZeroComponent.end(); ++it)
     {
       Node i = *it;
       // skip if node was already considered or its x-value is 0
-      if (!(*_pNodeBoolMap)[i]) continue;
+      if (!_candidate[_nodeMap[i]]) continue;
       
       const double x_i_value = x_values[_nodeMap[i]];
       
-      _pBK->setTarget((*_pG2h2)[i]);
-      _pBK->setCap(_cap);
+      _pBK->setTarget(_g2h2[_nodeMap[i]], reuse);
+      if (!reuse)
+      {
+        _pBK->setCap(_cap);
+      }
       
       bool nestedCut = false;
-      bool first = true;
-//      while (true)
+      while (true)
       {
-        if (first)
-        {
-          _pBK->run();
-          first = false;
-        }
-        else
-        {
-          _pBK->run(false);
-        }
+        _pBK->run(reuse);
+        g_callbackStats.addMaxFlows(CallbackStats::USER_CUT, 1);
+        reuse = true;
         
         // let's see if there's a violated constraint
         double minCutValue = _pBK->maxFlow();
-        if (_tol.less(minCutValue, x_i_value))
+        if (!_tol.less(minCutValue, x_i_value))
+          break;
+        
+        // determine N (forward)
+        NodeSet fwdS, fwdDS;
+        determineFwdCutSet(_h, *_pBK, diRoot, _h2g, _marked, fwdDS, fwdS);
+        
+        // numerical instability may cause minCutValue < x_i_value
+        // even though there is nothing to cut
+        if (fwdS.empty() && fwdDS.empty()) break;
+        
+        // determine N (backward)
+        NodeSet bwdS, bwdDS;
+        determineBwdCutSet(_h, *_pBK, diRoot, _h2g, _marked, bwdDS, bwdS);
+        
+        bool backCuts = _backCuts &&
+        (fwdDS.size() != bwdDS.size() ||
+         fwdS.size() != bwdS.size() ||
+         fwdDS != bwdDS || bwdS != fwdS);
+        
+        // add violated constraints for all nodes j in fwdS with x_j >= x_i
+        constructRHS(rhs, fwdDS, fwdS);
+        for (NodeSetIt it2 = fwdS.begin(); it2 != fwdS.end(); ++it2)
         {
-          // determine N (forward)
-          NodeSet fwdS, fwdDS;
-          determineFwdCutSet(_h, *_pBK, diRoot, _h2g, _marked, fwdDS, fwdS);
-          
-          // numerical instability may cause minCutValue < x_i_value
-          // even though there is nothing to cut
-          if (fwdS.empty() && fwdDS.empty()) break;
-          
-          // determine N (backward)
-          NodeSet bwdS, bwdDS;
-          determineBwdCutSet(_h, *_pBK, diRoot, _h2g, _marked, bwdDS, bwdS);
+          const Node j = *it2;
+          const double x_j_value = x_values[_nodeMap[j]];
           
-          bool backCuts = fwdDS.size() != bwdDS.size() ||
-          fwdS.size() != bwdS.size() ||
-          fwdDS != bwdDS || bwdS != fwdS;
-          
-          // add violated constraints for all nodes j in fwdS with x_j >= x_i
-          constructRHS(rhs, fwdDS, fwdS);
-          for (NodeSetIt it2 = fwdS.begin(); it2 != fwdS.end(); ++it2)
+          if (_tol.less(minCutValue, x_j_value))
+          {
+            assert(isValid(j, fwdDS, fwdS));
+            
+            _candidate[_nodeMap[j]] = false;
+            add(_x[_nodeMap[j]] <= rhs, IloCplex::UseCutPurge).end();
+            
+            ++nCuts;
+            if (nestedCut) ++nNestedCuts;
+          }
+        }
+        
+        if (backCuts)
+        {
+          // add violated constraints for all nodes j in bwdS with x_j >= x_i
+          constructRHS(rhs, bwdDS, bwdS);
+          for (NodeSetIt it2 = bwdS.begin(); it2 != bwdS.end(); ++it2)
           {
             const Node j = *it2;
             const double x_j_value = x_values[_nodeMap[j]];
             
             if (_tol.less(minCutValue, x_j_value))
             {
-              //              std::cerr << std::endl << "nonZeroComp" << std::endl;
-              //              this->printNodeSet(nonZeroComponent, _y, y_values);
-              //
-              //              std::cerr << std::endl << "S" << std::endl;
-              //              this->printNodeSet(fwdS, _y, y_values);
-              //
-              //              std::cerr << std::endl << "dS" << std::endl;
-              //              this->printNodeSet(fwdDS, _x, x_values);
-              
-              assert(isValid(j, fwdDS, fwdS));
-              //              std::cerr << x_j_value - minCutValue << std::endl;
+              assert(isValid(j, bwdDS, bwdS));
               
-              _pNodeBoolMap->set(j, false);
+              _candidate[_nodeMap[j]] = false;
               add(_x[_nodeMap[j]] <= rhs, IloCplex::UseCutPurge).end();
               
               ++nCuts;
-              if (nestedCut) ++nNestedCuts;
-            }
-          }
-          
-          if (backCuts)
-          {
-            // add violated constraints for all nodes j in bwdS with x_j >= x_i
-            constructRHS(rhs, bwdDS, bwdS);
-            for (NodeSetIt it2 = bwdS.begin(); it2 != bwdS.end(); ++it2)
-            {
-              const Node j = *it2;
-              const double x_j_value = x_values[_nodeMap[j]];
-              
-              if (_tol.less(minCutValue, x_j_value))
-              {
-                assert(isValid(j, bwdDS, bwdS));
-                
-                _pNodeBoolMap->set(j, false);
-                add(_x[_nodeMap[j]] <= rhs, IloCplex::UseCutPurge).end();
-                
-                ++nCuts;
-                ++nBackCuts;
-              }
+              ++nBackCuts;
             }
           }
-          
-          // generate nested-cuts
-//          for (NodeSetIt nodeIt = fwdS.begin(); nodeIt != fwdS.end(); ++nodeIt)
-//          {
-//            nestedCut = true;
-//            // update the capactity to generate nested-cuts
-////            _pBK->incCap(DiOutArcIt(_h, (*_pG2h1)[*nodeIt]), 1);
-//            _pBK->incCap((*_pG2hRootArc)[*nodeIt], 1);
-//          }
         }
-//        else
-//        {
-//          break;
-//        }
+        
+        if (!_nestedCuts)
+          break;
+        
+        // generate nested-cuts: the arcs of this cut get a capacity of at
+        // least 1, so a violated cut found next is disjoint from it. As a
+        // violated cut does not contain such an arc, its value is the same
+        // as for the original capacities.
+        nestedCut = true;
+        for (NodeSetIt nodeIt = fwdS.begin(); nodeIt != fwdS.end(); ++nodeIt)
+        {
+          _pBK->incCap(_g2hRootArc[_nodeMap[*nodeIt]], 1);
+        }
+        for (NodeSetIt nodeIt = fwdDS.begin(); nodeIt != fwdDS.end(); ++nodeIt)
+        {
+          _pBK->incCap(DiOutArcIt(_h, _g2h1[_nodeMap[*nodeIt]]), 1);
+        }
+      }
+      
+      // the next target needs the original capacities
+      if (nestedCut)
+      {
+        reuse = false;
       }
     }
     
@@ -442,16 +439,16 @@ protected:
 //    BkAlg bk(h, cap);
 //
 //    bk.setSource(diRoot);
-//    _pNodeBoolMap->set(root, false);
+//    _candidate[_nodeMap[root]] = false;
 //    for (NodeSetIt it = nonZeroComponent.begin(); it != nonZeroComponent.end(); ++it)
 //    {
 //      Node i = *it;
 //      // skip if node was already considered or its x-value is 0
-//      if (!(*_pNodeBoolMap)[i]) continue;
+//      if (!_candidate[_nodeMap[i]]) continue;
 //      
 //      const double x_i_value = x_values[_nodeMap[i]];
 //
-//      bk.setTarget((*_pG2h2)[i]);
+//      bk.setTarget(_g2h2[_nodeMap[i]]);
 //      bk.setCap(cap);
 //
 //      bool nestedCut = false;
@@ -514,7 +511,7 @@ protected:
 //              assert(isValid(j, fwdDS, fwdS));
 ////              std::cerr << x_j_value - minCutValue << std::endl;
 //              
-//              _pNodeBoolMap->set(j, false);
+//              _candidate[_nodeMap[j]] = false;
 //              add(_x[_nodeMap[j]] <= rhs, IloCplex::UseCutPurge).end();
 //              
 //              ++nCuts;
@@ -535,7 +532,7 @@ protected:
 //              {
 //                assert(isValid(j, bwdDS, bwdS));
 //                
-//                _pNodeBoolMap->set(j, false);
+//                _candidate[_nodeMap[j]] = false;
 //                add(_x[_nodeMap[j]] <= rhs, IloCplex::UseCutPurge).end();
 //                
 //                ++nCuts;
@@ -549,7 +546,7 @@ protected:
 //          {
 //            nestedCut = true;
 //            // update the capactity to generate nested-cuts
-//            bk.incCap(DiOutArcIt(h, (*_pG2h1)[*nodeIt]), 1);
+//            bk.incCap(DiOutArcIt(h, _g2h1[_nodeMap[*nodeIt]]), 1);
 //          }
 //        }
 //        else
@@ -562,7 +559,7 @@ protected:
 //    rhs.end();
 //  }
   
-  void separate()
+  int separate()
   {
     IloNumArray x_values(getEnv(), _n);
     getValues(x_values, _x);
@@ -572,22 +569,18 @@ protected:
     
     // determine connected components
     NodeSet rootNodes = computeCapacities(_cap, x_values, y_values);
-    NodeSetVector nonZeroComponents = determineConnectedComponents(x_values);
+    const NodeVectorVector& nonZeroComponents = determineConnectedComponents(x_values);
     
     int nCuts = 0;
     int nBackCuts = 0;
     int nNestedCuts = 0;
 
-    for (NodeSetVectorIt it = nonZeroComponents.begin(); it != nonZeroComponents.end(); ++it)
+    const int nComp = static_cast<int>(nonZeroComponents.size());
+    for (int compIdx = 0; compIdx < nComp; ++compIdx)
     {
-      const NodeSet& nonZeroComponent = *it;
+      const NodeVector& nonZeroComponent = nonZeroComponents[compIdx];
       
-      NodeSet intersection;
-      std::set_intersection(rootNodes.begin(), rootNodes.end(),
-                            nonZeroComponent.begin(), nonZeroComponent.end(),
-                            std::inserter(intersection, intersection.begin()));
-      
-      if (_nodeNumber == 0 || intersection.size() > 0)
+      if (_nodeNumber == 0 || intersects(compIdx, rootNodes))
       {
         separateMinCut(nonZeroComponent, x_values, y_values, nCuts, nBackCuts, nNestedCuts);
       }
@@ -600,6 +593,8 @@ protected:
     x_values.end();
     y_values.end();
     
+    g_callbackStats.addCuts(CallbackStats::USER_CUT, nCuts);
+    
 //    std::cerr << "[";
 //    for (NodeSetVectorIt it = nonZeroComponents.begin(); it != nonZeroComponents.end(); ++it)
 //    {
@@ -621,6 +616,8 @@ protected:
 //                << nNestedCuts << " are nested cuts" << std::endl;
 //    }
     //std::cerr << "Time: " << t.realTime() << "s" << std::endl;
+    
+    return nCuts;
   }
   
   
@@ -729,8 +726,8 @@ protected:
     {
       DiNode i1 = _h.addNode();
       DiNode i2 = _h.addNode();
-      _pG2h1->set(i, i1);
-      _pG2h2->set(i, i2);
+      _g2h1[_nodeMap[i]] = i1;
+      _g2h2[_nodeMap[i]] = i2;
       _h2g[i1] = i;
       _h2g[i2] = i;
       
@@ -738,7 +735,7 @@ protected:
       _cap[i1i2] = 0;
       
       DiArc ri1 = _h.addArc(diRoot, i1);
-      _pG2hRootArc->set(i, ri1);
+      _g2hRootArc[_nodeMap[i]] = ri1;
       _cap[ri1] = 1;
     }
     
@@ -746,10 +743,10 @@ protected:
     {
       Node i = _g.u(e);
       Node j = _g.v(e);
-      DiNode i1 = (*_pG2h1)[i];
-      DiNode i2 = (*_pG2h2)[i];
-      DiNode j1 = (*_pG2h1)[j];
-      DiNode j2 = (*_pG2h2)[j];
+      DiNode i1 = _g2h1[_nodeMap[i]];
+      DiNode i2 = _g2h2[_nodeMap[i]];
+      DiNode j1 = _g2h1[_nodeMap[j]];
+      DiNode j2 = _g2h2[_nodeMap[j]];
       
       DiArc i2j1 = _h.addArc(i2, j1);
       DiArc j2i1 = _h.addArc(j2, i1);
@@ -757,7 +754,7 @@ protected:
     }
   }
   
-  void init(const NodeSet& nonZeroComponent,
+  void init(const NodeVector& nonZeroComponent,
             const Node root,
             const IloNumArray& x_values,
             const IloNumArray& y_values,
@@ -768,12 +765,12 @@ protected:
   {
     NodeSet shell;
     
-    lemon::mapFill(_g, *_pG2h1, lemon::INVALID);
-    lemon::mapFill(_g, *_pG2h2, lemon::INVALID);
+    std::fill(_g2h1.begin(), _g2h1.end(), DiNode(lemon::INVALID));
+    std::fill(_g2h2.begin(), _g2h2.end(), DiNode(lemon::INVALID));
     
     h.clear();
     diRoot = h.addNode();
-    for (NodeSetIt it = nonZeroComponent.begin(); it != nonZeroComponent.end(); ++it)
+    for (NodeVectorIt it = nonZeroComponent.begin(); it != nonZeroComponent.end(); ++it)
     {
       const Node i = *it;
       
@@ -782,8 +779,8 @@ protected:
       
       DiNode i1 = h.addNode();
       DiNode i2 = h.addNode();
-      _pG2h1->set(i, i1);
-      _pG2h2->set(i, i2);
+      _g2h1[_nodeMap[i]] = i1;
+      _g2h2[_nodeMap[i]] = i2;
       h2g[i1] = i;
       h2g[i2] = i;
       
@@ -796,7 +793,8 @@ protected:
       for (IncEdgeIt e(_g, i); e != lemon::INVALID; ++e)
       {
         Node j = _g.oppositeNode(i, e);
-        if ((*_pG2h1)[j] == lemon::INVALID && nonZeroComponent.find(j) == nonZeroComponent.end())
+        // nonZeroComponent stems from determineConnectedComponents()
+        if (_g2h1[_nodeMap[j]] == lemon::INVALID && !inComponent(_comp[_nodeMap[i]], j))
         {
           shell.insert(j);
           
@@ -807,8 +805,8 @@ protected:
           
           DiNode j1 = h.addNode();
           DiNode j2 = h.addNode();
-          _pG2h1->set(j, j1);
-          _pG2h2->set(j, j2);
+          _g2h1[_nodeMap[j]] = j1;
+          _g2h2[_nodeMap[j]] = j2;
           h2g[j1] = j;
           h2g[j2] = j;
           
@@ -827,10 +825,10 @@ protected:
       Node i = _g.u(e);
       Node j = _g.v(e);
       
-      DiNode i1 = (*_pG2h1)[i];
-      DiNode i2 = (*_pG2h2)[i];
-      DiNode j1 = (*_pG2h1)[j];
-      DiNode j2 = (*_pG2h2)[j];
+      DiNode i1 = _g2h1[_nodeMap[i]];
+      DiNode i2 = _g2h2[_nodeMap[i]];
+      DiNode j1 = _g2h1[_nodeMap[j]];
+      DiNode j2 = _g2h2[_nodeMap[j]];
       
       if (i1 != lemon::INVALID && j1 != lemon::INVALID)
       {
@@ -856,14 +854,14 @@ protected:
       double val = x_values[_nodeMap[v]];
       if (!_tol.nonZero(val))
       {
-        _pNodeBoolMap->set(v, false);
+        _candidate[_nodeMap[v]] = false;
         val = 10 * _cutEpsilon;
       }
       else
       {
-        _pNodeBoolMap->set(v, true);
+        _candidate[_nodeMap[v]] = true;
       }
-      DiNode v1 = (*_pG2h1)[v];
+      DiNode v1 = _g2h1[_nodeMap[v]];
       capacity[DiOutArcIt(_h, v1)] = val;
       
       // cap((r,i)) = y_i
@@ -876,7 +874,7 @@ protected:
       {
         rootNodes.insert(v);
       }
-      capacity[(*_pG2hRootArc)[v]] = val;
+      capacity[_g2hRootArc[_nodeMap[v]]] = val;
     }
     
     return rootNodes;
@@ -0,0 +1,355 @@
+/*
+ * nodecutunrootedcuttree.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef NODECUTUNROOTEDCUTTREE_H
+#define NODECUTUNROOTEDCUTTREE_H
+
+#include "nodecutuser.h"
+#include <lemon/smart_graph.h>
+#include <lemon/gomory_hu.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace nina {
+namespace mwcs {
+
+/// \brief Separation of node cuts using a Gomory-Hu cut tree
+///
+/// Instead of solving a max-flow per fractional node, a cut tree is built
+/// once per LP on the undirected support graph: its nodes are the nodes with
+/// nonzero x plus an auxiliary root r, edge (u,v) has capacity min(x_u, x_v)
+/// and edge (r,v) has capacity y_v. Gusfield's algorithm needs one max-flow
+/// per support node. The minimum capacity tree edge on the path from r to
+/// node i bounds the node cut separating i: for the side C of that edge, the
+/// node of smaller x of every edge leaving C is moved to the separator N.
+/// Every violated tree edge then gives cuts x_i <= x(N(S)) + y(S) for the
+/// connected components S of C \ N.
+template<typename GR,
+         typename NWGHT = typename GR::template NodeMap<double>,
+         typename NLBL = typename GR::template NodeMap<std::string>,
+         typename EWGHT = typename GR::template EdgeMap<double> >
+class NodeCutUnrootedCutTreeUserCut : public NodeCutUser<GR, NWGHT, NLBL, EWGHT>
+{
+public:
+  typedef GR Graph;
+  typedef NWGHT WeightNodeMap;
+  typedef NLBL LabelNodeMap;
+  typedef EWGHT WeightEdgeMap;
+  typedef NodeCutUser<GR, NWGHT, NLBL, EWGHT> Parent;
+
+protected:
+  TEMPLATE_GRAPH_TYPEDEFS(Graph);
+  typedef typename Parent::NodeVector NodeVector;
+  typedef typename Parent::NodeVectorIt NodeVectorIt;
+
+  typedef lemon::SmartGraph SupportGraph;
+  typedef SupportGraph::Node SNode;
+  typedef SupportGraph::Edge SEdge;
+  typedef SupportGraph::EdgeMap<double> SCapacityMap;
+  typedef lemon::GomoryHu<SupportGraph, SCapacityMap> GomoryHuType;
+  typedef std::vector<int> IntVector;
+  typedef std::vector<IntVector> IntMatrix;
+  typedef std::vector<double> DoubleVector;
+
+  using Parent::_x;
+  using Parent::_y;
+  using Parent::_g;
+  using Parent::_nodeMap;
+  using Parent::_n;
+  using Parent::_tol;
+  using Parent::_S;
+  using Parent::_dS;
+
+  using Parent::add;
+  using Parent::getEnv;
+  using Parent::getValues;
+  using Parent::constructRHS;
+  using Parent::isValid;
+  using Parent::determineNeighborhood;
+
+  friend class NodeCut<GR, NWGHT, NLBL, EWGHT>;
+
+  /// Support node id of every node (by variable index), -1 if x is zero
+  IntVector _g2s;
+  /// Stamps of the support nodes, reset by incrementing _stamp
+  IntVector _inC;
+  IntVector _inN;
+  IntVector _visited;
+  int _stamp;
+
+public:
+  NodeCutUnrootedCutTreeUserCut(IloEnv env,
+                                IloBoolVarArray x,
+                                IloBoolVarArray y,
+                                const Graph& g,
+                                const WeightNodeMap& weight,
+                                const IntNodeMap& nodeMap,
+                                int n,
+                                int maxNumberOfCuts,
+                                BackOff backOff)
+    : Parent(env, x, y, g, weight, nodeMap, n, maxNumberOfCuts, backOff,
+             false, false)
+    , _g2s(n, -1)
+    , _inC(n + 1, 0)
+    , _inN(n + 1, 0)
+    , _visited(n + 1, 0)
+    , _stamp(0)
+  {
+  }
+
+  NodeCutUnrootedCutTreeUserCut(const NodeCutUnrootedCutTreeUserCut& other)
+    : Parent(other)
+    , _g2s(other._g2s)
+    , _inC(other._n + 1, 0)
+    , _inN(other._n + 1, 0)
+    , _visited(other._n + 1, 0)
+    , _stamp(0)
+  {
+  }
+
+  virtual ~NodeCutUnrootedCutTreeUserCut()
+  {
+  }
+
+protected:
+  virtual IloCplex::CallbackI* duplicateCallback() const
+  {
+    return (new (getEnv()) NodeCutUnrootedCutTreeUserCut(*this));
+  }
+
+  int separate()
+  {
+    int nCuts = 0;
+    IloNumArray x_values(getEnv(), _n);
+    getValues(x_values, _x);
+
+    IloNumArray y_values(getEnv(), _n);
+    getValues(y_values, _y);
+
+    // support graph, node 0 is the auxiliary root
+    SupportGraph sg;
+    SCapacityMap cap(sg);
+    NodeVector s2g;
+
+    sg.addNode();
+    s2g.push_back(lemon::INVALID);
+    for (NodeIt v(_g); v != lemon::INVALID; ++v)
+    {
+      const int idx_v = _nodeMap[v];
+      if (_tol.nonZero(x_values[idx_v]))
+      {
+        _g2s[idx_v] = sg.id(sg.addNode());
+        s2g.push_back(v);
+      }
+      else
+      {
+        _g2s[idx_v] = -1;
+      }
+    }
+
+    const int nSupport = static_cast<int>(s2g.size());
+    if (nSupport > 1)
+    {
+      for (EdgeIt e(_g); e != lemon::INVALID; ++e)
+      {
+        const int idx_u = _nodeMap[_g.u(e)];
+        const int idx_v = _nodeMap[_g.v(e)];
+        if (_g2s[idx_u] != -1 && _g2s[idx_v] != -1)
+        {
+          SEdge f = sg.addEdge(sg.nodeFromId(_g2s[idx_u]), sg.nodeFromId(_g2s[idx_v]));
+          cap[f] = std::min(x_values[idx_u], x_values[idx_v]);
+        }
+      }
+      for (int s = 1; s < nSupport; ++s)
+      {
+        const int idx_v = _nodeMap[s2g[s]];
+        if (_tol.nonZero(y_values[idx_v]))
+        {
+          SEdge f = sg.addEdge(sg.nodeFromId(0), sg.nodeFromId(s));
+          cap[f] = y_values[idx_v];
+        }
+      }
+
+      GomoryHuType gh(sg, cap);
+      gh.run();
+      g_callbackStats.addMaxFlows(CallbackStats::USER_CUT, nSupport - 1);
+
+      nCuts = separateCutTree(sg, gh, s2g, x_values, y_values);
+      g_callbackStats.addCuts(CallbackStats::USER_CUT, nCuts);
+    }
+
+    x_values.end();
+    y_values.end();
+    
+    return nCuts;
+  }
+
+  int separateCutTree(const SupportGraph& sg,
+                       const GomoryHuType& gh,
+                       const NodeVector& s2g,
+                       const IloNumArray& x_values,
+                       const IloNumArray& y_values)
+  {
+    const int nSupport = static_cast<int>(s2g.size());
+
+    // tree edge s is the edge between s and its predecessor in gh
+    IntVector pred(nSupport, -1);
+    DoubleVector value(nSupport, 0);
+    IntMatrix adj(nSupport);
+    for (int s = 0; s < nSupport; ++s)
+    {
+      SNode p = gh.predNode(sg.nodeFromId(s));
+      if (p != lemon::INVALID)
+      {
+        pred[s] = sg.id(p);
+        value[s] = gh.predValue(sg.nodeFromId(s));
+        adj[s].push_back(pred[s]);
+        adj[pred[s]].push_back(s);
+      }
+    }
+
+    // root the tree at r, keeping the minimum edge on the path from r
+    IntVector parent(nSupport, -1);
+    IntVector minEdge(nSupport, -1);
+    DoubleVector minValue(nSupport, std::numeric_limits<double>::max());
+    IntVector order(1, 0);
+    IntMatrix children(nSupport);
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+      const int u = order[k];
+      for (size_t l = 0; l < adj[u].size(); ++l)
+      {
+        const int v = adj[u][l];
+        if (v == parent[u]) continue;
+
+        const int e = pred[v] == u ? v : u;
+        parent[v] = u;
+        children[u].push_back(v);
+        if (value[e] < minValue[u])
+        {
+          minValue[v] = value[e];
+          minEdge[v] = e;
+        }
+        else
+        {
+          minValue[v] = minValue[u];
+          minEdge[v] = minEdge[u];
+        }
+        order.push_back(v);
+      }
+    }
+
+    // collect the violated tree edges, i.e. x_i > lambda(r, i)
+    IntVector violated;
+    ++_stamp;
+    for (int s = 1; s < nSupport; ++s)
+    {
+      const int e = minEdge[s];
+      if (_tol.less(minValue[s], x_values[_nodeMap[s2g[s]]]) && _inC[e] != _stamp)
+      {
+        _inC[e] = _stamp;
+        violated.push_back(e);
+      }
+    }
+
+    int nCuts = 0;
+    IloExpr rhs(getEnv());
+    for (size_t k = 0; k < violated.size(); ++k)
+    {
+      const int e = violated[k];
+      const int c = parent[e] == pred[e] ? e : pred[e];
+
+      // C is the subtree of c
+      ++_stamp;
+      IntVector C(1, c);
+      _inC[c] = _stamp;
+      for (size_t l = 0; l < C.size(); ++l)
+      {
+        for (size_t m = 0; m < children[C[l]].size(); ++m)
+        {
+          const int v = children[C[l]][m];
+          _inC[v] = _stamp;
+          C.push_back(v);
+        }
+      }
+
+      // move the node of smaller x of every edge leaving C to N
+      for (size_t l = 0; l < C.size(); ++l)
+      {
+        const Node u = s2g[C[l]];
+        const double x_u = x_values[_nodeMap[u]];
+        for (IncEdgeIt a(_g, u); a != lemon::INVALID; ++a)
+        {
+          const Node w = _g.oppositeNode(u, a);
+          const int t = _g2s[_nodeMap[w]];
+          if (t != -1 && _inC[t] != _stamp)
+          {
+            _inN[x_u < x_values[_nodeMap[w]] ? C[l] : t] = _stamp;
+          }
+        }
+      }
+
+      // components S of C \ N
+      for (size_t l = 0; l < C.size(); ++l)
+      {
+        const int s = C[l];
+        if (_inN[s] == _stamp || _visited[s] == _stamp) continue;
+
+        NodeVector S(1, s2g[s]);
+        _visited[s] = _stamp;
+        for (size_t m = 0; m < S.size(); ++m)
+        {
+          for (IncEdgeIt a(_g, S[m]); a != lemon::INVALID; ++a)
+          {
+            const int t = _g2s[_nodeMap[_g.oppositeNode(S[m], a)]];
+            if (t != -1 && _inC[t] == _stamp && _inN[t] != _stamp && _visited[t] != _stamp)
+            {
+              _visited[t] = _stamp;
+              S.push_back(s2g[t]);
+            }
+          }
+        }
+
+        determineNeighborhood(S);
+
+        double rhsValue = 0;
+        for (NodeVectorIt it = _dS.begin(); it != _dS.end(); ++it)
+        {
+          rhsValue += x_values[_nodeMap[*it]];
+        }
+        for (NodeVectorIt it = S.begin(); it != S.end(); ++it)
+        {
+          rhsValue += y_values[_nodeMap[*it]];
+        }
+
+        bool first = true;
+        for (NodeVectorIt it = S.begin(); it != S.end(); ++it)
+        {
+          if (_tol.less(rhsValue, x_values[_nodeMap[*it]]))
+          {
+            if (first)
+            {
+              constructRHS(rhs, _dS, S);
+              first = false;
+            }
+            assert(isValid(*it, _dS, S));
+            add(_x[_nodeMap[*it]] <= rhs, IloCplex::UseCutPurge).end();
+            ++nCuts;
+          }
+        }
+      }
+    }
+    rhs.end();
+    
+    return nCuts;
+  }
+};
+
+} // namespace mwcs
+} // namespace nina
+
+#endif // NODECUTUNROOTEDCUTTREE_H
@@ -46,11 +46,8 @@ public:
   using Parent::_n;
   using Parent::_maxNumberOfCuts;
   using Parent::_tol;
-  using Parent::_pNodeBoolMap;
-  using Parent::_pMutex;
+  using Parent::_candidate;
   using Parent::_epsilon;
-  using Parent::lock;
-  using Parent::unlock;
   
 protected:
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
@@ -64,17 +61,14 @@ protected:
   typedef typename Digraph::OutArcIt DiOutArcIt;
   
   typedef typename Digraph::template NodeMap<Node> DiNodeNodeMap;
-  typedef typename Graph::template NodeMap<DiNode> NodeDiNodeMap;
-  typedef typename Graph::template NodeMap<DiArc> NodeDiArcMap;
+  typedef std::vector<DiNode> DiNodeVector;
+  typedef std::vector<DiArc> DiArcVector;
   typedef typename Digraph::ArcMap<double> CapacityMap;
   
   typedef typename Parent::NodeSet NodeSet;
   typedef typename Parent::NodeSetIt NodeSetIt;
   typedef typename Parent::NodeSetVector NodeSetVector;
   typedef typename Parent::NodeSetVectorIt NodeSetVectorIt;
-  typedef typename Parent::SubGraph SubGraph;
-  typedef typename Parent::SubNodeIt SubNodeIt;
-  typedef typename Parent::SubEdgeIt SubEdgeIt;
   typedef typename Parent::NodeQueue NodeQueue;
 
   typedef std::queue<DiNode> DiNodeQueue;
@@ -89,9 +83,11 @@ protected:
 protected:
   Digraph _h;
   CapacityMap _cap;
-  NodeDiNodeMap* _pG2h1;
-  NodeDiNodeMap* _pG2h2;
-  NodeDiArcMap* _pG2hRootArc;
+  /// Nodes i1 and i2 of _h of every node i (by variable index)
+  DiNodeVector _g2h1;
+  DiNodeVector _g2h2;
+  /// Arc from the root to i1 (unrooted only)
+  DiArcVector _g2hRootArc;
   DiNodeNodeMap _h2g;
   DiNodeSet _diRootSet;
   BkAlg* _pBK;
@@ -99,6 +95,14 @@ protected:
   
   int _cutCount;
   int _nodeNumber;
+  /// Number of cuts added in the previous round at the current node
+  int _lastCutCount;
+  
+  /// Whether to generate nested cuts, i.e. to raise the capacities of a
+  /// violated cut and to separate the same target again
+  const bool _nestedCuts;
+  /// Whether to add the cut closest to the target as well
+  const bool _backCuts;
   
 protected:
   static constexpr double _cutEpsilon = 0.00001 * _epsilon;
@@ -115,29 +119,29 @@ public:
               const IntNodeMap& nodeMap,
               int n,
               int maxNumberOfCuts,
-              IloFastMutex* pMutex,
-              const BackOff& backOff)
+              const BackOff& backOff,
+              bool nestedCuts,
+              bool backCuts)
     : IloCplex::UserCutCallbackI(env)
-    , Parent(x, y, g, weight, nodeMap, n, maxNumberOfCuts, pMutex)
+    , Parent(x, y, g, weight, nodeMap, n, maxNumberOfCuts)
     , _h()
     , _cap(_h)
-    , _pG2h1(NULL)
-    , _pG2h2(NULL)
-    , _pG2hRootArc(NULL)
+    , _g2h1(n, lemon::INVALID)
+    , _g2h2(n, lemon::INVALID)
+    , _g2hRootArc(n, lemon::INVALID)
     , _h2g(_h)
     , _diRootSet()
     , _pBK(NULL)
     , _marked(_h, false)
     , _cutCount(0)
     , _nodeNumber(0)
+    , _lastCutCount(0)
+    , _nestedCuts(nestedCuts)
+    , _backCuts(backCuts)
     , _cutTol(_cutEpsilon)
     , _backOff(backOff)
     , _makeAttempt(true)
   {
-    lock();
-    _pG2h1 = new NodeDiNodeMap(_g);
-    _pG2h2 = new NodeDiNodeMap(_g);
-    unlock();
   }
   
   NodeCutUser(const NodeCutUser& other)
@@ -145,15 +149,18 @@ public:
     , Parent(other)
     , _h()
     , _cap(_h)
-    , _pG2h1(NULL)
-    , _pG2h2(NULL)
-    , _pG2hRootArc(NULL)
+    , _g2h1(other._n, lemon::INVALID)
+    , _g2h2(other._n, lemon::INVALID)
+    , _g2hRootArc(other._n, lemon::INVALID)
     , _h2g(_h)
     , _diRootSet()
     , _pBK(NULL)
     , _marked(_h, false)
     , _cutCount(0)
     , _nodeNumber(0)
+    , _lastCutCount(0)
+    , _nestedCuts(other._nestedCuts)
+    , _backCuts(other._backCuts)
     , _cutTol(other._cutTol)
     , _backOff(other._backOff)
     , _makeAttempt(other._makeAttempt)
@@ -164,12 +171,6 @@ public:
   virtual ~NodeCutUser()
   {
     delete _pBK;
-    
-    lock();
-    delete _pG2h1;
-    delete _pG2h2;
-    delete _pG2hRootArc;
-    unlock();
   }
   
 protected:
@@ -184,17 +185,26 @@ protected:
     {
       _nodeNumber = getNnodes();
       _cutCount = 0;
+      _lastCutCount = 0;
       _makeAttempt = _backOff.makeAttempt();
+      _backOff.startNode();
     }
     
-    if (_makeAttempt && (_cutCount < _maxNumberOfCuts || _cutCount == -1 || (_nodeNumber == 0 && _cutCount < 50)))
+    if (!_makeAttempt)
+      return;
+    
+    if (_backOff.adaptive()
+          ? _backOff.continueCutLoop(getObjValue(), _lastCutCount)
+          : (_cutCount < _maxNumberOfCuts || _cutCount == -1 || (_nodeNumber == 0 && _cutCount < 50)))
     {
-      separate();
+      CallbackStats::Scope scope(g_callbackStats, CallbackStats::USER_CUT);
+      _lastCutCount = separate();
       ++_cutCount;
     }
   }
   
-  virtual void separate() = 0;
+  /// Adds violated cuts, returns the number of added cuts
+  virtual int separate() = 0;
   
   void determineFwdCutSet(const Digraph& h,
                           const BkAlg& bk,
@@ -211,6 +221,17 @@ protected:
     queue.push(diRoot);
     marked[diRoot] = true;
     
+    // previous targets of a reused flow may still hold flow themselves
+    const typename BkAlg::NodeVector& supplyNodes = bk.getSupplyNodes();
+    for (size_t k = 0; k < supplyNodes.size(); ++k)
+    {
+      if (!marked[supplyNodes[k]] && _cutTol.nonZero(bk.supply(supplyNodes[k])))
+      {
+        queue.push(supplyNodes[k]);
+        marked[supplyNodes[k]] = true;
+      }
+    }
+    
     while (!queue.empty())
     {
       DiNode v = queue.front();
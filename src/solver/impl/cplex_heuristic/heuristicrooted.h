@@ -9,12 +9,13 @@
 #define HEURISTICROOTED_H
 
 #include <ilcplex/ilocplex.h>
-#include <ilconcert/ilothread.h>
 #include <lemon/adaptors.h>
 #include <lemon/bfs.h>
-#include <lemon/kruskal.h>
 #include <set>
+#include <vector>
 #include "solver/impl/treesolverrootedimpl.h"
+#include "solver/impl/spanningtreebuilder.h"
+#include "solver/impl/callbackstats.h"
 
 namespace nina {
 namespace mwcs {
@@ -37,8 +38,10 @@ protected:
   typedef MwcsGraph<const SubGraphType, const WeightNodeMap, LabelNodeMap, DoubleEdgeMap> MwcsSubGraphType;
   typedef TreeSolverRootedImpl<const SubGraphType, const WeightNodeMap, LabelNodeMap, DoubleEdgeMap> TreeSolverRootedImplType;
   typedef typename MwcsSubGraphType::BoolNodeMap SubBoolNodeMap;
+  typedef SpanningTreeBuilder<Graph, DoubleEdgeMap, BoolEdgeMap> SpanningTreeBuilderType;
   typedef typename std::set<Node> NodeSet;
   typedef typename NodeSet::const_iterator NodeSetIt;
+  typedef std::vector<Node> NodeVector;
   
 public:
   HeuristicRooted(IloEnv env,
@@ -50,15 +53,15 @@ public:
                   const IntNodeMap& nodeMap,
 //                  const IntEdgeMap& edgeMap,
                   int n,
-                  int m,
-                  IloFastMutex* pMutex)
+                  int m)
     : IloCplex::HeuristicCallbackI(env)
     , _x(x)
 //    , _z(z)
-    , _g(g)
-    , _weight(weight)
-    , _rootNodes(rootNodes)
-    , _nodeMap(nodeMap)
+    , _g()
+    , _weight(_g)
+    , _rootNodes()
+    , _nodeMap(_g)
+    , _node(n, lemon::INVALID)
 //    , _edgeMap(edgeMap)
     , _n(n)
     , _m(m)
@@ -68,27 +71,20 @@ public:
     , _pSubSolutionMap(NULL)
     , _pMwcsSubGraph(NULL)
     , _pMwcsSubTreeSolver(NULL)
-    , _pMutex(pMutex)
+    , _pSpanningTreeBuilder(NULL)
   {
-    lock();
-    _pEdgeCost = new DoubleEdgeMap(_g);
-    _pEdgeFilterMap = new BoolEdgeMap(_g, false);
-    _pSubG = new SubGraphType(_g, *_pEdgeFilterMap);
-    _pSubSolutionMap = new SubBoolNodeMap(*_pSubG, false);
-    _pMwcsSubGraph = new MwcsSubGraphType();
-    _pMwcsSubGraph->init(_pSubG, NULL, &_weight, NULL);
-    _pMwcsSubTreeSolver = new TreeSolverRootedImplType();
-    unlock();
+    init(g, weight, nodeMap, rootNodes);
   }
   
   HeuristicRooted(const HeuristicRooted& other)
     : IloCplex::HeuristicCallbackI(other._env)
     , _x(other._x)
 //    , _z(other._z)
-    , _g(other._g)
-    , _weight(other._weight)
-    , _rootNodes(other._rootNodes)
-    , _nodeMap(other._nodeMap)
+    , _g()
+    , _weight(_g)
+    , _rootNodes()
+    , _nodeMap(_g)
+    , _node(other._n, lemon::INVALID)
 //    , _edgeMap(other._edgeMap)
     , _n(other._n)
     , _m(other._m)
@@ -98,34 +94,27 @@ public:
     , _pSubSolutionMap(NULL)
     , _pMwcsSubGraph(NULL)
     , _pMwcsSubTreeSolver(NULL)
-    , _pMutex(other._pMutex)
+    , _pSpanningTreeBuilder(NULL)
   {
-    lock();
-    _pEdgeCost = new DoubleEdgeMap(_g);
-    _pEdgeFilterMap = new BoolEdgeMap(_g, false);
-    _pSubG = new SubGraphType(_g, *_pEdgeFilterMap);
-    _pSubSolutionMap = new SubBoolNodeMap(*_pSubG, false);
-    _pMwcsSubGraph = new MwcsSubGraphType();
-    _pMwcsSubGraph->init(_pSubG, NULL, &_weight, NULL);
-    _pMwcsSubTreeSolver = new TreeSolverRootedImplType();
-    unlock();
+    init(other._g, other._weight, other._nodeMap, other._rootNodes);
   }
   
   ~HeuristicRooted()
   {
-    lock();
+    delete _pSpanningTreeBuilder;
     delete _pMwcsSubTreeSolver;
     delete _pMwcsSubGraph;
     delete _pEdgeCost;
     delete _pEdgeFilterMap;
     delete _pSubSolutionMap;
     delete _pSubG;
-    unlock();
   }
   
 protected:
   virtual void main()
   {
+    CallbackStats::Scope scope(g_callbackStats, CallbackStats::HEURISTIC);
+    
     computeEdgeWeights();
     computeMinimumCostSpanningTree();
     
@@ -147,22 +136,49 @@ protected:
     return (new (_env) HeuristicRooted(*this));
   }
   
-  void lock()
-  {
-    if (_pMutex)
-      _pMutex->lock();
-  }
-  
-  void unlock()
+  /// Copies \c g into the private graph _g, on which all maps of this
+  /// callback live. Maps attached to a graph register with it, so sharing
+  /// the graph would require locking in every thread. The copy is made
+  /// without graphCopy(), which would attach a map to \c g as well.
+  void init(const Graph& g,
+            const WeightNodeMap& weight,
+            const IntNodeMap& nodeMap,
+            const NodeSet& rootNodes)
   {
-    if (_pMutex)
-      _pMutex->unlock();
+    for (NodeIt v(g); v != lemon::INVALID; ++v)
+    {
+      const int idx_v = nodeMap[v];
+      const Node u = _g.addNode();
+      _node[idx_v] = u;
+      _nodeMap.set(u, idx_v);
+      _weight.set(u, weight[v]);
+    }
+    
+    for (EdgeIt e(g); e != lemon::INVALID; ++e)
+    {
+      _g.addEdge(_node[nodeMap[g.u(e)]], _node[nodeMap[g.v(e)]]);
+    }
+    
+    for (NodeSetIt it = rootNodes.begin(); it != rootNodes.end(); ++it)
+    {
+      _rootNodes.insert(_node[nodeMap[*it]]);
+    }
+    
+    _pEdgeCost = new DoubleEdgeMap(_g);
+    _pEdgeFilterMap = new BoolEdgeMap(_g, false);
+    _pSubG = new SubGraphType(_g, *_pEdgeFilterMap);
+    _pSubSolutionMap = new SubBoolNodeMap(*_pSubG, false);
+    _pMwcsSubGraph = new MwcsSubGraphType();
+    _pMwcsSubGraph->init(_pSubG, NULL, &_weight, NULL);
+    _pMwcsSubTreeSolver = new TreeSolverRootedImplType();
+    _pSpanningTreeBuilder = new SpanningTreeBuilderType(_g);
   }
   
   void setCplexSolution(IloBoolVarArray solutionVar, IloNumArray solution, double solutionWeight)
   {
     // we can't provide CPLEX the solutionWeight because in the PCST case we use a different objective
     setSolution(solutionVar, solution);
+    g_callbackStats.addImprovement(CallbackStats::HEURISTIC);
   }
   
   void computeEdgeWeights()
@@ -186,9 +202,7 @@ protected:
   
   void computeMinimumCostSpanningTree()
   {
-    lock();
-    lemon::kruskal(_g, *_pEdgeCost, *_pEdgeFilterMap);
-    unlock();
+    _pSpanningTreeBuilder->run(*_pEdgeCost, *_pEdgeFilterMap);
   }
   
   virtual bool computeMaxWeightConnectedSubtree(IloBoolVarArray& solutionVar,
@@ -234,10 +248,12 @@ protected:
 protected:
   IloBoolVarArray _x;
 //  IloBoolVarArray _z;
-  const Graph& _g;
-  const WeightNodeMap& _weight;
+  Graph _g;
+  WeightNodeMap _weight;
   NodeSet _rootNodes;
-  const IntNodeMap& _nodeMap;
+  IntNodeMap _nodeMap;
+  /// Node of _g of every variable index
+  NodeVector _node;
 //  const IntEdgeMap& _edgeMap;
   const int _n;
   const int _m;
@@ -247,7 +263,8 @@ protected:
   SubBoolNodeMap* _pSubSolutionMap;
   MwcsSubGraphType* _pMwcsSubGraph;
   TreeSolverRootedImplType* _pMwcsSubTreeSolver;
-  IloFastMutex* _pMutex;
+  /// Keeps the edge order of the previous B&B node
+  SpanningTreeBuilderType* _pSpanningTreeBuilder;
 };
   
 } // namespace mwcs
@@ -9,7 +9,6 @@
 #define HEURISTICUNROOTED_H
 
 #include <ilcplex/ilocplex.h>
-#include <ilconcert/ilothread.h>
 #include <lemon/adaptors.h>
 #include <lemon/bfs.h>
 #include <lemon/tolerance.h>
@@ -43,7 +42,6 @@ public:
 //  using Parent::_edgeMap;
   using Parent::_n;
   using Parent::_m;
-  using Parent::_pMutex;
   using Parent::_pMwcsSubGraph;
   using Parent::_pSubSolutionMap;
   using Parent::hasIncumbent;
@@ -54,8 +52,6 @@ public:
   using Parent::getValue;
   using Parent::getValues;
   using Parent::setCplexSolution;
-  using Parent::lock;
-  using Parent::unlock;
   
 protected:
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
@@ -69,46 +65,42 @@ public:
   HeuristicUnrooted(IloEnv env,
                     IloBoolVarArray x,
                     IloBoolVarArray y,
+                    IloBoolVarArray s,
 //                    IloBoolVarArray z,
                     const Graph& g,
                     const WeightNodeMap& weight,
                     const IntNodeMap& nodeMap,
 //                    const IntEdgeMap& edgeMap,
                     int n,
-                    int m,
-                    IloFastMutex* pMutex)
-//    : Parent(env, x, z, g, weight, lemon::INVALID, nodeMap, edgeMap, n, m, pMutex)
-    : Parent(env, x, g, weight, NodeSet(), nodeMap, n, m, pMutex)
+                    int m)
+//    : Parent(env, x, z, g, weight, lemon::INVALID, nodeMap, edgeMap, n, m)
+    : Parent(env, x, g, weight, NodeSet(), nodeMap, n, m)
     , _y(y)
+    , _s(s)
     , _tol(_epsilon)
-    , _pMwcsSubTreeUnrootedSolver(NULL)
+    , _pMwcsSubTreeUnrootedSolver(new TreeSolverUnrootedImplType())
   {
-    lock();
-    _pMwcsSubTreeUnrootedSolver = new TreeSolverUnrootedImplType();
-    unlock();
   }
     
   HeuristicUnrooted(const HeuristicUnrooted& other)
     : Parent(other)
     , _y(other._y)
+    , _s(other._s)
     , _tol(other._tol)
-    , _pMwcsSubTreeUnrootedSolver(NULL)
+    , _pMwcsSubTreeUnrootedSolver(new TreeSolverUnrootedImplType())
   {
-    lock();
-    _pMwcsSubTreeUnrootedSolver = new TreeSolverUnrootedImplType();
-    unlock();
   }
     
   ~HeuristicUnrooted()
   {
-    lock();
     delete _pMwcsSubTreeUnrootedSolver;
-    unlock();
   }
 
 protected:
   virtual void main()
   {
+    CallbackStats::Scope scope(g_callbackStats, CallbackStats::HEURISTIC);
+    
     computeEdgeWeights();
     computeMinimumCostSpanningTree();
 //    determineRootNode();
@@ -170,6 +162,9 @@ protected:
       solutionVar.add(_y);
       solution.add(_y.getSize(), 0);
       
+      solutionVar.add(_s);
+      solution.add(_s.getSize(), 0);
+      
       //      solutionVar.add(_z);
       //      solution.add(_z.getSize(), 0);
       
@@ -186,6 +181,19 @@ protected:
       
       solution[_x.getSize() + smallestIdx] = 1;
       
+      // s_k = 1 for the k-th nonnegative node if it does not come after
+      // the root, _s is empty if the symmetry breaking sums are not chained
+      int nNonNegUpToRoot = 0;
+      for (NodeIt v(_g); v != lemon::INVALID; ++v)
+      {
+        if (_weight[v] >= 0 && _nodeMap[v] <= smallestIdx)
+          ++nNonNegUpToRoot;
+      }
+      for (int k = 0; k < nNonNegUpToRoot && k < _s.getSize(); ++k)
+      {
+        solution[_x.getSize() + _y.getSize() + k] = 1;
+      }
+      
 //      for (int i = 0; i < _y.getSize(); ++i)
 //      {
 //        if (solution[i] == 1)
@@ -212,6 +220,7 @@ protected:
   
 protected:
   IloBoolVarArray _y;
+  IloBoolVarArray _s;
   const lemon::Tolerance<double> _tol;
   TreeSolverUnrootedImplType* _pMwcsSubTreeUnrootedSolver;
   
@@ -13,6 +13,7 @@
 #include <ilconcert/ilothread.h>
 #include <limits>
 #include "utils.h"
+#include "solver/impl/callbackstats.h"
 
 namespace nina {
 namespace mwcs {
@@ -38,11 +39,14 @@ protected:
   
   virtual void main()
   {
+    CallbackStats::Scope scope(g_callbackStats, CallbackStats::INCUMBENT);
+    
     lock();
     if (getObjValue() > _highestObj)
     {
       _highestObj = getObjValue();
       *g_pOut << "Solution " << g_timer.realTime() << " " << getObjValue() << std::endl;
+      g_callbackStats.addImprovement(CallbackStats::INCUMBENT);
     }
     unlock();
   }
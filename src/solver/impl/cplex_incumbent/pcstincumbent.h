@@ -15,6 +15,7 @@
 #include <limits>
 #include <set>
 #include "utils.h"
+#include "solver/impl/callbackstats.h"
 #include "mwcsgraph.h"
 
 namespace nina {
@@ -62,11 +63,14 @@ protected:
   
   virtual void main()
   {
+    CallbackStats::Scope scope(g_callbackStats, CallbackStats::INCUMBENT);
+    
     lock();
     if (getObjValue() > _highestObj)
     {
       _highestObj = getObjValue();
       *g_pOut << "Solution " << g_timer.realTime() << " " << -1 * _highestObj + _pT << std::endl;
+      g_callbackStats.addImprovement(CallbackStats::INCUMBENT);
     }
     unlock();
   }
@@ -9,8 +9,10 @@
 #define CPLEXSOLVERIMPL_H
 
 #include "cplex_cut/backoff.h"
+#include "solverimpl.h"
 #include "analysis.h"
 
+#include <math.h>
 #include <set>
 #include <vector>
 
@@ -35,6 +37,10 @@ public:
 
   typedef MwcsGraph<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> MwcsGraphType;
   typedef MwcsAnalyze<Graph> MwcsAnalyzeType;
+  typedef typename MwcsAnalyzeType::NodeSetVector NodeSetVector;
+  typedef typename MwcsAnalyzeType::IntVector IntVector;
+  typedef SolverImpl<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> SolverImplType;
+  typedef typename SolverImplType::StringSet StringSet;
   
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
   
@@ -54,7 +60,12 @@ public:
             int timeLimit,
             int multiThreading,
             int memoryLimit,
-            bool pcst)
+            bool pcst,
+            bool nestedCuts = false,
+            bool backCuts = true,
+            bool cutTree = false,
+            bool minimalSeparators = false,
+            bool branchRoots = false)
       : _backOff(backOff)
       , _analysis(analysis)
       , _maxNumberOfCuts(maxNumberOfCuts)
@@ -63,6 +74,11 @@ public:
       , _multiThreading(multiThreading)
       , _memoryLimit(memoryLimit)
       , _pcst(pcst)
+      , _nestedCuts(nestedCuts)
+      , _backCuts(backCuts)
+      , _cutTree(cutTree)
+      , _minimalSeparators(minimalSeparators)
+      , _branchRoots(branchRoots)
     {
     }
     
@@ -74,6 +90,14 @@ public:
     int _multiThreading;
     int _memoryLimit;
     bool _pcst;
+    bool _nestedCuts;
+    bool _backCuts;
+    /// Whether to separate user cuts using a Gomory-Hu cut tree
+    bool _cutTree;
+    /// Whether to strengthen the lazy constraints using minimal separators
+    bool _minimalSeparators;
+    /// Whether to branch on the root selection variables first (unrooted only)
+    bool _branchRoots;
   };
 
 protected:
@@ -88,11 +112,13 @@ protected:
     , _model(_env)
     , _cplex(_model)
     , _x()
+    , _objective()
   {
   }
   
   virtual ~CplexSolverImpl()
   {
+    delete _pAnalysis;
     _env.end();
   }
 
@@ -124,6 +150,7 @@ protected:
   IloModel _model;
   IloCplex _cplex;
   IloBoolVarArray _x;
+  IloObjective _objective;
 
   virtual void initVariables(const MwcsGraphType& mwcsGraph);
   virtual void initConstraints(const MwcsGraphType& mwcsGraph);
@@ -136,6 +163,15 @@ protected:
                           NodeSet& solutionSet);
   
   virtual bool solveModel() = 0;
+  
+  /// Adds the start module as a MIP start, CPLEX completes the values
+  /// of the remaining variables
+  void addMipStart(const MwcsGraphType& mwcsGraph,
+                   const StringSet& startLabels);
+  
+  /// Prunes nodes whose bound is less than \c LB, nothing is done if
+  /// \c LB is -max
+  void setCutoff(double LB);
 
 private:
   struct NodesDegComp
@@ -183,6 +219,8 @@ void CplexSolverImpl<GR, NWGHT, NLBL, EWGHT>::clean()
   _cplex = IloCplex(_model);
   delete _pNode;
   _pNode = NULL;
+  delete _pAnalysis;
+  _pAnalysis = NULL;
 }
 
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
@@ -233,7 +271,6 @@ inline void CplexSolverImpl<GR, NWGHT, NLBL, EWGHT>::initVariables(const MwcsGra
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
 inline void CplexSolverImpl<GR, NWGHT, NLBL, EWGHT>::initConstraints(const MwcsGraphType& mwcsGraph)
 {
-  const Graph& g = mwcsGraph.getGraph();
   const WeightNodeMap& weight = mwcsGraph.getScores();
 
   IloExpr expr(_env);
@@ -243,24 +280,39 @@ inline void CplexSolverImpl<GR, NWGHT, NLBL, EWGHT>::initConstraints(const MwcsG
   {
     expr += _x[i] * weight[_invNode[i]];
   }
-  _model.add(IloObjective(_env, expr, IloObjective::Maximize));
+  _objective = IloObjective(_env, expr, IloObjective::Maximize);
+  _model.add(_objective);
+
+  if (_options._analysis)
+  {
+    delete _pAnalysis;
+    _pAnalysis = new MwcsAnalyzeType(mwcsGraph);
+    _pAnalysis->analyze();
+  }
 
   // add equality constraints
   if (_pAnalysis)
   {
+    // nodes of an equivalence class are equal to its first node,
+    // classes are linked by the transitive reduction of the implications
+    const NodeSetVector& eqClasses = _pAnalysis->getEqClasses();
     int nAnalyzeConstraints = 0;
-    for (NodeIt i(g); i != lemon::INVALID; ++i)
+    for (int c = 0; c < _pAnalysis->getEqClassesCount(); ++c)
     {
-      if (weight[i] > 0)
+      const NodeSet& eqClass = eqClasses[c];
+      int id_c = (*_pNode)[*eqClass.begin()];
+      for (NodeSetIt it = ++eqClass.begin(); it != eqClass.end(); ++it)
+      {
+        _model.add(_x[(*_pNode)[*it]] == _x[id_c]);
+        nAnalyzeConstraints++;
+      }
+
+      const IntVector& coverEdges = _pAnalysis->getCoverEdges(c);
+      for (size_t k = 0; k < coverEdges.size(); ++k)
       {
-        for (NodeIt j(g); j != lemon::INVALID; ++j)
-        {
-          if (weight[j] > 0 && _pAnalysis->ok(i, j))
-          {
-            _model.add(_x[(*_pNode)[i]] <= _x[(*_pNode)[j]]);
-            nAnalyzeConstraints++;
-          }
-        }
+        int id_d = (*_pNode)[*eqClasses[coverEdges[k]].begin()];
+        _model.add(_x[id_c] <= _x[id_d]);
+        nAnalyzeConstraints++;
       }
     }
     
@@ -271,6 +323,53 @@ inline void CplexSolverImpl<GR, NWGHT, NLBL, EWGHT>::initConstraints(const MwcsG
   }
 }
 
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void CplexSolverImpl<GR, NWGHT, NLBL, EWGHT>::addMipStart(const MwcsGraphType& mwcsGraph,
+                                                                 const StringSet& startLabels)
+{
+  IloNumVarArray startVar(_env);
+  IloNumArray startVal(_env);
+  
+  int nStart = 0;
+  for (int i = 0; i < _n; i++)
+  {
+    bool start = SolverImplType::isStartNode(mwcsGraph, _invNode[i], startLabels);
+    startVar.add(_x[i]);
+    startVal.add(start ? 1 : 0);
+    nStart += start;
+  }
+  
+  if (nStart > 0)
+  {
+    // only x is given, so CPLEX completes the start by solving a sub-MIP
+    _cplex.addMIPStart(startVar, startVal, IloCplex::MIPStartSolveMIP);
+    
+    if (g_verbosity >= VERBOSE_NON_ESSENTIAL)
+    {
+      std::cout << "// Added MIP start with " << nStart << " node(s)" << std::endl;
+    }
+  }
+  
+  startVar.end();
+  startVal.end();
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void CplexSolverImpl<GR, NWGHT, NLBL, EWGHT>::setCutoff(double LB)
+{
+  if (LB == -std::numeric_limits<double>::max())
+    return;
+  
+  // modules attaining LB itself must not be cut off
+  const double cutoff = LB - 1e-5 * std::max(1., fabs(LB));
+  _cplex.setParam(IloCplex::CutLo, cutoff);
+  
+  if (g_verbosity >= VERBOSE_NON_ESSENTIAL)
+  {
+    std::cout << "// Set objective cutoff to " << cutoff << std::endl;
+  }
+}
+
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
 inline bool CplexSolverImpl<GR, NWGHT, NLBL, EWGHT>::solveCplex(const MwcsGraphType& mwcsGraph,
                                                                 double& score,
@@ -0,0 +1,483 @@
+/*
+ * cutsolverpcstimpl.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef CUTSOLVERPCSTIMPL_H
+#define CUTSOLVERPCSTIMPL_H
+
+#include "cutsolverunrootedimpl.h"
+#include "cplex_cut/gsecpcst.h"
+#include <lemon/kruskal.h>
+#include <iterator>
+#include <utility>
+
+namespace nina {
+namespace mwcs {
+
+/// \brief Unrooted cut solver for instances with edge costs (PCST)
+///
+/// Extends the unrooted node formulation by edge variables z, which form a
+/// spanning tree of the selected nodes: z_e <= x_u, z_e <= x_v,
+/// z(E) = x(V) - 1 and generalized subtour elimination constraints
+/// (see GsecPcst). The objective is w(x) - c(z). A MIP start is obtained
+/// by dynamic programming on a minimum spanning tree of the graph.
+template<typename GR,
+         typename NWGHT = typename GR::template NodeMap<double>,
+         typename NLBL = typename GR::template NodeMap<std::string>,
+         typename EWGHT = typename GR::template EdgeMap<double> >
+class CutSolverPcstImpl : public CutSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>
+{
+public:
+  typedef GR Graph;
+  typedef NWGHT WeightNodeMap;
+  typedef NLBL LabelNodeMap;
+  typedef EWGHT WeightEdgeMap;
+
+  typedef CutSolverUnrootedImpl<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> Parent;
+  typedef typename Parent::Parent2 Parent2;
+
+  typedef typename Parent::MwcsGraphType MwcsGraphType;
+  typedef typename Parent::NodeSet NodeSet;
+  typedef typename Parent::NodeSetIt NodeSetIt;
+  typedef typename Parent::NodeVector NodeVector;
+  typedef typename Parent::NodeVectorIt NodeVectorIt;
+  typedef typename Parent::Options Options;
+
+  typedef NodeCutUnrootedUserCut<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> NodeCutUnrootedUserCutType;
+  typedef NodeCutUnrootedCutTreeUserCut<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> NodeCutUnrootedCutTreeUserCutType;
+  typedef GsecPcstLazyConstraint<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> GsecPcstLazyConstraintType;
+  typedef GsecPcstUserCut<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> GsecPcstUserCutType;
+  typedef PcstIncumbent<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> PcstIncumbentType;
+  typedef typename Parent::BranchType BranchType;
+
+  TEMPLATE_GRAPH_TYPEDEFS(Graph);
+
+  using Parent::_pMwcsGraph;
+  using Parent::_pStartLabels;
+  using Parent::_lowerBound;
+  using Parent::_options;
+  using Parent::_n;
+  using Parent::_pNode;
+  using Parent::_invNode;
+  using Parent::_env;
+  using Parent::_model;
+  using Parent::_cplex;
+  using Parent::_x;
+  using Parent::_y;
+  using Parent::_s;
+  using Parent::_objective;
+
+public:
+  CutSolverPcstImpl(const Options& options)
+    : Parent(options)
+    , _nEdges(0)
+    , _pEdge(NULL)
+    , _invEdge()
+    , _z()
+  {
+  }
+
+  virtual ~CutSolverPcstImpl()
+  {
+    delete _pEdge;
+  }
+
+protected:
+  typedef std::vector<Edge> EdgeVector;
+  typedef typename EdgeVector::const_iterator EdgeVectorIt;
+  typedef std::vector<int> IntVector;
+  typedef std::vector<double> DoubleVector;
+  typedef std::pair<int, int> IntPair;
+  typedef std::vector<IntPair> IntPairVector;
+  typedef typename IntPairVector::const_iterator IntPairVectorIt;
+
+  int _nEdges;
+  IntEdgeMap* _pEdge;
+  EdgeVector _invEdge;
+  IloBoolVarArray _z;
+
+  virtual void initVariables(const MwcsGraphType& mwcsGraph);
+  virtual void initConstraints(const MwcsGraphType& mwcsGraph);
+
+  bool solveModel();
+
+  /// Adds a MIP start: the best subtree of a minimum spanning tree
+  void addTreeMipStart();
+};
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void CutSolverPcstImpl<GR, NWGHT, NLBL, EWGHT>::initVariables(const MwcsGraphType& mwcsGraph)
+{
+  Parent::initVariables(mwcsGraph);
+
+  assert(mwcsGraph.hasEdgeCosts());
+
+  const Graph& g = mwcsGraph.getGraph();
+  _nEdges = mwcsGraph.getEdgeCount();
+
+  delete _pEdge;
+  _pEdge = new IntEdgeMap(g);
+  _invEdge.clear();
+  _invEdge.reserve(_nEdges);
+
+  _z = IloBoolVarArray(_env, _nEdges);
+
+  char buf[1024];
+  int j = 0;
+  for (EdgeIt e(g); e != lemon::INVALID; ++e, ++j)
+  {
+    // z_j = 1 if edge j is in the spanning tree of the subgraph
+    snprintf(buf, 1024, "z_%s_%s",
+             mwcsGraph.getLabel(g.u(e)).c_str(),
+             mwcsGraph.getLabel(g.v(e)).c_str());
+    _z[j].setName(buf);
+
+    (*_pEdge)[e] = j;
+    _invEdge.push_back(e);
+  }
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void CutSolverPcstImpl<GR, NWGHT, NLBL, EWGHT>::initConstraints(const MwcsGraphType& mwcsGraph)
+{
+  Parent::initConstraints(mwcsGraph);
+
+  const Graph& g = mwcsGraph.getGraph();
+
+  // an edge can only be picked if both its end points are
+  // z_e <= x_u and z_e <= x_v for all edges e = (u,v) in E
+  for (int j = 0; j < _nEdges; ++j)
+  {
+    Edge e = _invEdge[j];
+    _model.add(_z[j] <= _x[(*_pNode)[g.u(e)]]);
+    _model.add(_z[j] <= _x[(*_pNode)[g.v(e)]]);
+  }
+
+  // the picked edges form a spanning tree of the picked nodes
+  // \sum_{e \in E} z_e = \sum_{i \in V} x_i - 1
+  IloExpr expr(_env);
+  for (int j = 0; j < _nEdges; ++j)
+  {
+    expr += _z[j];
+  }
+  for (int i = 0; i < _n; ++i)
+  {
+    expr -= _x[i];
+  }
+  IloConstraint c;
+  _model.add(c = (expr == -1));
+  c.setName("spanning_tree");
+  expr.end();
+
+  // objective: subtract the costs of the picked edges
+  IloNumArray cost(_env, _nEdges);
+  for (int j = 0; j < _nEdges; ++j)
+  {
+    cost[j] = -mwcsGraph.getEdgeCost(_invEdge[j]);
+  }
+  _objective.setLinearCoefs(_z, cost);
+  cost.end();
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void CutSolverPcstImpl<GR, NWGHT, NLBL, EWGHT>::addTreeMipStart()
+{
+  const Graph& g = _pMwcsGraph->getGraph();
+  const WeightNodeMap& weight = _pMwcsGraph->getScores();
+  const WeightEdgeMap& cost = _pMwcsGraph->getEdgeCosts();
+
+  // minimum spanning forest, adjacency lists indexed by variable index
+  EdgeVector treeEdges;
+  std::back_insert_iterator<EdgeVector> out(treeEdges);
+  lemon::kruskal(g, cost, out);
+
+  std::vector<IntPairVector> adj(_n);
+  for (EdgeVectorIt edgeIt = treeEdges.begin(); edgeIt != treeEdges.end(); ++edgeIt)
+  {
+    int u = (*_pNode)[g.u(*edgeIt)];
+    int v = (*_pNode)[g.v(*edgeIt)];
+    int j = (*_pEdge)[*edgeIt];
+    adj[u].push_back(std::make_pair(v, j));
+    adj[v].push_back(std::make_pair(u, j));
+  }
+
+  // preorder of every tree of the forest
+  IntVector order, parent(_n, -1), parentEdge(_n, -1);
+  std::vector<bool> visited(_n, false);
+  order.reserve(_n);
+  for (int s = 0; s < _n; ++s)
+  {
+    if (visited[s]) continue;
+
+    IntVector stack(1, s);
+    visited[s] = true;
+    while (!stack.empty())
+    {
+      int u = stack.back();
+      stack.pop_back();
+      order.push_back(u);
+      for (IntPairVectorIt it = adj[u].begin(); it != adj[u].end(); ++it)
+      {
+        if (!visited[it->first])
+        {
+          visited[it->first] = true;
+          parent[it->first] = u;
+          parentEdge[it->first] = it->second;
+          stack.push_back(it->first);
+        }
+      }
+    }
+  }
+
+  // best[u] is the weight of the best subtree rooted at u,
+  // a child is attached if it pays for its edge
+  DoubleVector best(_n);
+  for (int i = 0; i < _n; ++i)
+  {
+    best[i] = weight[_invNode[i]];
+  }
+  for (IntVector::const_reverse_iterator it = order.rbegin(); it != order.rend(); ++it)
+  {
+    int u = *it;
+    if (parent[u] != -1)
+    {
+      double gain = best[u] - cost[_invEdge[parentEdge[u]]];
+      if (gain > 0)
+      {
+        best[parent[u]] += gain;
+      }
+    }
+  }
+
+  int root = 0;
+  for (int i = 1; i < _n; ++i)
+  {
+    if (best[i] > best[root])
+    {
+      root = i;
+    }
+  }
+
+  // a nonpositive root with a single attached child is not needed,
+  // and would violate the degree constraints of CutSolverUnrootedImpl
+  // unless it is picked as the root variable. Children are only attached
+  // if they pay for their edge, so no other nonpositive node is a leaf,
+  // and a single nonpositive node is exempt as it is the root variable
+  while (weight[_invNode[root]] <= 0)
+  {
+    int nChildren = 0, child = -1;
+    for (IntPairVectorIt it = adj[root].begin(); it != adj[root].end(); ++it)
+    {
+      if (parent[it->first] == root && best[it->first] - cost[_invEdge[it->second]] > 0)
+      {
+        ++nChildren;
+        child = it->first;
+      }
+    }
+    if (nChildren != 1) break;
+    root = child;
+  }
+
+  // reconstruct the subtree
+  IloNumArray xVal(_env, _n), yVal(_env, _n), sVal(_env, _s.getSize()), zVal(_env, _nEdges);
+  IntVector stack(1, root);
+  while (!stack.empty())
+  {
+    int u = stack.back();
+    stack.pop_back();
+    xVal[u] = 1;
+    for (IntPairVectorIt it = adj[u].begin(); it != adj[u].end(); ++it)
+    {
+      int v = it->first;
+      if (parent[v] == u && best[v] - cost[_invEdge[it->second]] > 0)
+      {
+        zVal[it->second] = 1;
+        stack.push_back(v);
+      }
+    }
+  }
+
+  // the root variable is the first selected nonnegative node, as
+  // required by the symmetry breaking constraints, and s_k = 1 for
+  // the k-th nonnegative node if it does not come after the root
+  int nStart = 0;
+  int rootIdx = -1;
+  int nNonNegUpToRoot = 0;
+  for (int i = 0; i < _n; ++i)
+  {
+    const bool nonNeg = weight[_invNode[i]] >= 0;
+    if (xVal[i] == 1)
+    {
+      if (rootIdx == -1 && nonNeg)
+      {
+        rootIdx = i;
+        yVal[i] = 1;
+      }
+      ++nStart;
+    }
+    if (nonNeg && (rootIdx == -1 || i == rootIdx))
+    {
+      ++nNonNegUpToRoot;
+    }
+  }
+  if (rootIdx == -1)
+  {
+    // no node may be the root, which only happens with negative prizes
+    xVal.end();
+    yVal.end();
+    sVal.end();
+    zVal.end();
+    return;
+  }
+  for (int k = 0; k < nNonNegUpToRoot && k < _s.getSize(); ++k)
+  {
+    sVal[k] = 1;
+  }
+
+  IloNumVarArray startVar(_env);
+  IloNumArray startVal(_env);
+  startVar.add(_x);
+  startVal.add(xVal);
+  startVar.add(_y);
+  startVal.add(yVal);
+  startVar.add(_s);
+  startVal.add(sVal);
+  startVar.add(_z);
+  startVal.add(zVal);
+  _cplex.addMIPStart(startVar, startVal, IloCplex::MIPStartSolveFixed);
+
+  if (g_verbosity >= VERBOSE_NON_ESSENTIAL)
+  {
+    std::cout << "// Added spanning tree MIP start with " << nStart
+              << " node(s) and weight " << best[root] << std::endl;
+  }
+
+  startVar.end();
+  startVal.end();
+  xVal.end();
+  yVal.end();
+  sVal.end();
+  zVal.end();
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline bool CutSolverPcstImpl<GR, NWGHT, NLBL, EWGHT>::solveModel()
+{
+  const Graph& g = _pMwcsGraph->getGraph();
+  const WeightNodeMap& weight = _pMwcsGraph->getScores();
+
+  // separation and heuristic callbacks only use thread-local state,
+  // the incumbent callbacks share the output
+  IloFastMutex* pMutex = NULL;
+  if (_options._multiThreading > 1)
+  {
+    pMutex = new IloFastMutex();
+  }
+
+  _cplex.setParam( IloCplex::HeurFreq      , -1 );
+  _cplex.setParam( IloCplex::Cliques       , -1 );
+  _cplex.setParam( IloCplex::MCFCuts       , -1 );
+  _cplex.setParam( IloCplex::MIPEmphasis, IloCplex::MIPEmphasisBestBound );
+
+  // connectivity of the nodes is implied by the spanning tree, node cuts
+  // strengthen the relaxation; CPLEX heuristic solutions would lack z-values
+  IloCplex::LazyConstraintCallbackI* pLazyCut = new (_env) GsecPcstLazyConstraintType(_env, _x, _z, g,
+                                                                                      *_pNode, *_pEdge,
+                                                                                      _n, _nEdges);
+  IloCplex::UserCutCallbackI* pGsecCut = new (_env) GsecPcstUserCutType(_env, _x, _z, g,
+                                                                        *_pNode, *_pEdge,
+                                                                        _n, _nEdges,
+                                                                        _options._maxNumberOfCuts,
+                                                                        _options._backOff);
+  IloCplex::UserCutCallbackI* pNodeCut = NULL;
+  if (_options._cutTree)
+  {
+    pNodeCut = new (_env) NodeCutUnrootedCutTreeUserCutType(_env, _x, _y, g, weight, *_pNode,
+                                                            _n, _options._maxNumberOfCuts,
+                                                            _options._backOff);
+  }
+  else
+  {
+    pNodeCut = new (_env) NodeCutUnrootedUserCutType(_env, _x, _y, g, weight, *_pNode,
+                                                     _n, _options._maxNumberOfCuts,
+                                                     _options._backOff,
+                                                     _options._nestedCuts,
+                                                     _options._backCuts);
+  }
+  IloCplex::IncumbentCallbackI* pIncumbent = NULL;
+  if (g_pOut)
+  {
+    pIncumbent = new (_env) PcstIncumbentType(_env, _pMwcsGraph->getTotalNodeProfitPCST(), pMutex);
+  }
+
+  _cplex.setParam(IloCplex::MIPInterval, 1);
+
+  IloCplex::Callback cb(pLazyCut);
+  _cplex.use(cb);
+
+  IloCplex::Callback cb2(pGsecCut);
+  _cplex.use(cb2);
+
+  IloCplex::Callback cb3(pNodeCut);
+  _cplex.use(cb3);
+
+  IloCplex::Callback cb4(pIncumbent);
+  if (pIncumbent)
+    _cplex.use(cb4);
+
+  IloCplex::BranchCallbackI* pBranch = NULL;
+  if (_options._branchRoots)
+  {
+    pBranch = new (_env) BranchType(_env, _y, g, weight, *_pNode, _n);
+  }
+
+  IloCplex::Callback cb5(pBranch);
+  if (pBranch)
+    _cplex.use(cb5);
+
+  addTreeMipStart();
+  if (_pStartLabels)
+  {
+    Parent2::addMipStart(*_pMwcsGraph, *_pStartLabels);
+  }
+  Parent2::setCutoff(_lowerBound);
+
+  bool res = _cplex.solve();
+  cb.end();
+  cb2.end();
+  cb3.end();
+  if (pIncumbent)
+  {
+    cb4.end();
+  }
+  if (pBranch)
+  {
+    cb5.end();
+  }
+
+  if (res)
+  {
+    if (g_verbosity > VERBOSE_NONE)
+    {
+      std::cerr << "[" << _cplex.getObjValue() << ", "
+                << _cplex.getBestObjValue() << "]" << std::endl;
+    }
+  }
+  else
+  {
+    if (g_verbosity > VERBOSE_NONE)
+    {
+      std::cerr << "[0, 0]" << std::endl;
+    }
+  }
+
+  delete pMutex;
+  return res;
+}
+
+} // namespace mwcs
+} // namespace nina
+
+#endif // CUTSOLVERPCSTIMPL_H
@@ -55,6 +55,8 @@ public:
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
   
   using Parent1::_pMwcsGraph;
+  using Parent1::_pStartLabels;
+  using Parent1::_lowerBound;
   using Parent1::_rootNodes;
   using Parent2::_options;
   using Parent2::_n;
@@ -162,6 +164,8 @@ inline bool CutSolverRootedImpl<GR, NWGHT, NLBL, EWGHT>::solveModel()
   const Graph& g = _pMwcsGraph->getGraph();
   const WeightNodeMap& weight = _pMwcsGraph->getScores();
 
+  // separation and heuristic callbacks only use thread-local state,
+  // the incumbent callbacks share the output
   IloFastMutex* pMutex = NULL;
   if (_options._multiThreading > 1)
   {
@@ -192,15 +196,18 @@ inline bool CutSolverRootedImpl<GR, NWGHT, NLBL, EWGHT>::solveModel()
   _cplex.setParam( IloCplex::MIPEmphasis, IloCplex::MIPEmphasisBestBound );
 
   pLazyCut = new (_env) NodeCutRootedLazyConstraintType(_env, _x, g, weight, _rootNodes, *_pNode,
-                                                        _n, _options._maxNumberOfCuts, pMutex);
+                                                        _n, _options._maxNumberOfCuts,
+                                                        _options._minimalSeparators);
   pUserCut = new (_env) NodeCutRootedUserCutType(_env, _x, g, weight, _rootNodes, *_pNode,
-                                                 _n, _options._maxNumberOfCuts, pMutex,
-                                                 _options._backOff);
+                                                 _n, _options._maxNumberOfCuts,
+                                                 _options._backOff,
+                                                 _options._nestedCuts,
+                                                 _options._backCuts);
     
   pHeuristic = new (_env) HeuristicRootedType(_env, _x, //_z,
                                               g, weight, _rootNodes,
                                               *_pNode, //*_pEdge,
-                                              _n, _m, pMutex);
+                                              _n, _m);
   
   if (g_pOut)
   {
@@ -242,6 +249,12 @@ inline bool CutSolverRootedImpl<GR, NWGHT, NLBL, EWGHT>::solveModel()
 //  IloCplex::Callback cb4(pBranch);
 ////  _cplex.use(cb4);
   
+  if (_pStartLabels)
+  {
+    Parent2::addMipStart(*_pMwcsGraph, *_pStartLabels);
+  }
+  Parent2::setCutoff(_lowerBound);
+  
   bool res = _cplex.solve();
   cb.end();
   cb2.end();
@@ -11,6 +11,8 @@
 #include "solverunrootedimpl.h"
 #include "cplexsolverimpl.h"
 #include "cplex_cut/nodecutunrooted.h"
+#include "cplex_cut/nodecutunrootedcuttree.h"
+#include "cplex_branch/branch.h"
 #include "cplex_heuristic/heuristicunrooted.h"
 #include "cplex_incumbent/incumbent.h"
 #include "cplex_incumbent/pcstincumbent.h"
@@ -47,12 +49,16 @@ public:
   
   typedef NodeCutUnrootedLazyConstraint<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> NodeCutUnrootedLazyConstraintType;
   typedef NodeCutUnrootedUserCut<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> NodeCutUnrootedUserCutType;
+  typedef NodeCutUnrootedCutTreeUserCut<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> NodeCutUnrootedCutTreeUserCutType;
   typedef HeuristicUnrooted<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> HeuristicUnrootedType;
+  typedef Branch<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> BranchType;
   typedef PcstIncumbent<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap>  PcstIncumbentType;
   
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
   
   using Parent1::_pMwcsGraph;
+  using Parent1::_pStartLabels;
+  using Parent1::_lowerBound;
   using Parent2::_options;
   using Parent2::_n;
   using Parent2::_m;
@@ -72,6 +78,7 @@ public:
     : Parent1()
     , Parent2(options)
     , _y()
+    , _s()
   {
   }
   
@@ -106,6 +113,9 @@ public:
 
 protected:
   IloBoolVarArray _y;
+  /// s_k = \sum y_j over the k-th and all later nonnegative nodes j,
+  /// used for symmetry breaking; empty if the sums are not chained
+  IloBoolVarArray _s;
   
   virtual void initVariables(const MwcsGraphType& mwcsGraph);
   virtual void initConstraints(const MwcsGraphType& mwcsGraph);
@@ -121,8 +131,31 @@ inline void CutSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::initVariables(const M
   _n = mwcsGraph.getNodeCount();
   _y = IloBoolVarArray(_env, _n);
   
+  // the symmetry breaking sums over the nonnegative nodes are chained,
+  // unless adding them up per positive node takes fewer nonzeros
+  const WeightNodeMap& weight = mwcsGraph.getScores();
+  int nNonNeg = 0;
+  int nPositive = 0;
+  long long nSumNonZeros = 0;
+  for (int id_i = _n - 1; id_i >= 0; --id_i)
+  {
+    const double weight_i = weight[_invNode[id_i]];
+    if (weight_i > 0)
+    {
+      ++nPositive;
+      nSumNonZeros += nNonNeg + 1;
+    }
+    if (weight_i >= 0)
+    {
+      ++nNonNeg;
+    }
+  }
+  const bool chain = nSumNonZeros > 3 * nNonNeg + 2 * nPositive;
+  _s = IloBoolVarArray(_env, chain ? nNonNeg : 0);
+  
   char buf[1024];
   int i = 0;
+  int k = 0;
   for (NodeVectorIt it = _invNode.begin(); it != _invNode.end(); ++it, ++i)
   {
     Node v = *it;
@@ -132,6 +165,12 @@ inline void CutSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::initVariables(const M
     snprintf(buf, 1024, "y_%s", mwcsGraph.getLabel(v).c_str());
     //snprintf(buf, 1024, "y_%d", g.id(v));
     _y[i].setName(buf);
+
+    if (chain && weight[v] >= 0)
+    {
+      snprintf(buf, 1024, "s_%s", mwcsGraph.getLabel(v).c_str());
+      _s[k++].setName(buf);
+    }
   }
 }
   
@@ -212,19 +251,15 @@ inline void CutSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::initConstraints(const
   // must be part of the solution as well
   // if you get in, you have to get out as well
   // BIG FAT WARNING: not true for xHeinz!!!
+  // with edge costs, a single zero-weight node is a solution of weight 0
+  // (e.g. if all prizes are 0), so the root is exempt:
+  //   2 x_i <= \sum_{j \in N(i)} x_j + 2 y_i
+  const bool edgeCosts = mwcsGraph.hasEdgeCosts();
+  int nDegreeConstraints = 0;
   if (_n < 5000 || !_options._pcst)
   {
-    if (g_verbosity >= VERBOSE_DEBUG)
+    for (NodeIt i(g); i != lemon::INVALID; ++i)
     {
-      std::cout << std::endl;
-    }
-    int idx = 1;
-    for (NodeIt i(g); i != lemon::INVALID; ++i, ++idx)
-    {
-      if (g_verbosity >= VERBOSE_DEBUG)
-      {
-        std::cout << "\rAdding symmetry breaking constraints " << idx << "/" << _n << std::flush;
-      }
       if (weight[i] <= 0)
       {
         expr.clear();
@@ -233,29 +268,78 @@ inline void CutSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::initConstraints(const
           Node j = g.oppositeNode(i, e);
           expr += _x[(*_pNode)[j]];
         }
+        if (edgeCosts)
+        {
+          expr += 2 * _y[(*_pNode)[i]];
+        }
         _model.add(2 * _x[(*_pNode)[i]] <= expr);
+        ++nDegreeConstraints;
       }
-      else
+    }
+  }
+  
+  // symmetry breaking: the root is the selected positive node
+  // with the smallest index, i.e. for every positive node i
+  //   sum_{j > i, w_j >= 0} y_j <= 1 - x_i
+  // (y_j = 0 for negative j). Either the sums are chained over the
+  // nonnegative nodes, s_k = y_j + s_{k+1} for the k-th nonnegative node j,
+  // which is linear in their number, or each sum is added as is
+  int nSymmetryConstraints = 0;
+  const int nChain = _s.getSize();
+  if (nChain > 0)
+  {
+    int k = 0;
+    for (int id_i = 0; id_i < _n; ++id_i)
+    {
+      const double weight_i = weight[_invNode[id_i]];
+      if (weight_i < 0)
+        continue;
+      
+      if (k + 1 < nChain)
       {
-        // symmetry breaking
-        // sum_{j > i, w_j > 0} y_j <= 1 - x_i
-        int id_i = (*_pNode)[i];
-        expr.clear();
-        for (int id_j = id_i + 1; id_j < _n; ++id_j)
+        _model.add(_s[k] == _y[id_i] + _s[k + 1]);
+        if (weight_i > 0)
         {
-          Node j = _invNode[id_j];
-          if (weight[j] < 0) continue;
-          expr += _y[id_j];
-	  _model.add(_y[id_j] <= 1 - _x[id_i]); // will be removed in later versions, see resolved issue
+          _model.add(_s[k + 1] <= 1 - _x[id_i]);
+          ++nSymmetryConstraints;
         }
-        _model.add(expr <= 1 - _x[id_i]);
       }
+      else
+      {
+        _model.add(_s[k] == _y[id_i]);
+      }
+      ++nSymmetryConstraints;
+      ++k;
     }
-    if (g_verbosity >= VERBOSE_DEBUG)
+  }
+  else
+  {
+    // suffix sums, built from the last node backwards
+    expr.clear();
+    bool empty = true;
+    for (int id_i = _n - 1; id_i >= 0; --id_i)
     {
-      std::cout << std::endl;
+      const double weight_i = weight[_invNode[id_i]];
+      if (weight_i > 0 && !empty)
+      {
+        _model.add(expr <= 1 - _x[id_i]);
+        ++nSymmetryConstraints;
+      }
+      if (weight_i >= 0)
+      {
+        expr += _y[id_i];
+        empty = false;
+      }
     }
   }
+  
+  expr.end();
+  
+  if (g_verbosity >= VERBOSE_NON_ESSENTIAL)
+  {
+    std::cout << "// Added " << nDegreeConstraints << " degree constraints and "
+              << nSymmetryConstraints << " symmetry breaking constraints" << std::endl;
+  }
 }
   
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
@@ -264,6 +348,8 @@ inline bool CutSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::solveModel()
   const Graph& g = _pMwcsGraph->getGraph();
   const WeightNodeMap& weight = _pMwcsGraph->getScores();
 
+  // separation and heuristic callbacks only use thread-local state,
+  // the incumbent callbacks share the output
   IloFastMutex* pMutex = NULL;
   if (_options._multiThreading > 1)
   {
@@ -296,15 +382,27 @@ inline bool CutSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::solveModel()
 //    _cplex.setParam( IloCplex::RepeatPresolve,  0 );
 
   pLazyCut = new (_env) NodeCutUnrootedLazyConstraint<GR, NWGHT, NLBL, EWGHT>(_env, _x, _y, g, weight, *_pNode,
-                                                                              _n, _options._maxNumberOfCuts, pMutex);
-  pUserCut = new (_env) NodeCutUnrootedUserCut<GR, NWGHT, NLBL, EWGHT>(_env, _x, _y, g, weight, *_pNode,
-                                                                       _n, _options._maxNumberOfCuts, pMutex,
-                                                                       _options._backOff);
+                                                                              _n, _options._maxNumberOfCuts,
+                                                                              _options._minimalSeparators);
+  if (_options._cutTree)
+  {
+    pUserCut = new (_env) NodeCutUnrootedCutTreeUserCutType(_env, _x, _y, g, weight, *_pNode,
+                                                            _n, _options._maxNumberOfCuts,
+                                                            _options._backOff);
+  }
+  else
+  {
+    pUserCut = new (_env) NodeCutUnrootedUserCutType(_env, _x, _y, g, weight, *_pNode,
+                                                     _n, _options._maxNumberOfCuts,
+                                                     _options._backOff,
+                                                     _options._nestedCuts,
+                                                     _options._backCuts);
+  }
 
-  pHeuristic = new (_env) HeuristicUnrootedType(_env, _x, _y, //_z,
+  pHeuristic = new (_env) HeuristicUnrootedType(_env, _x, _y, _s, //_z,
                                                 g, weight,
                                                 *_pNode, //*_pEdge,
-                                                _n, _m, pMutex);
+                                                _n, _m);
   
   if (g_pOut)
   {
@@ -329,22 +427,21 @@ inline bool CutSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::solveModel()
   if (pIncumbent)
     _cplex.use(cb4);
   
-//  // determine degrees
-//  IntNodeMap deg(g, 0);
-//  IntNodeMap posDeg(g, 0);
-//  for (NodeIt i(g); i != lemon::INVALID; ++i)
-//  {
-//    for (IncEdgeIt e(g, i); e != lemon::INVALID; ++e)
-//    {
-//      Node j = g.oppositeNode(i, e);
-//      ++deg[i];
-//      if (weight[j] >= 0) ++posDeg[i];
-//    }
-//  }
-//  
-//  IloCplex::BranchCallbackI* pBranch = new Branch<GR, NWGHT, NLBL, EWGHT>(_env, _x, g, weight, *_pNode, _n, deg, posDeg);
-//  IloCplex::Callback cb4(pBranch);
-////  _cplex.use(cb4);
+  IloCplex::BranchCallbackI* pBranch = NULL;
+  if (_options._branchRoots)
+  {
+    pBranch = new (_env) BranchType(_env, _y, g, weight, *_pNode, _n);
+  }
+  
+  IloCplex::Callback cb5(pBranch);
+  if (pBranch)
+    _cplex.use(cb5);
+  
+  if (_pStartLabels)
+  {
+    Parent2::addMipStart(*_pMwcsGraph, *_pStartLabels);
+  }
+  Parent2::setCutoff(_lowerBound);
   
   //exportModel("/tmp/model.lp");
   bool res = _cplex.solve();
@@ -355,6 +452,10 @@ inline bool CutSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::solveModel()
   {
     cb4.end();
   }
+  if (pBranch)
+  {
+    cb5.end();
+  }
   
   if (res)
   {
@@ -0,0 +1,289 @@
+/*
+ * dynamicspanningtree.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef DYNAMICSPANNINGTREE_H
+#define DYNAMICSPANNINGTREE_H
+
+#include <lemon/core.h>
+#include <limits>
+#include <vector>
+#include <assert.h>
+
+namespace nina {
+namespace mwcs {
+
+/// \brief Minimum spanning forest that is kept minimal under edge cost changes
+///
+/// The forest is given by \c tree and is stored as parent pointers. After
+/// the cost of a single edge changed, update() restores minimality by at
+/// most one edge swap: a non-tree edge whose cost decreased replaces the
+/// most expensive edge on its tree path, a tree edge whose cost increased
+/// is replaced by the cheapest edge crossing the cut it leaves behind.
+/// That cut is enumerated from the smaller side by searching both sides
+/// alternately. Only vectors indexed by node id are used, no graph maps.
+template<typename GR,
+         typename CM = typename GR::template EdgeMap<double>,
+         typename TM = typename GR::template EdgeMap<bool> >
+class DynamicSpanningTree
+{
+public:
+  typedef GR Graph;
+  typedef CM CostMap;
+  typedef TM TreeMap;
+
+  TEMPLATE_GRAPH_TYPEDEFS(Graph);
+
+private:
+  typedef std::vector<Node> NodeVector;
+  typedef std::vector<Edge> EdgeVector;
+  typedef std::vector<int> IntVector;
+
+public:
+  DynamicSpanningTree(const Graph& g,
+                      const CostMap& cost,
+                      TreeMap& tree)
+    : _g(g)
+    , _cost(cost)
+    , _tree(tree)
+    , _parentEdge()
+    , _mark()
+    , _stamp(0)
+    , _queueA()
+    , _queueP()
+  {
+  }
+
+  /// Determines the parent pointers of the forest given by \c tree,
+  /// which must be a minimum spanning forest
+  void init();
+
+  /// Restores minimality of \c tree after the cost of \c e changed from \c oldCost
+  void update(Edge e, double oldCost)
+  {
+    const double newCost = _cost[e];
+    if (_tree[e] && newCost > oldCost)
+    {
+      replaceTreeEdge(e);
+    }
+    else if (!_tree[e] && newCost < oldCost)
+    {
+      insertNonTreeEdge(e);
+    }
+  }
+
+private:
+  const Graph& _g;
+  const CostMap& _cost;
+  TreeMap& _tree;
+  /// Edge to the parent of every node (by node id), INVALID for roots
+  EdgeVector _parentEdge;
+  IntVector _mark;
+  int _stamp;
+  NodeVector _queueA;
+  NodeVector _queueP;
+
+  Node parent(Node x) const
+  {
+    const Edge f = _parentEdge[_g.id(x)];
+    return f == lemon::INVALID ? lemon::INVALID : _g.oppositeNode(x, f);
+  }
+
+  /// Makes \c x the root of the subtree of \c a and attaches it by \c e,
+  /// which drops the edge between \c a and its parent
+  void reroot(Node x, Node a, Edge e)
+  {
+    Edge in = e;
+    Node y = x;
+    while (true)
+    {
+      const Edge out = _parentEdge[_g.id(y)];
+      _parentEdge[_g.id(y)] = in;
+      if (y == a)
+        break;
+      y = _g.oppositeNode(y, out);
+      in = out;
+    }
+  }
+
+  void insertNonTreeEdge(Edge e);
+  void replaceTreeEdge(Edge e);
+};
+
+template<typename GR, typename CM, typename TM>
+inline void DynamicSpanningTree<GR, CM, TM>::init()
+{
+  _parentEdge.assign(_g.maxNodeId() + 1, lemon::INVALID);
+  _mark.assign(_g.maxNodeId() + 1, 0);
+  _stamp = 1;
+
+  // bfs over the tree edges of every component, marking visited nodes
+  for (NodeIt r(_g); r != lemon::INVALID; ++r)
+  {
+    if (_mark[_g.id(r)] == _stamp)
+      continue;
+
+    _queueA.clear();
+    _queueA.push_back(r);
+    _mark[_g.id(r)] = _stamp;
+    for (size_t k = 0; k < _queueA.size(); ++k)
+    {
+      const Node x = _queueA[k];
+      for (IncEdgeIt f(_g, x); f != lemon::INVALID; ++f)
+      {
+        const Node y = _g.oppositeNode(x, f);
+        if (_tree[f] && _mark[_g.id(y)] != _stamp)
+        {
+          _mark[_g.id(y)] = _stamp;
+          _parentEdge[_g.id(y)] = f;
+          _queueA.push_back(y);
+        }
+      }
+    }
+  }
+}
+
+template<typename GR, typename CM, typename TM>
+inline void DynamicSpanningTree<GR, CM, TM>::insertNonTreeEdge(Edge e)
+{
+  const Node u = _g.u(e);
+  const Node v = _g.v(e);
+
+  // mark the ancestors of u, the first marked ancestor of v is the lca
+  ++_stamp;
+  for (Node x = u; x != lemon::INVALID; x = parent(x))
+  {
+    _mark[_g.id(x)] = _stamp;
+  }
+
+  Edge maxEdge = lemon::INVALID;
+  double maxCost = -std::numeric_limits<double>::max();
+  Node maxChild = lemon::INVALID;
+  bool maxOnU = false;
+
+  Node w = v;
+  while (_mark[_g.id(w)] != _stamp)
+  {
+    const Edge f = _parentEdge[_g.id(w)];
+    if (f == lemon::INVALID)
+    {
+      // u and v are in different trees, which cannot happen for a
+      // spanning forest of the graph; join them anyway
+      Node r = u;
+      while (parent(r) != lemon::INVALID)
+        r = parent(r);
+      reroot(u, r, e);
+      _tree[e] = true;
+      return;
+    }
+    if (_cost[f] > maxCost)
+    {
+      maxCost = _cost[f];
+      maxEdge = f;
+      maxChild = w;
+    }
+    w = _g.oppositeNode(w, f);
+  }
+
+  for (Node x = u; x != w; x = parent(x))
+  {
+    const Edge f = _parentEdge[_g.id(x)];
+    if (_cost[f] > maxCost)
+    {
+      maxCost = _cost[f];
+      maxEdge = f;
+      maxChild = x;
+      maxOnU = true;
+    }
+  }
+
+  if (maxEdge != lemon::INVALID && maxCost > _cost[e])
+  {
+    _tree[maxEdge] = false;
+    _tree[e] = true;
+    if (maxOnU)
+      reroot(u, maxChild, e);
+    else
+      reroot(v, maxChild, e);
+  }
+}
+
+template<typename GR, typename CM, typename TM>
+inline void DynamicSpanningTree<GR, CM, TM>::replaceTreeEdge(Edge e)
+{
+  // a is the child endpoint of e, its subtree becomes detached
+  const Node a = _parentEdge[_g.id(_g.u(e))] == e ? _g.u(e) : _g.v(e);
+  const Node p = _g.oppositeNode(a, e);
+  assert(_parentEdge[_g.id(a)] == e);
+
+  _tree[e] = false;
+
+  // search both sides alternately until one of them is exhausted
+  _stamp += 2;
+  const int stampA = _stamp - 1;
+  const int stampP = _stamp;
+  _queueA.clear();
+  _queueP.clear();
+  _queueA.push_back(a);
+  _queueP.push_back(p);
+  _mark[_g.id(a)] = stampA;
+  _mark[_g.id(p)] = stampP;
+
+  size_t kA = 0, kP = 0;
+  while (kA < _queueA.size() && kP < _queueP.size())
+  {
+    for (int side = 0; side < 2; ++side)
+    {
+      NodeVector& queue = side == 0 ? _queueA : _queueP;
+      size_t& k = side == 0 ? kA : kP;
+      const int stamp = side == 0 ? stampA : stampP;
+
+      const Node x = queue[k++];
+      for (IncEdgeIt f(_g, x); f != lemon::INVALID; ++f)
+      {
+        const Node y = _g.oppositeNode(x, f);
+        if (_tree[f] && _mark[_g.id(y)] != stamp)
+        {
+          _mark[_g.id(y)] = stamp;
+          queue.push_back(y);
+        }
+      }
+    }
+  }
+
+  const bool smallA = kA == _queueA.size();
+  const NodeVector& side = smallA ? _queueA : _queueP;
+  const int sideStamp = smallA ? stampA : stampP;
+
+  // cheapest edge leaving the exhausted side, e itself is a candidate
+  Edge minEdge = e;
+  double minCost = _cost[e];
+  for (typename NodeVector::const_iterator it = side.begin(); it != side.end(); ++it)
+  {
+    for (IncEdgeIt f(_g, *it); f != lemon::INVALID; ++f)
+    {
+      if (_mark[_g.id(_g.oppositeNode(*it, f))] != sideStamp && _cost[f] < minCost)
+      {
+        minCost = _cost[f];
+        minEdge = f;
+      }
+    }
+  }
+
+  _tree[minEdge] = true;
+  if (minEdge != e)
+  {
+    // d is the endpoint of minEdge in the subtree of a
+    Node d = _g.u(minEdge);
+    if ((_mark[_g.id(d)] == sideStamp) != smallA)
+      d = _g.v(minEdge);
+    reroot(d, a, minEdge);
+  }
+}
+
+} // namespace mwcs
+} // namespace nina
+
+#endif // DYNAMICSPANNINGTREE_H
@@ -9,6 +9,8 @@
 #define SOLVERIMPL_H
 
 #include <set>
+#include <string>
+#include <limits>
 
 namespace nina {
 namespace mwcs {
@@ -32,13 +34,20 @@ public:
   typedef typename NodeSet::iterator NodeSetNonConstIt;
   
   typedef MwcsGraph<Graph, WeightNodeMap, LabelNodeMap, WeightEdgeMap> MwcsGraphType;
+  typedef std::set<std::string> StringSet;
   
 protected:
   const MwcsGraphType* _pMwcsGraph;
+  /// Labels of the nodes of a module to start from, NULL if none
+  const StringSet* _pStartLabels;
+  /// Lower bound on the optimal score, -max if none
+  double _lowerBound;
   
 public:
   SolverImpl()
     : _pMwcsGraph(NULL)
+    , _pStartLabels(NULL)
+    , _lowerBound(-std::numeric_limits<double>::max())
   {
   }
   
@@ -47,6 +56,44 @@ public:
   }
   
   virtual bool solve(double& score, double& scoreUB, BoolNodeMap& solutionMap, NodeSet& solutionSet) = 0;
+  
+  /// Sets the module subsequent solves start from, given by node labels.
+  /// Implementations that cannot be warm started ignore it.
+  void setStartLabels(const StringSet* pStartLabels)
+  {
+    _pStartLabels = pStartLabels;
+  }
+  
+  /// Sets a lower bound on the optimal score of subsequent solves.
+  /// Implementations that cannot prune by it ignore it.
+  void setLowerBound(double LB)
+  {
+    _lowerBound = LB;
+  }
+  
+  /// Returns whether node v of mwcsGraph belongs to the start module,
+  /// i.e. whether its label or that of one of its original nodes is
+  /// in startLabels
+  static bool isStartNode(const MwcsGraphType& mwcsGraph,
+                          Node v,
+                          const StringSet& startLabels)
+  {
+    if (startLabels.count(mwcsGraph.getLabel(v)))
+    {
+      return true;
+    }
+    
+    const NodeSet orgNodes = mwcsGraph.getOrgNodes(v);
+    for (NodeSetIt nodeIt = orgNodes.begin(); nodeIt != orgNodes.end(); ++nodeIt)
+    {
+      if (startLabels.count(mwcsGraph.getOrgLabel(*nodeIt)))
+      {
+        return true;
+      }
+    }
+    
+    return false;
+  }
 };
 
 } // namespace mwcs
@@ -0,0 +1,217 @@
+/*
+ * spanningtreebuilder.h
+ *
+ *  Created on: 18-oct-2026
+ */
+
+#ifndef SPANNINGTREEBUILDER_H
+#define SPANNINGTREEBUILDER_H
+
+#include <lemon/core.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+namespace nina {
+namespace mwcs {
+
+/// \brief Kruskal's algorithm for repeated spanning tree computations
+///
+/// The edges are kept in a buffer in the order of the previous run. As
+/// costs derived from LP values change little from one B&B node to the
+/// next, that order is usually almost sorted and is repaired by insertion
+/// sort. Only if that takes too many moves, the edges are radix sorted on
+/// the bits of their costs as floats, so costs that agree in single
+/// precision are considered equal. The union-find forest is indexed by
+/// node id and reused as well, so run() allocates nothing and attaches no
+/// maps to the graph.
+template<typename GR,
+         typename CM = typename GR::template EdgeMap<double>,
+         typename TM = typename GR::template EdgeMap<bool> >
+class SpanningTreeBuilder
+{
+public:
+  typedef GR Graph;
+  typedef CM CostMap;
+  typedef TM TreeMap;
+
+  TEMPLATE_GRAPH_TYPEDEFS(Graph);
+
+private:
+  typedef std::vector<Edge> EdgeVector;
+  typedef std::vector<uint32_t> KeyVector;
+  typedef std::vector<int> IntVector;
+
+public:
+  SpanningTreeBuilder(const Graph& g)
+    : _g(g)
+    , _nNodes(lemon::countNodes(g))
+    , _edges()
+    , _keys()
+    , _tmpEdges()
+    , _tmpKeys()
+    , _parent(g.maxNodeId() + 1)
+    , _size(g.maxNodeId() + 1)
+  {
+    for (EdgeIt e(g); e != lemon::INVALID; ++e)
+    {
+      _edges.push_back(e);
+    }
+    _keys.resize(_edges.size());
+    _tmpEdges.resize(_edges.size());
+    _tmpKeys.resize(_edges.size());
+  }
+
+  /// Computes a minimum spanning forest with respect to \c cost,
+  /// which is stored in \c tree; returns its cost
+  double run(const CostMap& cost, TreeMap& tree);
+
+private:
+  const Graph& _g;
+  const int _nNodes;
+  /// Edges in the order of the previous run
+  EdgeVector _edges;
+  KeyVector _keys;
+  EdgeVector _tmpEdges;
+  KeyVector _tmpKeys;
+  /// Union-find forest by node id
+  IntVector _parent;
+  IntVector _size;
+
+  /// Maps a cost to an unsigned integer of the same order
+  static uint32_t key(double c)
+  {
+    const float f = static_cast<float>(c);
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+  }
+
+  int find(int i)
+  {
+    while (_parent[i] != i)
+    {
+      _parent[i] = _parent[_parent[i]];
+      i = _parent[i];
+    }
+    return i;
+  }
+
+  /// Insertion sort of the buffer, gives up after \c maxMoves moves
+  bool insertionSort(size_t maxMoves);
+
+  /// Stable LSD radix sort of the buffer with 8-bit digits
+  void radixSort();
+};
+
+template<typename GR, typename CM, typename TM>
+inline bool SpanningTreeBuilder<GR, CM, TM>::insertionSort(size_t maxMoves)
+{
+  const size_t m = _edges.size();
+  size_t nMoves = 0;
+  for (size_t i = 1; i < m; ++i)
+  {
+    const uint32_t k = _keys[i];
+    if (_keys[i - 1] <= k)
+      continue;
+
+    const Edge e = _edges[i];
+    size_t j = i;
+    for (; j > 0 && _keys[j - 1] > k; --j)
+    {
+      _keys[j] = _keys[j - 1];
+      _edges[j] = _edges[j - 1];
+    }
+    _keys[j] = k;
+    _edges[j] = e;
+
+    nMoves += i - j;
+    if (nMoves > maxMoves)
+      return false;
+  }
+  return true;
+}
+
+template<typename GR, typename CM, typename TM>
+inline void SpanningTreeBuilder<GR, CM, TM>::radixSort()
+{
+  const size_t m = _edges.size();
+  for (int shift = 0; shift < 32; shift += 8)
+  {
+    size_t count[257];
+    memset(count, 0, sizeof(count));
+    for (size_t i = 0; i < m; ++i)
+    {
+      ++count[((_keys[i] >> shift) & 0xFF) + 1];
+    }
+
+    // skip the digit if it is the same for all keys
+    if (count[((_keys[0] >> shift) & 0xFF) + 1] == m)
+      continue;
+
+    for (int d = 0; d < 256; ++d)
+    {
+      count[d + 1] += count[d];
+    }
+    for (size_t i = 0; i < m; ++i)
+    {
+      const size_t pos = count[(_keys[i] >> shift) & 0xFF]++;
+      _tmpKeys[pos] = _keys[i];
+      _tmpEdges[pos] = _edges[i];
+    }
+    _keys.swap(_tmpKeys);
+    _edges.swap(_tmpEdges);
+  }
+}
+
+template<typename GR, typename CM, typename TM>
+inline double SpanningTreeBuilder<GR, CM, TM>::run(const CostMap& cost, TreeMap& tree)
+{
+  const size_t m = _edges.size();
+  for (size_t i = 0; i < m; ++i)
+  {
+    _keys[i] = key(cost[_edges[i]]);
+    tree.set(_edges[i], false);
+  }
+
+  // radix sort takes four passes over the buffer
+  if (m > 0 && !insertionSort(4 * m))
+  {
+    radixSort();
+  }
+
+  for (NodeIt v(_g); v != lemon::INVALID; ++v)
+  {
+    const int id_v = _g.id(v);
+    _parent[id_v] = id_v;
+    _size[id_v] = 1;
+  }
+
+  double treeCost = 0;
+  int nTreeEdges = 0;
+  for (size_t i = 0; i < m && nTreeEdges < _nNodes - 1; ++i)
+  {
+    const Edge e = _edges[i];
+    int a = find(_g.id(_g.u(e)));
+    int b = find(_g.id(_g.v(e)));
+    if (a != b)
+    {
+      if (_size[a] < _size[b])
+        std::swap(a, b);
+      _parent[b] = a;
+      _size[a] += _size[b];
+
+      tree.set(e, true);
+      treeCost += cost[e];
+      ++nTreeEdges;
+    }
+  }
+
+  return treeCost;
+}
+
+} // namespace mwcs
+} // namespace nina
+
+#endif // SPANNINGTREEBUILDER_H
@@ -8,20 +8,25 @@
 #ifndef TREEHEURISTICSOLVERIMPL_H
 #define TREEHEURISTICSOLVERIMPL_H
 
+#include <algorithm>
+#include <functional>
 #include <set>
 #include <vector>
 #include <map>
 #include <limits>
+#include <mutex>
+#include <thread>
 #include <assert.h>
 #include <lemon/bfs.h>
 #include <lemon/connectivity.h>
 #include <lemon/adaptors.h>
-#include <lemon/kruskal.h>
 #include <lemon/random.h>
 #include <lemon/time_measure.h>
 #include "mwcsgraph.h"
 #include "../solver.h"
 #include "treesolverimpl.h"
+#include "dynamicspanningtree.h"
+#include "spanningtreebuilder.h"
 #include "analysis.h"
 
 namespace nina {
@@ -56,11 +61,17 @@ public:
     Options(EdgeHeuristic heuristic,
             bool analysis,
             int nRepetitions,
-            int timeLimit)
+            int timeLimit,
+            int nThreads = 1,
+            int seed = 0,
+            double perturbation = 0)
       : _heuristic(heuristic)
       , _analysis(analysis)
       , _nRepetitions(nRepetitions)
       , _timeLimit(timeLimit)
+      , _nThreads(nThreads)
+      , _seed(seed)
+      , _perturbation(perturbation)
     {
     }
     
@@ -68,6 +79,11 @@ public:
     bool _analysis;
     int _nRepetitions;
     int _timeLimit;
+    int _nThreads;
+    int _seed;
+    /// Fraction of nodes whose probability is resampled per iteration,
+    /// all edge costs are recomputed if not in (0,1)
+    double _perturbation;
   };
 
 protected:
@@ -82,68 +98,155 @@ protected:
   typedef std::vector<Node> NodeVector;
   typedef typename NodeVector::const_iterator NodeVectorIt;
   typedef typename NodeVector::iterator NodeVectorNonConstIt;
+  
+  typedef DynamicSpanningTree<Graph, DoubleEdgeMap, BoolEdgeMap> DynamicSpanningTreeType;
+  typedef SpanningTreeBuilder<Graph, DoubleEdgeMap, BoolEdgeMap> SpanningTreeBuilderType;
 
+  /// State of one Monte Carlo thread. All maps are allocated up front by
+  /// the calling thread and spanning trees are computed without maps, as
+  /// LEMON does not synchronize attaching maps to the shared graph. The only
+  /// exception is the evaluation of an improved solution, done under _mutex.
+  struct Worker
+  {
+    Worker(const MwcsGraphType& mwcsGraph, int seed)
+      : _filterMap(mwcsGraph.getGraph(), false)
+      , _subG(mwcsGraph.getGraph(), _filterMap)
+      , _mwcsSubGraph()
+      , _edgeCost(mwcsGraph.getGraph())
+      , _nodeProb(mwcsGraph.getGraph())
+      , _solutionMap(_subG, false)
+      , _solutionSet()
+      , _rnd(seed)
+      , _pSubTreeSolver(NULL)
+      , _nodes()
+      , _minScore(lemon::mapMinValue(mwcsGraph.getGraph(), mwcsGraph.getScores()))
+      , _maxScore(lemon::mapMaxValue(mwcsGraph.getGraph(), mwcsGraph.getScores()))
+      , _spanningTree(mwcsGraph.getGraph(), _edgeCost, _filterMap)
+      , _hasSpanningTree(false)
+      , _spanningTreeBuilder(mwcsGraph.getGraph())
+    {
+      _mwcsSubGraph.init(&_subG, NULL, &mwcsGraph.getScores(), NULL);
+      for (NodeIt n(mwcsGraph.getGraph()); n != lemon::INVALID; ++n)
+      {
+        _nodes.push_back(n);
+      }
+    }
+    
+    ~Worker()
+    {
+      delete _pSubTreeSolver;
+    }
+    
+    BoolEdgeMap _filterMap;
+    SubGraphType _subG;
+    MwcsSubGraphType _mwcsSubGraph;
+    DoubleEdgeMap _edgeCost;
+    DoubleNodeMap _nodeProb;
+    SubBoolNodeMap _solutionMap;
+    NodeSet _solutionSet;
+    lemon::Random _rnd;
+    MwcsSubTreeSolverType* _pSubTreeSolver;
+    NodeVector _nodes;
+    const double _minScore;
+    const double _maxScore;
+    /// Spanning tree given by _filterMap, maintained in the incremental mode
+    DynamicSpanningTreeType _spanningTree;
+    bool _hasSpanningTree;
+    SpanningTreeBuilderType _spanningTreeBuilder;
+    
+  private:
+    Worker(const Worker&);
+    void operator=(const Worker&);
+  };
+  
+  typedef std::vector<Worker*> WorkerVector;
+  
   Options _options;
-  BoolEdgeMap* _pFilterMap;
-  SubGraphType* _pSubG;
-  MwcsSubGraphType* _pMwcsSubGraph;
-  DoubleEdgeMap* _pEdgeCost;
   
 private:
   MwcsAnalyzeType* _pAnalysis;
+  WorkerVector _workers;
+  
+  /// Shared by the workers, protected by _mutex
+  std::mutex _mutex;
+  int _iteration;
+  lemon::Timer _timer;
 
 protected:
   TreeHeuristicSolverImpl(Options options)
     : _options(options)
-    , _pFilterMap(NULL)
-    , _pSubG(NULL)
-    , _pMwcsSubGraph(NULL)
-    , _pEdgeCost(NULL)
     , _pAnalysis(NULL)
+    , _workers()
+    , _mutex()
+    , _iteration(0)
+    , _timer()
   {
   }
 
   virtual ~TreeHeuristicSolverImpl()
   {
-    delete _pFilterMap;
-    delete _pMwcsSubGraph;
-    
-    delete _pEdgeCost;
-    
-    delete _pSubG;
-    
+    clearWorkers();
     delete _pAnalysis;
   }
 
   void init(const MwcsGraphType& mwcsGraph);
   
   bool solveMonteCarlo(const MwcsGraphType& mwcsGraph,
-                       MwcsSubTreeSolverType& subTreeSolver,
                        double& score,
                        BoolNodeMap& solutionMap,
                        NodeSet& solutionSet);
   
-  void computeEdgeCosts(const MwcsGraphType& mwcsGraph);
+  void computeEdgeCosts(const MwcsGraphType& mwcsGraph, Worker& worker);
   
-  virtual void initSubTreeSolver() = 0;
+  /// Resamples the probabilities of a fraction of the nodes and
+  /// updates the costs of their edges and the spanning tree
+  void perturbEdgeCosts(const MwcsGraphType& mwcsGraph, Worker& worker);
   
-  virtual bool solveSubTree(double& score, SubBoolNodeMap& solutionMap, NodeSet& solutionSet) = 0;
+  /// Edge costs do not change in between iterations
+  bool deterministicCosts() const
+  {
+    return !_options._analysis
+        && (_options._heuristic == EDGE_COST_FIXED || _options._heuristic == EDGE_COST_MIN_MAX);
+  }
+  
+  /// Edge costs are perturbed rather than recomputed in between iterations
+  bool incrementalCosts() const
+  {
+    return !_options._analysis
+        && (_options._heuristic == EDGE_COST_RANDOM || _options._heuristic == EDGE_COST_UNIFORM_RANDOM)
+        && 0 < _options._perturbation && _options._perturbation < 1;
+  }
+  
+  /// Returns a sub tree solver that has been initialized with \c mwcsSubGraph
+  virtual MwcsSubTreeSolverType* createSubTreeSolver(const MwcsSubGraphType& mwcsSubGraph) = 0;
   
 private:
-  void analyzeNegHubs(const MwcsGraphType& mwcsGraph);
+  void analyzeNegHubs(const MwcsGraphType& mwcsGraph, Worker& worker);
+  
+  void clearWorkers();
+  
+  void runWorker(const MwcsGraphType& mwcsGraph,
+                 Worker& worker,
+                 double& score,
+                 BoolNodeMap& solutionMap,
+                 NodeSet& solutionSet);
 };
 
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::clearWorkers()
+{
+  for (typename WorkerVector::const_iterator it = _workers.begin(); it != _workers.end(); ++it)
+  {
+    delete *it;
+  }
+  _workers.clear();
+}
+
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
 inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::init(const MwcsGraphType& mwcsGraph)
 {
-  const Graph& g = mwcsGraph.getGraph();
-  
-  delete _pFilterMap;
-  _pFilterMap = new BoolEdgeMap(g);
-  
-  delete _pSubG;
-  _pSubG = new SubGraphType(g, *_pFilterMap);
-  
+  delete _pAnalysis;
+  _pAnalysis = NULL;
   if (_options._analysis)
   {
     _pAnalysis = new MwcsAnalyzeType(mwcsGraph);
@@ -156,20 +259,16 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::init(const MwcsGrap
                 << std::endl;
     }
   }
-  
-  delete _pEdgeCost;
-  _pEdgeCost = new DoubleEdgeMap(g);
-  
-  delete _pMwcsSubGraph;
-  _pMwcsSubGraph = new MwcsSubGraphType();
-  _pMwcsSubGraph->init(_pSubG, NULL, &mwcsGraph.getScores(), NULL);
 }
   
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
-inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::computeEdgeCosts(const MwcsGraphType& mwcsGraph)
+inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::computeEdgeCosts(const MwcsGraphType& mwcsGraph,
+                                                                              Worker& worker)
 {
   const Graph& g = mwcsGraph.getGraph();
   const DoubleNodeMap& score = mwcsGraph.getScores();
+  DoubleNodeMap& nodeProb = worker._nodeProb;
+  DoubleEdgeMap& edgeCost = worker._edgeCost;
   
   switch (_options._heuristic)
   {
@@ -178,7 +277,6 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::computeEdgeCosts(co
         double minScore = lemon::mapMinValue(g, score);
         double maxScore = lemon::mapMaxValue(g, score);
         
-        DoubleNodeMap nodeProb(g);
         for (NodeIt n(g); n != lemon::INVALID; ++n)
         {
           double score_n = score[n];
@@ -195,7 +293,7 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::computeEdgeCosts(co
           double w_u = nodeProb[u];
           double w_v = nodeProb[v];
           
-          _pEdgeCost->set(e, 2 - (w_u + w_v));
+          edgeCost.set(e, 2 - (w_u + w_v));
         }
       }
       break;
@@ -208,15 +306,14 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::computeEdgeCosts(co
         double w_u = mwcsGraph.getScore(u);
         double w_v = mwcsGraph.getScore(v);
         
-        _pEdgeCost->set(e, - (w_u + w_v));
+        edgeCost.set(e, - (w_u + w_v));
       }
       break;
     case EDGE_COST_RANDOM:
       {
-        DoubleNodeMap nodeProb(g);
         for (NodeIt n(g); n != lemon::INVALID; ++n)
         {
-          nodeProb[n] = lemon::rnd.real();
+          nodeProb[n] = worker._rnd.real();
         }
         
         for (EdgeIt e(g); e != lemon::INVALID; ++e)
@@ -227,7 +324,7 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::computeEdgeCosts(co
           double w_u = nodeProb[u];
           double w_v = nodeProb[v];
           
-          _pEdgeCost->set(e, 2 - (w_u + w_v));
+          edgeCost.set(e, 2 - (w_u + w_v));
         }
       }
       break;
@@ -237,13 +334,12 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::computeEdgeCosts(co
         double minScore = lemon::mapMinValue(g, score);
         double maxScore = lemon::mapMaxValue(g, score);
         
-        DoubleNodeMap nodeProb(g);
         for (NodeIt n(g); n != lemon::INVALID; ++n)
         {
           double score_n = score[n];
           // let's do min-max normalization
           double norm_score_n = (score_n - minScore) / (maxScore - minScore);
-          nodeProb[n] = lemon::rnd(norm_score_n);
+          nodeProb[n] = worker._rnd(norm_score_n);
         }
         
         for (EdgeIt e(g); e != lemon::INVALID; ++e)
@@ -254,7 +350,7 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::computeEdgeCosts(co
           double w_u = nodeProb[u];
           double w_v = nodeProb[v];
           
-          _pEdgeCost->set(e, 2 - (w_u + w_v));
+          edgeCost.set(e, 2 - (w_u + w_v));
         }
       }
       break;
@@ -263,12 +359,51 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::computeEdgeCosts(co
   if (_options._analysis)
   {
     assert(_pAnalysis);
-    analyzeNegHubs(mwcsGraph);
+    analyzeNegHubs(mwcsGraph, worker);
+  }
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::perturbEdgeCosts(const MwcsGraphType& mwcsGraph,
+                                                                              Worker& worker)
+{
+  assert(incrementalCosts());
+  
+  const Graph& g = mwcsGraph.getGraph();
+  const int n = static_cast<int>(worker._nodes.size());
+  if (n == 0)
+    return;
+  
+  const int nDraws = std::max(1, static_cast<int>(_options._perturbation * n));
+  
+  for (int i = 0; i < nDraws; ++i)
+  {
+    Node x = worker._nodes[worker._rnd.integer(n)];
+    if (_options._heuristic == EDGE_COST_RANDOM)
+    {
+      worker._nodeProb[x] = worker._rnd.real();
+    }
+    else
+    {
+      // let's do min-max normalization
+      double norm_score_x = (mwcsGraph.getScore(x) - worker._minScore)
+          / (worker._maxScore - worker._minScore);
+      worker._nodeProb[x] = worker._rnd(norm_score_x);
+    }
+    
+    // the spanning tree is updated edge by edge
+    for (IncEdgeIt e(g, x); e != lemon::INVALID; ++e)
+    {
+      double oldCost = worker._edgeCost[e];
+      worker._edgeCost.set(e, 2 - (worker._nodeProb[g.u(e)] + worker._nodeProb[g.v(e)]));
+      worker._spanningTree.update(e, oldCost);
+    }
   }
 }
 
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
-inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::analyzeNegHubs(const MwcsGraphType& mwcsGraph)
+inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::analyzeNegHubs(const MwcsGraphType& mwcsGraph,
+                                                                            Worker& worker)
 {
   const Graph& g = mwcsGraph.getGraph();
   
@@ -279,7 +414,7 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::analyzeNegHubs(cons
   
   for (int i = 0; i < nDraws; i++)
   {
-    int spot = lemon::rnd.integer(static_cast<int>(rouletteWheel.size()));
+    int spot = worker._rnd.integer(static_cast<int>(rouletteWheel.size()));
     Node negHub = rouletteWheel[spot];
     
     // remove everything from rouletteWheel corresponding to negHub;
@@ -292,8 +427,8 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::analyzeNegHubs(cons
       Node posNeighbor = g.oppositeNode(negHub, e);
       if (mwcsGraph.getScore(posNeighbor) >= 0)
       {
-        double c = lemon::rnd(1e-3);
-        _pEdgeCost->set(e, c);
+        double c = worker._rnd(1e-3);
+        worker._edgeCost.set(e, c);
       }
     }
   }
@@ -301,7 +436,7 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::analyzeNegHubs(cons
   const NodeSet& negHubs = _pAnalysis->getBeneficialNegHubs();
   for (NodeSetIt negHubIt = negHubs.begin(); negHubIt != negHubs.end(); negHubIt++)
   {
-    if (lemon::rnd(1) < 0.1)
+    if (worker._rnd(1) < 0.1)
     {
       Node negHub = *negHubIt;
       for (IncEdgeIt e(g, negHub); e != lemon::INVALID; ++e)
@@ -309,8 +444,8 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::analyzeNegHubs(cons
         Node posNeighbor = g.oppositeNode(negHub, e);
         if (mwcsGraph.getScore(posNeighbor) >= 0)
         {
-          double c = lemon::rnd(1e-3);
-          _pEdgeCost->set(e, c);
+          double c = worker._rnd(1e-3);
+          worker._edgeCost.set(e, c);
         }
       }
     }
@@ -319,81 +454,137 @@ inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::analyzeNegHubs(cons
   
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
 inline bool TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::solveMonteCarlo(const MwcsGraphType& mwcsGraph,
-                                                                             MwcsSubTreeSolverType& subTreeSolver,
                                                                              double& score,
                                                                              BoolNodeMap& solutionMap,
                                                                              NodeSet& solutionSet)
 {
-  typedef typename MwcsSubTreeSolverType::BoolNodeMap SubBoolNodeMap;
+  // with deterministic costs every iteration finds the same tree
+  const int nThreads = deterministicCosts() ? 1 : std::max(1, _options._nThreads);
   
-  const Graph& g = mwcsGraph.getGraph();
+  // worker t uses the t-th seed drawn from a generator seeded by _seed,
+  // so runs with the same seed and number of threads draw the same costs
+  clearWorkers();
+  lemon::Random seeds(_options._seed);
+  for (int t = 0; t < nThreads; ++t)
+  {
+    Worker* pWorker = new Worker(mwcsGraph, seeds.integer(std::numeric_limits<int>::max()));
+    pWorker->_pSubTreeSolver = createSubTreeSolver(pWorker->_mwcsSubGraph);
+    _workers.push_back(pWorker);
+  }
+  
+  _iteration = 0;
+  _timer.restart();
   
+  if (nThreads == 1)
+  {
+    runWorker(mwcsGraph, *_workers.front(), score, solutionMap, solutionSet);
+  }
+  else
+  {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nThreads; ++t)
+    {
+      threads.push_back(std::thread(&TreeHeuristicSolverImpl::runWorker, this,
+                                    std::cref(mwcsGraph), std::ref(*_workers[t]),
+                                    std::ref(score), std::ref(solutionMap), std::ref(solutionSet)));
+    }
+    for (int t = 0; t < nThreads; ++t)
+    {
+      threads[t].join();
+    }
+  }
+  
+  if (g_verbosity >= VERBOSE_DEBUG)
+  {
+    std::cerr << std::endl;
+  }
+  
+  clearWorkers();
+  
+  return true;
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void TreeHeuristicSolverImpl<GR, NWGHT, NLBL, EWGHT>::runWorker(const MwcsGraphType& mwcsGraph,
+                                                                       Worker& worker,
+                                                                       double& score,
+                                                                       BoolNodeMap& solutionMap,
+                                                                       NodeSet& solutionSet)
+{
   double newScore;
   double newScoreUB;
-  SubBoolNodeMap newSolutionMap(_pMwcsSubGraph->getGraph());
-  NodeSet newSolutionSet;
-
-  lemon::Timer timer;
   double elapsedTimeLastIt = 0;
-  for (int i = 0; i < _options._nRepetitions || _options._nRepetitions == -1; ++i)
+  while (true)
   {
-    double curTime = timer.realTime();
+    double curTime = _timer.realTime();
     if (_options._timeLimit > 0 && (curTime + elapsedTimeLastIt) > _options._timeLimit)
     {
       // don't attempt a new iteration, if it's going take longer than the time limit
       break;
     }
-
-    if (g_verbosity >= VERBOSE_DEBUG)
+    
     {
-      std::cerr << "\rIteration " << i << ": " << std::flush;
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_options._nRepetitions != -1 && _iteration >= _options._nRepetitions)
+        break;
+      if (deterministicCosts() && _iteration > 0)
+        break;
+      
+      if (g_verbosity >= VERBOSE_DEBUG)
+      {
+        std::cerr << "\rIteration " << _iteration << ": " << score << std::flush;
+      }
+      ++_iteration;
     }
     
-    computeEdgeCosts(mwcsGraph);
-
-    // compute minimum spanning tree
-    lemon::kruskal(g, *_pEdgeCost, *_pFilterMap);
-
-    initSubTreeSolver();
-    if (!subTreeSolver.solve(newScore, newScoreUB, newSolutionMap, newSolutionSet))
+    if (worker._hasSpanningTree)
     {
-      return false;
+      perturbEdgeCosts(mwcsGraph, worker);
     }
-    
-    if (score < newScore)
+    else
     {
-      score = newScore;
+      computeEdgeCosts(mwcsGraph, worker);
       
-      lemon::mapCopy(_pMwcsSubGraph->getGraph(), newSolutionMap, solutionMap);
-      solutionSet = newSolutionSet;
+      // compute minimum spanning tree
+      worker._spanningTreeBuilder.run(worker._edgeCost, worker._filterMap);
       
-      if (g_pOut)
+      if (incrementalCosts())
       {
-        *g_pOut << "Solution " << g_timer.realTime() << " " << reEvaluatePCST(mwcsGraph, solutionSet) << std::endl;
+        worker._spanningTree.init();
+        worker._hasSpanningTree = true;
       }
     }
+
+    if (!worker._pSubTreeSolver->solve(newScore, newScoreUB, worker._solutionMap, worker._solutionSet))
+    {
+      break;
+    }
     
-    if (g_verbosity >= VERBOSE_DEBUG)
     {
-      std::cerr << score << std::flush;
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (score < newScore)
+      {
+        score = newScore;
+        
+        lemon::mapCopy(worker._subG, worker._solutionMap, solutionMap);
+        solutionSet = worker._solutionSet;
+        
+        if (g_pOut)
+        {
+          *g_pOut << "Solution " << g_timer.realTime() << " " << reEvaluatePCST(mwcsGraph, solutionSet) << std::endl;
+        }
+      }
     }
     
-    if (_options._timeLimit > 0 && timer.realTime() > _options._timeLimit)
+    if (_options._timeLimit > 0 && _timer.realTime() > _options._timeLimit)
     {
       break;
     }
     else
     {
-      elapsedTimeLastIt = timer.realTime() - curTime;
+      elapsedTimeLastIt = _timer.realTime() - curTime;
     }
   }
-  
-  if (g_verbosity >= VERBOSE_DEBUG)
-  {
-    std::cerr << std::endl;
-  }
-  
-  return true;
 }
 
   
@@ -46,17 +46,13 @@ public:
   using Parent1::_rootNodes;
   
   using Parent2::_options;
-  using Parent2::_pFilterMap;
-  using Parent2::_pSubG;
-  using Parent2::_pMwcsSubGraph;
-  using Parent2::_pEdgeCost;
   using Parent2::solveMonteCarlo;
 
 protected:
   typedef typename Parent2::SubGraphType SubGraphType;
   typedef typename Parent2::MwcsSubGraphType MwcsSubGraphType;
   typedef typename Parent2::MwcsAnalyzeType MwcsAnalyzeType;
-  typedef typename Parent2::SubBoolNodeMap SubBoolNodeMap;
+  typedef typename Parent2::MwcsSubTreeSolverType MwcsSubTreeSolverType;
   
   typedef TreeSolverRootedImpl<const SubGraphType, const WeightNodeMap, LabelNodeMap, DoubleEdgeMap> MwcsRootedSubTreeSolverType;
   
@@ -64,7 +60,6 @@ public:
   TreeHeuristicSolverRootedImpl(const Options& options)
     : Parent1()
     , Parent2(options)
-    , _mwcsRootedSubTreeSolver()
   {
   }
 
@@ -78,23 +73,16 @@ public:
   bool solve(double& score, double& solveUB, BoolNodeMap& solutionMap, NodeSet& solutionSet)
   {
     solveUB = std::numeric_limits<double>::max();
-    return solveMonteCarlo(*_pMwcsGraph, _mwcsRootedSubTreeSolver, score, solutionMap, solutionSet);
+    return solveMonteCarlo(*_pMwcsGraph, score, solutionMap, solutionSet);
   }
   
 protected:
-  void initSubTreeSolver()
+  MwcsSubTreeSolverType* createSubTreeSolver(const MwcsSubGraphType& mwcsSubGraph)
   {
-    _mwcsRootedSubTreeSolver.init(*_pMwcsSubGraph, _rootNodes);
+    MwcsRootedSubTreeSolverType* pSubTreeSolver = new MwcsRootedSubTreeSolverType();
+    pSubTreeSolver->init(mwcsSubGraph, _rootNodes);
+    return pSubTreeSolver;
   }
-  
-  bool solveSubTree(double& score, SubBoolNodeMap& solutionMap, NodeSet& solutionSet)
-  {
-    double scoreUB;
-    return _mwcsRootedSubTreeSolver.solve(score, scoreUB, solutionMap, solutionSet);
-  }
-  
-private:
-  MwcsRootedSubTreeSolverType _mwcsRootedSubTreeSolver;
 };
 
 } // namespace mwcs
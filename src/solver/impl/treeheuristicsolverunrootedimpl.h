@@ -45,17 +45,13 @@ public:
   using Parent1::_pMwcsGraph;
   
   using Parent2::_options;
-  using Parent2::_pFilterMap;
-  using Parent2::_pSubG;
-  using Parent2::_pMwcsSubGraph;
-  using Parent2::_pEdgeCost;
   using Parent2::solveMonteCarlo;
 
 protected:
   typedef typename Parent2::SubGraphType SubGraphType;
   typedef typename Parent2::MwcsSubGraphType MwcsSubGraphType;
   typedef typename Parent2::MwcsAnalyzeType MwcsAnalyzeType;
-  typedef typename Parent2::SubBoolNodeMap SubBoolNodeMap;
+  typedef typename Parent2::MwcsSubTreeSolverType MwcsSubTreeSolverType;
 
   typedef TreeSolverUnrootedImpl<const SubGraphType, const WeightNodeMap, LabelNodeMap, DoubleEdgeMap> MwcsUnrootedSubTreeSolverType;
 
@@ -63,7 +59,6 @@ public:
   TreeHeuristicSolverUnrootedImpl(const Options& options)
     : Parent1()
     , Parent2(options)
-    , _mwcsUnrootedSubTreeSolver()
   {
   }
 
@@ -76,23 +71,16 @@ public:
   bool solve(double& score, double& scoreUB, BoolNodeMap& solutionMap, NodeSet& solutionSet)
   {
     scoreUB = std::numeric_limits<double>::max();
-    return solveMonteCarlo(*_pMwcsGraph, _mwcsUnrootedSubTreeSolver, score, solutionMap, solutionSet);
+    return solveMonteCarlo(*_pMwcsGraph, score, solutionMap, solutionSet);
   }
   
 protected:
-  void initSubTreeSolver()
+  MwcsSubTreeSolverType* createSubTreeSolver(const MwcsSubGraphType& mwcsSubGraph)
   {
-    _mwcsUnrootedSubTreeSolver.init(*_pMwcsSubGraph);
+    MwcsUnrootedSubTreeSolverType* pSubTreeSolver = new MwcsUnrootedSubTreeSolverType();
+    pSubTreeSolver->init(mwcsSubGraph);
+    return pSubTreeSolver;
   }
-  
-  bool solveSubTree(double& score, SubBoolNodeMap& solutionMap, NodeSet& solutionSet)
-  {
-    double scoreUB;
-    return _mwcsUnrootedSubTreeSolver.solve(score, scoreUB, solutionMap, solutionSet);
-  }
-  
-private:
-  MwcsUnrootedSubTreeSolverType _mwcsUnrootedSubTreeSolver;
 };
 
 } // namespace mwcs
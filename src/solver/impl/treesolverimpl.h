@@ -14,7 +14,6 @@
 #include <map>
 #include <limits>
 #include <assert.h>
-#include <lemon/bfs.h>
 #include <lemon/connectivity.h>
 
 namespace nina {
@@ -37,60 +36,39 @@ public:
   TEMPLATE_GRAPH_TYPEDEFS(Graph);
 
 protected:
-  typedef typename lemon::Bfs<Graph>::PredMap PredMap;
-  typedef typename lemon::Bfs<Graph>::DistMap DistMap;
-
   typedef std::set<Node> NodeSet;
   typedef typename NodeSet::const_iterator NodeSetIt;
   
-  typedef std::vector<NodeSet> NodeSetVector;
-  typedef typename NodeSetVector::const_iterator NodeSetVectorIt;
-  typedef typename NodeSetVector::const_reverse_iterator NodeSetVectorRevIt;
-
-  struct DpEntry {
-    double _weight;
-    NodeSet _solution;
-    NodeSet _children;
-
-    DpEntry()
-      : _weight(-std::numeric_limits<double>::max())
-      , _solution()
-      , _children()
-    {
-    }
-
-    void clear()
-    {
-      _weight = -std::numeric_limits<double>::max();
-      _solution.clear();
-      _children.clear();
-    }
-  };
+  typedef std::vector<Node> NodeVector;
+  typedef typename NodeVector::const_iterator NodeVectorIt;
   
-  typedef typename Graph::template NodeMap<DpEntry> DpEntryMap;
-  typedef lemon::Bfs<Graph> BfsType;
+  typedef std::vector<int> IntVector;
+  typedef std::vector<double> DoubleVector;
+  typedef std::vector<bool> BoolVector;
 
 protected:
   TreeSolverImpl()
-    : _pDpMap(NULL)
-    , _nodesPerLevel()
-    , _pPred(NULL)
-    , _pLevel(NULL)
-    , _pBfs(NULL)
+    : _order()
+    , _parent()
+    , _weight()
+    , _included()
+    , _forced()
+    , _index()
+    , _pGraph(NULL)
     , _root(lemon::INVALID)
   {
   }
-  
+
+public:
   virtual ~TreeSolverImpl()
   {
-    delete _pDpMap;
-    delete _pPred;
-    delete _pLevel;
-    delete _pBfs;
   }
-
-public:
+  
+  /// Orders the tree containing \c root
   void init(const MwcsGraphType& mwcsGraph, Node root);
+  
+  /// Orders every tree of the forest
+  void initForest(const MwcsGraphType& mwcsGraph);
  
   virtual bool solve(double& score,
                      double& scoreUB,
@@ -98,60 +76,170 @@ public:
                      NodeSet& solutionSet) = 0;
 
 protected:
-  DpEntryMap* _pDpMap;
-  NodeSetVector _nodesPerLevel;
-  PredMap* _pPred;
-  DistMap* _pLevel;
-  BfsType* _pBfs;
+  void clear(const MwcsGraphType& mwcsGraph);
+  
+  void addTree(const MwcsGraphType& mwcsGraph, Node root);
+  
+  /// Node \c node is part of every solution that contains the tree root
+  void force(Node node)
+  {
+    const int k = _index[_pGraph->id(node)];
+    if (k != -1)
+      _forced[k] = true;
+  }
+  
+  /// Bottom-up pass: _weight[k] becomes the weight of the best subtree
+  /// whose topmost node is _order[k], _included[k] tells whether that
+  /// subtree is attached to the parent of _order[k]
+  void bottomUp(const WeightNodeMap& weight);
+  
+  /// Top-down pass that collects the best subtree whose topmost node is _order[k]
+  void construct(int k, BoolNodeMap& solutionMap, NodeSet& solutionSet);
+
+protected:
+  /// Nodes in BFS order per tree, so parents precede their children;
+  /// all other members are indexed by position in _order
+  NodeVector _order;
+  IntVector _parent;
+  DoubleVector _weight;
+  BoolVector _included;
+  BoolVector _forced;
+  /// Position in _order of every node (by node id), -1 if not ordered
+  IntVector _index;
+  const Graph* _pGraph;
   Node _root;
 };
 
 template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
-inline void TreeSolverImpl<GR, NWGHT, NLBL, EWGHT>::init(const MwcsGraphType& mwcsGraph,
-                                                         Node root)
+inline void TreeSolverImpl<GR, NWGHT, NLBL, EWGHT>::clear(const MwcsGraphType& mwcsGraph)
 {
   const Graph& g = mwcsGraph.getGraph();
+  
+  // vectors keep their capacity, so repeated calls do not allocate
+  _pGraph = &g;
+  _order.clear();
+  _parent.clear();
+  _weight.clear();
+  _included.clear();
+  _forced.clear();
+  _index.assign(g.maxNodeId() + 1, -1);
+}
 
-  // initialize data structures
-  delete _pDpMap;
-  _nodesPerLevel.clear();
-  delete _pPred;
-  delete _pLevel;
-  delete _pBfs;
-  
-  _pDpMap = new DpEntryMap(g);
-  _pPred = new PredMap(g, lemon::INVALID);
-  _pLevel = new DistMap(g);
-  _pBfs = new BfsType(g);
-  _pBfs->predMap(*_pPred);
-  _pBfs->distMap(*_pLevel);
-  _root = root;
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void TreeSolverImpl<GR, NWGHT, NLBL, EWGHT>::addTree(const MwcsGraphType& mwcsGraph,
+                                                            Node root)
+{
+  const Graph& g = mwcsGraph.getGraph();
   
-  assert(lemon::acyclic(g));
-  assert(_root != lemon::INVALID);
+  const size_t first = _order.size();
+  _index[g.id(root)] = static_cast<int>(first);
+  _order.push_back(root);
+  _parent.push_back(-1);
   
-  // start by doing a bfs to determine levels
-  _pBfs->init();
-  _pBfs->addSource(_root);
-
-  while (!_pBfs->emptyQueue())
+  // bfs, the queue is the tail of _order
+  size_t degreeSum = 0;
+  for (size_t k = first; k < _order.size(); ++k)
   {
-    Node node = _pBfs->processNextNode();
-    int bfsLevel = (*_pLevel)[node];
+    const Node u = _order[k];
+    _weight.push_back(0);
+    _included.push_back(false);
+    _forced.push_back(false);
+    
+    for (IncEdgeIt e(g, u); e != lemon::INVALID; ++e, ++degreeSum)
+    {
+      const Node v = g.oppositeNode(u, e);
+      if (_index[g.id(v)] == -1)
+      {
+        _index[g.id(v)] = static_cast<int>(_order.size());
+        _order.push_back(v);
+        _parent.push_back(static_cast<int>(k));
+      }
+    }
+  }
+  
+  // the component is a tree iff it has one edge less than nodes; unlike
+  // lemon::acyclic this attaches no map to the (shared) graph
+  assert(degreeSum == 2 * (_order.size() - first - 1));
+}
 
-    if (bfsLevel == static_cast<int>(_nodesPerLevel.size()))
-      _nodesPerLevel.push_back(NodeSet());
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void TreeSolverImpl<GR, NWGHT, NLBL, EWGHT>::init(const MwcsGraphType& mwcsGraph,
+                                                         Node root)
+{
+  assert(root != lemon::INVALID);
+  
+  clear(mwcsGraph);
+  _root = root;
+  addTree(mwcsGraph, root);
+}
 
-    _nodesPerLevel[bfsLevel].insert(node);
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void TreeSolverImpl<GR, NWGHT, NLBL, EWGHT>::initForest(const MwcsGraphType& mwcsGraph)
+{
+  const Graph& g = mwcsGraph.getGraph();
+  
+  clear(mwcsGraph);
+  _root = lemon::INVALID;
+  for (NodeIt root(g); root != lemon::INVALID; ++root)
+  {
+    if (_index[g.id(root)] == -1)
+    {
+      addTree(mwcsGraph, root);
+    }
+  }
+}
 
-    Node parent = (*_pPred)[node] != lemon::INVALID ?
-          g.oppositeNode(node, (*_pPred)[node]) : lemon::INVALID;
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void TreeSolverImpl<GR, NWGHT, NLBL, EWGHT>::bottomUp(const WeightNodeMap& weight)
+{
+  const int n = static_cast<int>(_order.size());
+  for (int k = 0; k < n; ++k)
+  {
+    _weight[k] = weight[_order[k]];
+  }
+  
+  for (int k = n - 1; k >= 0; --k)
+  {
+    _included[k] = _weight[k] > 0 || _forced[k];
+    if (_parent[k] != -1 && _included[k])
+    {
+      _weight[_parent[k]] += _weight[k];
+      // the path to a forced node is forced as well
+      if (_forced[k])
+        _forced[_parent[k]] = true;
+    }
+  }
+}
 
-    if (parent != lemon::INVALID)
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline void TreeSolverImpl<GR, NWGHT, NLBL, EWGHT>::construct(int k,
+                                                              BoolNodeMap& solutionMap,
+                                                              NodeSet& solutionSet)
+{
+  const int n = static_cast<int>(_order.size());
+  assert(0 <= k && k < n);
+  
+  solutionSet.clear();
+  for (int l = 0; l < k; ++l)
+  {
+    solutionMap[_order[l]] = false;
+  }
+  
+  // descendants of _order[k] follow it in _order, _included is overwritten
+  // by whether the node is part of the solution
+  _included[k] = true;
+  for (int l = k; l < n; ++l)
+  {
+    if (l != k)
+    {
+      const int p = _parent[l];
+      _included[l] = _included[l] && p >= k && _included[p];
+    }
+    
+    solutionMap[_order[l]] = _included[l];
+    if (_included[l])
     {
-      //std::cout << "Child: " << _mwcsGraph.getLabel(node)
-      //          << " parent: " << _mwcsGraph.getLabel(parent) << std::endl;
-      (*_pDpMap)[parent]._children.insert(node);
+      solutionSet.insert(_order[l]);
     }
   }
 }
@@ -43,22 +43,11 @@ public:
   using Parent1::_pMwcsGraph;
   using Parent1::_rootNodes;
   
-  using Parent2::_pDpMap;
-  using Parent2::_nodesPerLevel;
-  using Parent2::_pPred;
-  using Parent2::_pLevel;
-  using Parent2::_pBfs;
-  using Parent2::_root;
+  using Parent2::_weight;
   
 protected:
-  typedef typename Parent2::PredMap PredMap;
-  typedef typename Parent2::DistMap DistMap;
-  typedef typename Parent2::NodeSetVector NodeSetVector;
-  typedef typename Parent2::NodeSetVectorIt NodeSetVectorIt;
-  typedef typename Parent2::NodeSetVectorRevIt NodeSetVectorRevIt;
-  typedef typename Parent2::DpEntry DpEntry;
-  typedef typename Parent2::DpEntryMap DpEntryMap;
-  typedef typename Parent2::BfsType BfsType;
+  typedef typename Parent2::NodeVector NodeVector;
+  typedef typename Parent2::NodeVectorIt NodeVectorIt;
   
 public:
   TreeSolverRootedImpl()
@@ -73,7 +62,6 @@ public:
                     const NodeSet& rootNodes)
   {
     Parent1::init(mwcsGraph, rootNodes);
-    Parent2::init(mwcsGraph, *_rootNodes.begin());
   }
 };
 
@@ -84,39 +72,20 @@ inline bool TreeSolverRootedImpl<GR, NWGHT, NLBL, EWGHT>::solve(double& score,
                                                                 BoolNodeMap& solutionMap,
                                                                 NodeSet& solutionSet)
 {
-  const WeightNodeMap& weight = _pMwcsGraph->getScores();
+  // the tree is ordered here rather than in init(),
+  // as the graph may be a filtered graph that changes in between calls
+  Parent2::init(*_pMwcsGraph, *_rootNodes.begin());
   
-  // work bottom-up
-  for (NodeSetVectorRevIt nodeSetIt = _nodesPerLevel.rbegin();
-       nodeSetIt != _nodesPerLevel.rend(); nodeSetIt++)
+  // root nodes are always attached to their parent
+  for (NodeSetIt nodeIt = _rootNodes.begin(); nodeIt != _rootNodes.end(); nodeIt++)
   {
-    for (NodeSetIt nodeIt = nodeSetIt->begin(); nodeIt != nodeSetIt->end(); nodeIt++)
-    {
-      Node node = *nodeIt;
-      (*_pDpMap)[node]._solution.insert(node);
-      (*_pDpMap)[node]._weight = weight[node];
-      
-      const NodeSet& children = (*_pDpMap)[node]._children;
-      for (NodeSetIt childIt = children.begin(); childIt != children.end(); childIt++)
-      {
-        double childWeight = (*_pDpMap)[*childIt]._weight;
-        if (childWeight > 0 || _rootNodes.find(*childIt) != _rootNodes.end())
-        {
-          (*_pDpMap)[node]._weight += childWeight;
-          (*_pDpMap)[node]._solution.insert(
-          (*_pDpMap)[*childIt]._solution.begin(), (*_pDpMap)[*childIt]._solution.end());
-        }
-      }
-    }
+    Parent2::force(*nodeIt);
   }
+  Parent2::bottomUp(_pMwcsGraph->getScores());
   
   // construct the solution
-  score = (*_pDpMap)[_root]._weight;
-  solutionSet = (*_pDpMap)[_root]._solution;
-  for (NodeSetIt nodeIt = solutionSet.begin(); nodeIt != solutionSet.end(); nodeIt++)
-  {
-    solutionMap[*nodeIt] = true;
-  }
+  score = _weight[0];
+  Parent2::construct(0, solutionMap, solutionSet);
   
   return true;
 }
@@ -14,7 +14,6 @@
 #include <map>
 #include <limits>
 #include <assert.h>
-#include <lemon/bfs.h>
 #include <lemon/connectivity.h>
 
 namespace nina {
@@ -44,21 +43,12 @@ public:
   
   using Parent1::_pMwcsGraph;
   
-  using Parent2::_pDpMap;
-  using Parent2::_nodesPerLevel;
-  using Parent2::_pPred;
-  using Parent2::_pLevel;
-  using Parent2::_pBfs;
+  using Parent2::_order;
+  using Parent2::_weight;
   
 protected:
-  typedef typename Parent2::PredMap PredMap;
-  typedef typename Parent2::DistMap DistMap;
-  typedef typename Parent2::NodeSetVector NodeSetVector;
-  typedef typename Parent2::NodeSetVectorIt NodeSetVectorIt;
-  typedef typename Parent2::NodeSetVectorRevIt NodeSetVectorRevIt;
-  typedef typename Parent2::DpEntry DpEntry;
-  typedef typename Parent2::DpEntryMap DpEntryMap;
-  typedef typename Parent2::BfsType BfsType;
+  typedef typename Parent2::NodeVector NodeVector;
+  typedef typename Parent2::NodeVectorIt NodeVectorIt;
   
 public:
   TreeSolverUnrootedImpl()
@@ -67,11 +57,22 @@ public:
   {
   }
   
+  /// Single bottom-up pass: rooting every tree of the forest arbitrarily,
+  /// the best subtree whose topmost node is v has weight
+  /// w(v) + sum of max(0, best(c)) over the children c of v,
+  /// so the optimum is the maximum over all nodes, found in O(n)
   virtual bool solve(double& score,
                      double& scoreUB,
                      BoolNodeMap& solutionMap,
                      NodeSet& solutionSet);
   
+  /// Reference implementation that repeats the DP for every root,
+  /// which takes O(n^2) time; used by check_tree_solver to verify solve()
+  bool solveReference(double& score,
+                      double& scoreUB,
+                      BoolNodeMap& solutionMap,
+                      NodeSet& solutionSet);
+  
   virtual void init(const MwcsGraphType& mwcsGraph)
   {
     Parent1::init(mwcsGraph);
@@ -84,49 +85,53 @@ inline bool TreeSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::solve(double& score,
                                                                   double& scoreUB,
                                                                   BoolNodeMap& solutionMap,
                                                                   NodeSet& solutionSet)
+{
+  Parent2::initForest(*_pMwcsGraph);
+  Parent2::bottomUp(_pMwcsGraph->getScores());
+  
+  // _weight[k] is final for every k after the bottom-up pass
+  const int n = static_cast<int>(_order.size());
+  int best = -1;
+  score = -std::numeric_limits<double>::max();
+  for (int k = 0; k < n; ++k)
+  {
+    if (_weight[k] > score)
+    {
+      score = _weight[k];
+      best = k;
+    }
+  }
+  
+  // construct the solution
+  solutionSet.clear();
+  if (best != -1)
+  {
+    Parent2::construct(best, solutionMap, solutionSet);
+  }
+  
+  return true;
+}
+
+template<typename GR, typename NWGHT, typename NLBL, typename EWGHT>
+inline bool TreeSolverUnrootedImpl<GR, NWGHT, NLBL, EWGHT>::solveReference(double& score,
+                                                                           double& scoreUB,
+                                                                           BoolNodeMap& solutionMap,
+                                                                           NodeSet& solutionSet)
 {
   const Graph& g = _pMwcsGraph->getGraph();
-  const WeightNodeMap& weight = _pMwcsGraph->getScores();
   
+  // every root is tried, so trees without positive nodes are covered
   for (NodeIt root(g); root != lemon::INVALID; ++root)
   {
-    if (_pMwcsGraph->getScore(root) > 0)
+    Parent2::init(*_pMwcsGraph, root);
+    Parent2::bottomUp(_pMwcsGraph->getScores());
+    
+    // construct the solution
+    if (_weight[0] > score)
     {
-      Parent2::init(*_pMwcsGraph, root);
-      // work bottom-up
-      for (NodeSetVectorRevIt nodeSetIt = _nodesPerLevel.rbegin();
-           nodeSetIt != _nodesPerLevel.rend(); nodeSetIt++)
-      {
-        for (NodeSetIt nodeIt = nodeSetIt->begin(); nodeIt != nodeSetIt->end(); nodeIt++)
-        {
-          Node node = *nodeIt;
-          (*_pDpMap)[node]._solution.insert(node);
-          (*_pDpMap)[node]._weight = weight[node];
-          
-          const NodeSet& children = (*_pDpMap)[node]._children;
-          for (NodeSetIt childIt = children.begin(); childIt != children.end(); childIt++)
-          {
-            double childWeight = (*_pDpMap)[*childIt]._weight;
-            if (childWeight > 0 || *childIt == root)
-            {
-              (*_pDpMap)[node]._weight += childWeight;
-              (*_pDpMap)[node]._solution.insert(
-              (*_pDpMap)[*childIt]._solution.begin(), (*_pDpMap)[*childIt]._solution.end());
-            }
-          }
-        }
-      }
-      
-      // construct the solution
-      if ((*_pDpMap)[root]._weight > score)
-      {
-        score = (*_pDpMap)[root]._weight;
-        solutionSet = (*_pDpMap)[root]._solution;
-        for (NodeSetIt nodeIt = solutionSet.begin(); nodeIt != solutionSet.end(); nodeIt++)
-        {
-          solutionMap[*nodeIt] = true;
-        }
-      }
+      score = _weight[0];
+      lemon::mapFill(g, solutionMap, false);
+      Parent2::construct(0, solutionMap, solutionSet);
     }
   }
   
@@ -12,6 +12,7 @@
 #include <vector>
 #include <ostream>
 #include <limits>
+#include <string>
 
 namespace nina {
 namespace mwcs {
@@ -38,6 +39,7 @@ public:
   typedef std::vector<Node> NodeVector;
   typedef typename NodeVector::const_iterator NodeVectorIt;
   typedef typename NodeVector::iterator NodeVectorNonConstIt;
+  typedef std::set<std::string> StringSet;
   
 public:
   Solver()
@@ -45,6 +47,8 @@ public:
     , _scoreUB(std::numeric_limits<double>::max())
     , _pSolutionMap(NULL)
     , _solutionSet()
+    , _startLabels()
+    , _lowerBound(-std::numeric_limits<double>::max())
   {
   }
   
@@ -58,8 +62,26 @@ protected:
   double _scoreUB;
   BoolNodeMap* _pSolutionMap;
   NodeSet _solutionSet;
+  StringSet _startLabels;
+  double _lowerBound;
   
 public:
+  /// Sets the labels of the original nodes of a module to start from,
+  /// typically the solution to a closely related instance. It is only
+  /// a hint: the optimal solution need not contain it.
+  void setStartModule(const StringSet& startLabels)
+  {
+    _startLabels = startLabels;
+  }
+  
+  /// Sets a lower bound on the optimal score, e.g. the score of a known
+  /// module, such that modules of smaller score are pruned. It must not
+  /// exceed the optimal score of the instance passed to solve().
+  void setLowerBound(double LB)
+  {
+    _lowerBound = LB;
+  }
+
   void printSolution(const MwcsGraphType& mwcsGraph,
                      std::ostream& out,
                      bool moduleOnly) const
@@ -40,6 +40,8 @@ public:
   using Parent::_scoreUB;
   using Parent::_pSolutionMap;
   using Parent::_solutionSet;
+  using Parent::_startLabels;
+  using Parent::_lowerBound;
   
 public:
   SolverRooted(SolverRootedImplType* pImpl)
@@ -58,6 +60,8 @@ public:
     delete _pSolutionMap;
     _pSolutionMap = new BoolNodeMap(mwcsGraph.getGraph(), false);
     
+    _pImpl->setStartLabels(_startLabels.empty() ? NULL : &_startLabels);
+    _pImpl->setLowerBound(_lowerBound);
     _pImpl->init(mwcsGraph, rootNodes);
     return _pImpl->solve(_score, _scoreUB, *_pSolutionMap, _solutionSet);
   }
@@ -40,6 +40,8 @@ public:
   using Parent::_scoreUB;
   using Parent::_pSolutionMap;
   using Parent::_solutionSet;
+  using Parent::_startLabels;
+  using Parent::_lowerBound;
   
 public:
   SolverUnrooted(SolverUnrootedImplType* pImpl)
@@ -57,6 +59,8 @@ public:
     delete _pSolutionMap;
     _pSolutionMap = new BoolNodeMap(mwcsGraph.getGraph(), false);
     
+    _pImpl->setStartLabels(_startLabels.empty() ? NULL : &_startLabels);
+    _pImpl->setLowerBound(_lowerBound);
     _pImpl->init(mwcsGraph);
     return _pImpl->solve(_score, _scoreUB, *_pSolutionMap, _solutionSet);
   }
@@ -1,4 +1,5 @@
 #include "utils.h"
+#include "solver/impl/callbackstats.h"
 #include <assert.h>
 
 using namespace nina;
@@ -10,6 +11,8 @@ lemon::Timer nina::mwcs::g_timer;
 
 std::ostream* nina::mwcs::g_pOut = NULL;
 
+CallbackStats nina::mwcs::g_callbackStats;
+
 void nina::mwcs::generateRandomGraph(Graph& g, Graph::NodeMap<int>& weight, int nNodes, int nEdges)
 {
   for (int i = 0; i < nNodes; i++)
@@ -5,6 +5,7 @@
 #include <lemon/time_measure.h>
 #include <ostream>
 #include <set>
+#include <vector>
 
 namespace nina {
 namespace mwcs {
@@ -34,6 +35,23 @@ inline double reEvaluatePCST(const MWCSGR& mwcsGraph,
   typedef std::set<Node> NodeSet;
   typedef NodeSet::const_iterator NodeSetIt;
   
+  const Graph& orgG = mwcsGraph.getOrgGraph();
+  
+  if (mwcsGraph.hasEdgeCosts())
+  {
+    // edge costs are paid along a minimum spanning tree of the solution
+    std::vector<Edge> treeEdges;
+    double cost = mwcsGraph.getSpanningTree(solution, treeEdges);
+    for (NodeIt v(orgG); v != lemon::INVALID; ++v)
+    {
+      if (solution.find(v) == solution.end())
+      {
+        cost += mwcsGraph.getOrgScore(v);
+      }
+    }
+    return cost;
+  }
+  
   NodeSet solutionEdges;
   NodeSet solutionNodes;
   
@@ -61,7 +79,6 @@ inline double reEvaluatePCST(const MWCSGR& mwcsGraph,
     }
   }
   
-  const Graph& orgG = mwcsGraph.getOrgGraph();
   for (NodeIt v(orgG); v != lemon::INVALID; ++v)
   {
     const std::string& label = mwcsGraph.getOrgLabel(v);